@@ -0,0 +1,340 @@
+#include "fpv_interceptor.h"
+#include "rx5808_backend.h"
+#include "channel_store.h"
+#include "rssi_kernels.h"
+#include "spectrum_analysis.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Микробенчмарк анализатора RSSI
+ * Заполняет историю всех каналов плана синтетическими отсчетами и
+ * измеряет время обновления канала (analyze_rssi_sample) и расчета
+ * признаков окна: прежним способом - отдельным проходом по истории на
+ * каждый признак, слитным ядром по одному каналу и пакетом по всему плану.
+ * Затем из окон всех каналов собирается архив обходов, и признаки всего
+ * архива считаются каждой доступной реализацией ядра спектра. В конце
+ * архив обходов анализируется заново: по отсчету, как этап анализа обхода,
+ * и пакетно (analyze_sweeps) в одном и в нескольких потоках.
+ * Использование: ./fpv_bench_analyzer [--threads=N] [циклов]
+ */
+
+#define BENCH_DEFAULT_SWEEPS 200
+#define BENCH_FEATURE_PASSES 50
+#define BENCH_ARCHIVE_SWEEPS 64   // Обходов в архиве для ядер спектра
+#define BENCH_BATCH_SWEEPS   100  // Обходов в архиве для пакетного анализа
+
+/**
+ * Синтетический отсчет: шум канала и передатчики с АМ на части каналов
+ */
+static uint8_t synthetic_rssi(int channel, int sweep, uint32_t *seed) {
+    *seed = *seed * 1103515245u + 12345u;
+    int rssi = 15 + (int)((*seed >> 16) % 8);
+    if (channel % 37 < 6) rssi += 45 + ((sweep + channel) % 7) * 4;
+    return (uint8_t)(rssi > 100 ? 100 : rssi);
+}
+
+/**
+ * Признаки прежним способом: каждый признак - свой проход по истории
+ */
+static void legacy_features(uint16_t frequency, rssi_features_t *f) {
+    uint8_t h[RSSI_SAMPLES];
+    int n = get_rssi_history(frequency, h, NULL, RSSI_SAMPLES);
+
+    memset(f, 0, sizeof(*f));
+    f->frequency = frequency;
+    f->samples = (uint8_t)n;
+    if (n == 0) return;
+
+    uint32_t sum = 0;
+    for (int i = 0; i < n; i++) sum += h[i];
+    f->mean = (uint8_t)(sum / n);
+
+    uint8_t lo = 255, hi = 0;
+    for (int i = 0; i < n; i++) {
+        if (h[i] < lo) lo = h[i];
+        if (h[i] > hi) hi = h[i];
+    }
+    f->min = lo;
+    f->max = hi;
+    f->range = hi - lo;
+
+    f->trend = 50;
+    int recent = RSSI_SAMPLES / 5;
+    int old = RSSI_SAMPLES / 2;
+    if (n >= recent + old) {
+        uint32_t recent_sum = 0, old_sum = 0;
+        for (int i = n - recent; i < n; i++) recent_sum += h[i];
+        for (int i = 0; i < old; i++) old_sum += h[i];
+        uint8_t recent_avg = (uint8_t)(recent_sum / recent);
+        uint8_t old_avg = (uint8_t)(old_sum / old);
+        f->trend = recent_avg > old_avg ? 50 + ((recent_avg - old_avg) * 25) / 100
+                                        : 50 - ((old_avg - recent_avg) * 25) / 100;
+    }
+
+    for (int i = 1; i + 1 < n; i++) {
+        if ((h[i] > h[i - 1] && h[i] > h[i + 1]) || (h[i] < h[i - 1] && h[i] < h[i + 1])) f->extrema++;
+    }
+
+    int changes = 0;
+    for (int i = 1; i < n; i++) {
+        if (abs(h[i] - h[i - 1]) > 5) changes++;
+    }
+    f->change_rate = n > 1 ? (uint8_t)(changes * 100 / (n - 1)) : 0;
+}
+
+/**
+ * Совпадение признаков (без частоты)
+ */
+static int features_equal(const rssi_features_t *a, const rssi_features_t *b) {
+    return a->samples == b->samples && a->mean == b->mean && a->min == b->min && a->max == b->max &&
+           a->range == b->range && a->trend == b->trend && a->extrema == b->extrema &&
+           a->change_rate == b->change_rate && a->stability == b->stability &&
+           a->modulation == b->modulation && a->periodicity == b->periodicity &&
+           a->change_score == b->change_score && a->fpv_score == b->fpv_score;
+}
+
+/**
+ * Совпадение результатов пакетного анализа
+ */
+static int results_equal(const spectrum_result_t *a, const spectrum_result_t *b) {
+    return a->frequency == b->frequency && a->raw_rssi == b->raw_rssi && a->rssi == b->rssi &&
+           a->threshold == b->threshold && a->detected == b->detected && a->video == b->video &&
+           a->in_plan == b->in_plan && a->timestamp_ns == b->timestamp_ns &&
+           features_equal(&a->features, &b->features);
+}
+
+/**
+ * Анализ отсчета по одному, как этап анализа обхода (эталон пакетного)
+ */
+static void analyze_serial(const scan_result_t *in, spectrum_result_t *out) {
+    memset(out, 0, sizeof(*out));
+    out->frequency = in->frequency;
+    out->raw_rssi = in->rssi;
+    out->timestamp_ns = in->timestamp_ns;
+
+    if (!in->tracking) noise_floor_update(in->frequency, in->rssi, in->timestamp_ns);
+    out->rssi = analyze_rssi_sample(in->frequency, in->rssi, in->timestamp_ns);
+    out->threshold = noise_floor_threshold(in->frequency);
+    out->in_plan = get_rssi_features(in->frequency, &out->features) == 0;
+
+    out->detected = out->rssi > out->threshold;
+    out->video = out->in_plan && out->rssi >= out->threshold &&
+                 rssi_video_detected(out->rssi, &out->features);
+}
+
+/**
+ * Пакетный анализ архива обходов
+ * Анализатор сбрасывается, чтобы каждый прогон начинался с пустой истории
+ * @param threads 0 - по отсчету (эталон), иначе потоков пула
+ * @return Время на отсчет (нс)
+ */
+static double run_batch(int threads, const spectrum_sweep_t *sweeps, int count,
+                        spectrum_result_t *const *results) {
+    if (rssi_analyzer_init() != 0) return 0;
+
+    uint64_t start = get_monotonic_ns();
+    int samples = 0;
+    if (threads == 0) {
+        for (int s = 0; s < count; s++) {
+            for (int i = 0; i < sweeps[s].count; i++) {
+                analyze_serial(&sweeps[s].samples[i], &results[s][i]);
+            }
+            samples += sweeps[s].count;
+        }
+    } else {
+        spectrum_analysis_init(threads);
+        samples = analyze_sweeps(sweeps, count, results);
+    }
+    return samples > 0 ? (double)(get_monotonic_ns() - start) / samples : 0;
+}
+
+int main(int argc, char *argv[]) {
+    int sweeps = BENCH_DEFAULT_SWEEPS;
+    int threads = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--threads=", 10) == 0) {
+            threads = atoi(argv[i] + 10);
+        } else {
+            sweeps = atoi(argv[i]);
+        }
+    }
+    if (sweeps <= 0) sweeps = BENCH_DEFAULT_SWEEPS;
+
+    if (rx5808_select_backend("stub") != 0 || rx5808_init() != 0 || rssi_analyzer_init() != 0) {
+        printf("❌ Ошибка инициализации анализатора\n");
+        return -1;
+    }
+
+    const scan_plan_t *plan = scan_plan_get();
+    int count = plan->channel_count;
+    rssi_features_t *features = malloc(count * sizeof(*features));
+    if (!features) {
+        printf("❌ Недостаточно памяти\n");
+        return -1;
+    }
+
+    printf("⏱️ Бенчмарк анализатора RSSI: %d каналов, %d циклов\n", count, sweeps);
+
+    // Обновление: отсчет каждого канала плана за цикл
+    uint32_t seed = 1;
+    uint64_t timestamp = 1;
+    uint32_t checksum = 0;
+    uint64_t start = get_monotonic_ns();
+    for (int s = 0; s < sweeps; s++) {
+        for (int ch = 0; ch < count; ch++) {
+            uint8_t rssi = synthetic_rssi(ch, s, &seed);
+            checksum += analyze_rssi_sample((uint16_t)(plan->freq_min + ch), rssi, timestamp++);
+        }
+    }
+    double update_ns = (double)(get_monotonic_ns() - start) / ((double)sweeps * count);
+
+    // Признаки прежним способом
+    start = get_monotonic_ns();
+    for (int p = 0; p < BENCH_FEATURE_PASSES; p++) {
+        for (int ch = 0; ch < count; ch++) {
+            legacy_features((uint16_t)(plan->freq_min + ch), &features[ch]);
+            checksum += features[ch].range;
+        }
+    }
+    double legacy_ns = (double)(get_monotonic_ns() - start) / ((double)BENCH_FEATURE_PASSES * count);
+
+    // Слитное ядро по одному каналу
+    rssi_features_t f;
+    int mismatches = 0;
+    start = get_monotonic_ns();
+    for (int p = 0; p < BENCH_FEATURE_PASSES; p++) {
+        for (int ch = 0; ch < count; ch++) {
+            get_rssi_features((uint16_t)(plan->freq_min + ch), &f);
+            checksum += f.range;
+        }
+    }
+    double fused_ns = (double)(get_monotonic_ns() - start) / ((double)BENCH_FEATURE_PASSES * count);
+
+    // Сверка слитного ядра с прежним расчетом
+    for (int ch = 0; ch < count; ch++) {
+        get_rssi_features((uint16_t)(plan->freq_min + ch), &f);
+        const rssi_features_t *l = &features[ch];
+        if (f.samples != l->samples || f.mean != l->mean || f.min != l->min || f.max != l->max ||
+            f.trend != l->trend || f.extrema != l->extrema || f.change_rate != l->change_rate) {
+            mismatches++;
+        }
+    }
+
+    // Пакет по всему плану
+    start = get_monotonic_ns();
+    for (int p = 0; p < BENCH_FEATURE_PASSES; p++) {
+        rssi_features_batch(0, count, features);
+        checksum += features[p % count].range;
+    }
+    double batch_ns = (double)(get_monotonic_ns() - start) / ((double)BENCH_FEATURE_PASSES * count);
+
+    printf("\n📊 Время на канал:\n");
+    printf("   Обновление (analyze_rssi_sample): %8.1f нс\n", update_ns);
+    printf("   Признаки, проход на признак:     %8.1f нс\n", legacy_ns);
+    printf("   Признаки, слитное ядро:          %8.1f нс\n", fused_ns);
+    printf("   Признаки, пакет по плану:        %8.1f нс\n", batch_ns);
+    printf("   Расхождений с прежним расчетом: %d (контрольная сумма %u)\n", mismatches, checksum);
+
+    // Архив обходов: окна всех каналов плана, повторенные BENCH_ARCHIVE_SWEEPS раз
+    int rows = count * BENCH_ARCHIVE_SWEEPS;
+    uint8_t *archive = calloc((size_t)rows, RSSI_STRIDE);
+    rssi_features_t *replay = malloc(rows * sizeof(*replay));
+    if (!archive || !replay) {
+        printf("❌ Недостаточно памяти для архива\n");
+        free(archive);
+        free(replay);
+        free(features);
+        return -1;
+    }
+    for (int ch = 0; ch < count; ch++) {
+        get_rssi_history((uint16_t)(plan->freq_min + ch), archive + (size_t)ch * RSSI_STRIDE, NULL, RSSI_SAMPLES);
+    }
+    for (int s = 1; s < BENCH_ARCHIVE_SWEEPS; s++) {
+        memcpy(archive + (size_t)s * count * RSSI_STRIDE, archive, (size_t)count * RSSI_STRIDE);
+    }
+
+    printf("\n📊 Ядра спектра (архив %d окон по %d отсчетов, выбрано %s):\n",
+           rows, RSSI_SAMPLES, rssi_kernel_name());
+    const char *selected = rssi_kernel_name();
+    for (const char *const *name = rssi_kernel_list(); *name; name++) {
+        rssi_kernel_select(*name);
+
+        start = get_monotonic_ns();
+        for (int p = 0; p < BENCH_FEATURE_PASSES / 10; p++) {
+            rssi_spectrum_features(archive, RSSI_STRIDE, RSSI_SAMPLES, rows, plan->freq_min, replay);
+            checksum += replay[p % rows].range;
+        }
+        double kernel_ns = (double)(get_monotonic_ns() - start) / ((double)(BENCH_FEATURE_PASSES / 10) * rows);
+
+        // Каждое окно архива совпадает с окном канала в хранилище
+        int kernel_mismatches = 0;
+        for (int i = 0; i < rows; i++) {
+            get_rssi_features((uint16_t)(plan->freq_min + i % count), &f);
+            if (!features_equal(&f, &replay[i])) kernel_mismatches++;
+        }
+        mismatches += kernel_mismatches;
+        printf("   %-8s %8.1f нс на окно, расхождений %d\n", *name, kernel_ns, kernel_mismatches);
+    }
+    rssi_kernel_select(selected);
+
+    free(archive);
+    free(replay);
+
+    // Архив обходов: все каналы плана по порядку и повторные визиты
+    // каждого восьмого канала в конце обхода
+    int per_sweep = count + count / 8;
+    scan_result_t *samples = calloc((size_t)BENCH_BATCH_SWEEPS * per_sweep, sizeof(*samples));
+    spectrum_result_t *out[3];
+    spectrum_result_t *rows_out[3][BENCH_BATCH_SWEEPS];
+    spectrum_sweep_t batch[BENCH_BATCH_SWEEPS];
+    for (int k = 0; k < 3; k++) {
+        out[k] = calloc((size_t)BENCH_BATCH_SWEEPS * per_sweep, sizeof(spectrum_result_t));
+    }
+    if (!samples || !out[0] || !out[1] || !out[2]) {
+        printf("❌ Недостаточно памяти для архива обходов\n");
+        return -1;
+    }
+    seed = 7;
+    for (int s = 0; s < BENCH_BATCH_SWEEPS; s++) {
+        scan_result_t *sweep = samples + (size_t)s * per_sweep;
+        for (int i = 0; i < per_sweep; i++) {
+            int ch = i < count ? i : (i - count) * 8;
+            sweep[i].frequency = (uint16_t)(plan->freq_min + ch);
+            sweep[i].rssi = synthetic_rssi(ch, s, &seed);
+            sweep[i].cycle = (uint32_t)s;
+            sweep[i].timestamp_ns = ((uint64_t)s * per_sweep + i + 1) * 1000000ULL;
+        }
+        batch[s].samples = sweep;
+        batch[s].count = per_sweep;
+        for (int k = 0; k < 3; k++) rows_out[k][s] = out[k] + (size_t)s * per_sweep;
+    }
+
+    double serial_ns = run_batch(0, batch, BENCH_BATCH_SWEEPS, rows_out[0]);
+    double single_ns = run_batch(1, batch, BENCH_BATCH_SWEEPS, rows_out[1]);
+    double pool_ns = run_batch(threads, batch, BENCH_BATCH_SWEEPS, rows_out[2]);
+    spectrum_stats_t pool;
+    get_spectrum_stats(&pool);
+
+    int batch_mismatches = 0;
+    for (int i = 0; i < BENCH_BATCH_SWEEPS * per_sweep; i++) {
+        if (!results_equal(&out[0][i], &out[1][i]) || !results_equal(&out[0][i], &out[2][i])) batch_mismatches++;
+    }
+    mismatches += batch_mismatches;
+
+    printf("\n📊 Пакетный анализ (%d обходов по %d отсчетов):\n", BENCH_BATCH_SWEEPS, per_sweep);
+    printf("   По отсчету:         %8.1f нс на отсчет\n", serial_ns);
+    printf("   Пакет, 1 поток:     %8.1f нс на отсчет\n", single_ns);
+    printf("   Пакет, потоков %-3d  %8.1f нс на отсчет\n", pool.threads, pool_ns);
+    printf("   Расхождений с анализом по отсчету: %d\n", batch_mismatches);
+
+    spectrum_analysis_cleanup();
+    for (int k = 0; k < 3; k++) free(out[k]);
+    free(samples);
+    free(features);
+    rssi_analyzer_cleanup();
+    rx5808_cleanup();
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,237 @@
+#include "fpv_interceptor.h"
+#include "rx5808_backend.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * Микробенчмарк драйвера RX5808
+ * Измеряет задержки rx5808_set_frequency, rx5808_write_register,
+ * rx5808_read_rssi и пакетного чтения на выбранном бэкенде, объем
+ * шины SPI и достижимую скорость обхода каналов.
+ * Использование: ./fpv_bench_driver [--backend=NAME] [--json=FILE|-] [циклов]
+ * С --json=- в stdout идет только JSON, остальной вывод - в stderr.
+ */
+
+#define BENCH_DEFAULT_CYCLES 5000
+#define BENCH_BURST_SAMPLES  64
+
+// Результат одного измерения
+typedef struct {
+    const char *name;
+    int count;
+    double mean_us;
+    double p50_us;
+    double p90_us;
+    double p99_us;
+    double p999_us;
+    double max_us;
+} bench_result_t;
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Перцентиль по отсортированному массиву (ближайший ранг)
+ */
+static double percentile_us(const uint64_t *sorted, int count, double p) {
+    int index = (int)(p / 100.0 * count + 0.5) - 1;
+    if (index < 0) index = 0;
+    if (index >= count) index = count - 1;
+    return sorted[index] / 1000.0;
+}
+
+/**
+ * Сводка задержек (массив сортируется на месте)
+ */
+static bench_result_t summarize(const char *name, uint64_t *samples, int count) {
+    bench_result_t r;
+    uint64_t total = 0;
+
+    memset(&r, 0, sizeof(r));
+    r.name = name;
+    r.count = count;
+    if (count <= 0) return r;
+
+    qsort(samples, count, sizeof(samples[0]), compare_u64);
+    for (int i = 0; i < count; i++) {
+        total += samples[i];
+    }
+
+    r.mean_us = total / 1000.0 / count;
+    r.p50_us = percentile_us(samples, count, 50.0);
+    r.p90_us = percentile_us(samples, count, 90.0);
+    r.p99_us = percentile_us(samples, count, 99.0);
+    r.p999_us = percentile_us(samples, count, 99.9);
+    r.max_us = samples[count - 1] / 1000.0;
+    return r;
+}
+
+static void print_result(const bench_result_t *r) {
+    printf("   %-16s %7d  ср. %9.1f  p50 %9.1f  p90 %9.1f  p99 %9.1f  p99.9 %9.1f  макс. %9.1f мкс\n",
+           r->name, r->count, r->mean_us, r->p50_us, r->p90_us, r->p99_us, r->p999_us, r->max_us);
+}
+
+static void json_result(FILE *out, const bench_result_t *r, int last) {
+    fprintf(out, "    \"%s\": {\"count\": %d, \"mean_us\": %.3f, \"p50_us\": %.3f, "
+                 "\"p90_us\": %.3f, \"p99_us\": %.3f, \"p999_us\": %.3f, \"max_us\": %.3f}%s\n",
+            r->name, r->count, r->mean_us, r->p50_us, r->p90_us, r->p99_us, r->p999_us,
+            r->max_us, last ? "" : ",");
+}
+
+int main(int argc, char *argv[]) {
+    const char *json_path = NULL;
+    int cycles = BENCH_DEFAULT_CYCLES;
+    FILE *json_stdout = NULL;
+
+    // JSON в stdout: исходный stdout сохраняется для JSON, а сообщения
+    // бенчмарка и драйвера (printf) перенаправляются в stderr
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json=-") == 0 && !json_stdout) {
+            int fd = dup(STDOUT_FILENO);
+            json_stdout = fd >= 0 ? fdopen(fd, "w") : NULL;
+            if (!json_stdout || dup2(STDERR_FILENO, STDOUT_FILENO) < 0) {
+                fprintf(stderr, "❌ Ошибка перенаправления вывода\n");
+                return -1;
+            }
+        }
+    }
+
+    // По умолчанию симулятор; --backend / RECEIVER_BACKEND переопределяют
+    rx5808_select_backend("sim");
+    if (rx5808_select_backend_from_args(&argc, argv) != 0) {
+        return -1;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--json=", 7) == 0) {
+            json_path = argv[i] + 7;
+        } else if (atoi(argv[i]) > 0) {
+            cycles = atoi(argv[i]);
+        }
+    }
+
+    if (rx5808_init() != 0) {
+        printf("❌ Ошибка инициализации RX5808\n");
+        return -1;
+    }
+
+    const rx5808_backend_t *backend = rx5808_get_backend();
+    uint64_t *samples = malloc(sizeof(uint64_t) * cycles);
+    if (!samples) {
+        rx5808_cleanup();
+        return -1;
+    }
+
+    printf("⏱️ Бенчмарк драйвера RX5808: бэкенд %s, %d циклов\n", backend->name, cycles);
+
+    // Каналы подряд в охвате плана сканирования
+    const scan_plan_t *plan = scan_plan_get();
+
+    // Перестройка по каналам подряд (включая ожидание стабилизации PLL)
+    for (int i = 0; i < cycles; i++) {
+        uint16_t freq = plan->freq_min + i % plan->channel_count;
+        uint64_t start = rx5808_now_ns();
+        rx5808_set_frequency(freq);
+        samples[i] = rx5808_now_ns() - start;
+    }
+    bench_result_t tune = summarize("set_frequency", samples, cycles);
+
+    // Запись регистра: кэш сбрасывается, чтобы запись не была пропущена
+    for (int i = 0; i < cycles; i++) {
+        rx5808_shadow_invalidate(rx5808_current_receiver());
+        uint64_t start = rx5808_now_ns();
+        rx5808_write_register(RX5808_REG_7, 0x00);
+        samples[i] = rx5808_now_ns() - start;
+    }
+    bench_result_t write = summarize("write_register", samples, cycles);
+
+    // Одиночное чтение RSSI
+    for (int i = 0; i < cycles; i++) {
+        uint64_t start = rx5808_now_ns();
+        rx5808_read_rssi();
+        samples[i] = rx5808_now_ns() - start;
+    }
+    bench_result_t read = summarize("read_rssi", samples, cycles);
+
+    // Пакетное чтение RSSI
+    uint8_t burst[BENCH_BURST_SAMPLES];
+    int bursts = cycles / BENCH_BURST_SAMPLES > 0 ? cycles / BENCH_BURST_SAMPLES : 1;
+    for (int i = 0; i < bursts; i++) {
+        uint64_t start = rx5808_now_ns();
+        rx5808_read_rssi_burst(burst, BENCH_BURST_SAMPLES);
+        samples[i] = rx5808_now_ns() - start;
+    }
+    bench_result_t burst_read = summarize("read_rssi_burst", samples, bursts);
+
+    // Обход диапазона: перестройка и одно чтение на канал
+    register_stats_t before, after;
+    rx5808_get_register_stats(&before);
+    uint64_t sweep_start = rx5808_now_ns();
+    for (int i = 0; i < cycles; i++) {
+        rx5808_set_frequency(plan->freq_min + i % plan->channel_count);
+        rx5808_read_rssi();
+    }
+    uint64_t sweep_ns = rx5808_now_ns() - sweep_start;
+    rx5808_get_register_stats(&after);
+
+    double sweep_s = sweep_ns / 1e9;
+    uint64_t sweep_bytes = after.bus_bytes - before.bus_bytes;
+    double channels_per_s = sweep_s > 0 ? cycles / sweep_s : 0;
+    double bytes_per_s = sweep_s > 0 ? sweep_bytes / sweep_s : 0;
+    double burst_rate = burst_read.mean_us > 0 ? BENCH_BURST_SAMPLES / (burst_read.mean_us / 1e6) : 0;
+
+    printf("\n📊 Задержки:\n");
+    print_result(&tune);
+    print_result(&write);
+    print_result(&read);
+    print_result(&burst_read);
+    printf("\n📊 Пропускная способность:\n");
+    printf("   Каналов в секунду: %.1f\n", channels_per_s);
+    printf("   Отсчетов RSSI в секунду (пакет %d): %.0f\n", BENCH_BURST_SAMPLES, burst_rate);
+    printf("   SPI: %llu байт за обход, %.0f байт/с%s\n", (unsigned long long)sweep_bytes, bytes_per_s,
+           after.bus_bytes_measured ? "" : " (оценка: 2 байта на запись или чтение)");
+    printf("   Часы: %s\n", backend->now_ns ? "виртуальные (бэкенд)" : "CLOCK_MONOTONIC");
+
+    if (json_path) {
+        FILE *out = strcmp(json_path, "-") == 0 ? json_stdout : fopen(json_path, "w");
+        if (!out) {
+            printf("❌ Ошибка создания файла: %s\n", json_path);
+        } else {
+            settle_stats_t settle;
+            rx5808_get_settle_stats(&settle);
+
+            fprintf(out, "{\n");
+            fprintf(out, "  \"backend\": \"%s\",\n", backend->name);
+            fprintf(out, "  \"virtual_clock\": %s,\n", backend->now_ns ? "true" : "false");
+            fprintf(out, "  \"cycles\": %d,\n", cycles);
+            fprintf(out, "  \"latency\": {\n");
+            json_result(out, &tune, 0);
+            json_result(out, &write, 0);
+            json_result(out, &read, 0);
+            json_result(out, &burst_read, 1);
+            fprintf(out, "  },\n");
+            fprintf(out, "  \"channels_per_s\": %.3f,\n", channels_per_s);
+            fprintf(out, "  \"rssi_samples_per_s\": %.3f,\n", burst_rate);
+            fprintf(out, "  \"spi_bytes\": %llu,\n", (unsigned long long)sweep_bytes);
+            fprintf(out, "  \"spi_bytes_per_s\": %.3f,\n", bytes_per_s);
+            fprintf(out, "  \"spi_bytes_estimated\": %s,\n", after.bus_bytes_measured ? "false" : "true");
+            fprintf(out, "  \"settle_timeouts\": %u\n", settle.timeouts);
+            fprintf(out, "}\n");
+
+            if (out != json_stdout) {
+                fclose(out);
+                printf("💾 JSON сохранен: %s\n", json_path);
+            }
+        }
+    }
+
+    free(samples);
+    rx5808_cleanup();
+    if (json_stdout) fclose(json_stdout);
+    return 0;
+}
@@ -0,0 +1,366 @@
+#include "cfar.h"
+#include "channel_store.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+/**
+ * Обнаружитель CFAR (постоянная вероятность ложной тревоги) по спектру
+ * Порог канала оценивается по обучающим ячейкам слева и справа от него в
+ * карте обхода; защитные ячейки рядом с проверяемой закрывают полосу
+ * самого сигнала. RSSI приемника логарифмический (шкала пропорциональна
+ * дБм), поэтому порог - оценка шума плюс z(Pfa) разбросов шума:
+ *   CA - среднее обучающих ячеек, разброс по сумме квадратов;
+ *   OS - порядковая статистика ранга CFAR_OS_RANK, разброс по интервалу
+ *        между рангами rank и 100 - rank. Соседний сигнал, занявший
+ *        меньше 100 - rank процентов обучающих ячеек, порог не поднимает.
+ * При сдвиге на ячейку суммы и гистограмма окон меняются на четыре ячейки,
+ * весь спектр обрабатывается за O(N) (поиск ранга - по 101 уровню).
+ * Ячейки, не измеренные в обходе, в оценку не входят. Пороги
+ * пересчитываются после каждого обхода и действуют в следующем; каналу
+ * без оценки остается порог по шуму канала.
+ */
+
+#define CFAR_DEFAULT_GUARD 10    // Полуполоса аналогового видеосигнала (МГц)
+#define CFAR_DEFAULT_TRAIN 16
+#define CFAR_DEFAULT_PFA   1e-3
+#define CFAR_DEFAULT_RANK  75
+#define CFAR_MAX_CELLS     64    // Наибольшее число защитных и обучающих ячеек
+#define CFAR_MIN_TRAIN     4     // Обучающих ячеек для оценки порога
+#define CFAR_MIN_SIGMA     1.0   // Наименьший разброс: RSSI квантуется по 1%
+#define CFAR_LEVELS        101   // Уровни RSSI 0-100%
+
+// Обучающие ячейки обеих сторон
+typedef struct {
+    uint32_t n;
+    uint32_t sum;
+    uint32_t sum_sq;
+    uint16_t hist[CFAR_LEVELS];
+} cfar_window_t;
+
+static cfar_params_t params = { CFAR_OFF, CFAR_DEFAULT_GUARD, CFAR_DEFAULT_TRAIN,
+                                CFAR_DEFAULT_PFA, CFAR_DEFAULT_RANK };
+static uint8_t *thresholds = NULL;
+static uint8_t *measured = NULL;
+static int cell_count = 0;
+static cfar_stats_t stats;
+static pthread_mutex_t cfar_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Параметры по умолчанию (CFAR выключен)
+ */
+void cfar_default_params(cfar_params_t *out) {
+    if (!out) return;
+    out->mode = CFAR_OFF;
+    out->guard = CFAR_DEFAULT_GUARD;
+    out->train = CFAR_DEFAULT_TRAIN;
+    out->pfa = CFAR_DEFAULT_PFA;
+    out->rank = CFAR_DEFAULT_RANK;
+}
+
+/**
+ * Квантиль нормального распределения: x, для которого P(X > x) = p
+ */
+static double upper_quantile(double p) {
+    double lo = -10.0;
+    double hi = 10.0;
+
+    for (int i = 0; i < 64; i++) {
+        double mid = (lo + hi) / 2;
+        if (0.5 * erfc(mid / M_SQRT2) > p) lo = mid; else hi = mid;
+    }
+    return (lo + hi) / 2;
+}
+
+/**
+ * Учет ячейки в окне (sign = 1) или исключение из него (sign = -1)
+ * Ячейки вне спектра и неизмеренные пропускаются
+ */
+static inline void window_cell(cfar_window_t *w, const uint8_t *levels, const uint8_t *valid,
+                               int count, int cell, int sign) {
+    if (cell < 0 || cell >= count || (valid && !valid[cell])) return;
+
+    uint32_t level = levels[cell] < CFAR_LEVELS ? levels[cell] : CFAR_LEVELS - 1;
+    w->n += (uint32_t)sign;
+    w->sum += (uint32_t)sign * level;
+    w->sum_sq += (uint32_t)sign * level * level;
+    w->hist[level] += (uint16_t)sign;
+}
+
+/**
+ * Уровень ранга (номер с 1) по гистограмме окна
+ */
+static int window_rank(const cfar_window_t *w, uint32_t rank) {
+    uint32_t seen = 0;
+
+    for (int level = 0; level < CFAR_LEVELS; level++) {
+        seen += w->hist[level];
+        if (seen >= rank) return level;
+    }
+    return CFAR_LEVELS - 1;
+}
+
+/**
+ * Пороги CFAR по спектру
+ * @param levels RSSI ячеек (%)
+ * @param valid Измеренные ячейки (NULL - все)
+ * @param count Ячеек
+ * @param p Параметры (mode CFAR_OFF считается как CA)
+ * @param out Пороги ячеек (0 - нет оценки)
+ * @return Ячеек с порогом, -1 при ошибке
+ */
+int cfar_detect(const uint8_t *levels, const uint8_t *valid, int count,
+                const cfar_params_t *p, uint8_t *out) {
+    if (!levels || !p || !out || count < 0) return -1;
+
+    int guard = p->guard;
+    int train = p->train;
+    double z = upper_quantile(p->pfa);
+    double z_rank = upper_quantile(1.0 - p->rank / 100.0);
+    int estimated = 0;
+    cfar_window_t w;
+
+    memset(&w, 0, sizeof(w));
+
+    // Ячейка 0: слева окна нет, справа [guard + 1, guard + train]
+    for (int j = guard + 1; j <= guard + train; j++) {
+        window_cell(&w, levels, valid, count, j, 1);
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (i > 0) {
+            // Слева [i - guard - train, i - guard - 1], справа [i + guard + 1, i + guard + train]
+            window_cell(&w, levels, valid, count, i - guard - 1, 1);
+            window_cell(&w, levels, valid, count, i - guard - train - 1, -1);
+            window_cell(&w, levels, valid, count, i + guard, -1);
+            window_cell(&w, levels, valid, count, i + guard + train, 1);
+        }
+
+        if (w.n < CFAR_MIN_TRAIN) {
+            out[i] = 0;
+            continue;
+        }
+
+        // Порог - среднее шума плюс z(Pfa) разбросов
+        double threshold;
+        double sigma;
+        if (p->mode == CFAR_OS) {
+            // Ранг hi - rank процентов окна, lo - симметричный ему; для
+            // нормального шума X(hi) = среднее + z_rank разбросов
+            uint32_t hi = (w.n * (uint32_t)p->rank + 99) / 100;
+            int hi_level = window_rank(&w, hi);
+            int lo_level = window_rank(&w, w.n + 1 - hi);
+            sigma = (hi_level - lo_level) / (2 * z_rank);
+            if (sigma < CFAR_MIN_SIGMA) sigma = CFAR_MIN_SIGMA;
+            threshold = hi_level + (z - z_rank) * sigma;
+        } else {
+            double mean = (double)w.sum / w.n;
+            double variance = (double)w.sum_sq / w.n - mean * mean;
+            sigma = variance > 0 ? sqrt(variance) : 0;
+            if (sigma < CFAR_MIN_SIGMA) sigma = CFAR_MIN_SIGMA;
+            threshold = mean + z * sigma;
+        }
+        out[i] = threshold >= 100 ? 100 : (uint8_t)ceil(threshold);
+        estimated++;
+    }
+    return estimated;
+}
+
+/**
+ * Целый параметр конфигурации в пределах [min, max]
+ */
+static int config_int(const char *key, int def, int min, int max) {
+    char value[32];
+
+    if (config_get_value(key, value, sizeof(value)) != 0) return def;
+
+    int parsed = atoi(value);
+    if (parsed < min || parsed > max) {
+        printf("⚠️ %s=%s вне пределов %d-%d, используется %d\n", key, value, min, max, def);
+        return def;
+    }
+    return parsed;
+}
+
+/**
+ * Чтение DETECTOR, CFAR_GUARD, CFAR_TRAIN, CFAR_PFA и CFAR_OS_RANK
+ */
+static void load_config(cfar_params_t *p) {
+    char value[32];
+
+    cfar_default_params(p);
+    if (config_get_value("DETECTOR", value, sizeof(value)) == 0) {
+        if (strcmp(value, "ca") == 0) {
+            p->mode = CFAR_CA;
+        } else if (strcmp(value, "os") == 0) {
+            p->mode = CFAR_OS;
+        } else if (strcmp(value, "noise") != 0) {
+            printf("⚠️ DETECTOR=%s неизвестен, используется noise\n", value);
+        }
+    }
+
+    p->guard = config_int("CFAR_GUARD", CFAR_DEFAULT_GUARD, 0, CFAR_MAX_CELLS);
+    p->train = config_int("CFAR_TRAIN", CFAR_DEFAULT_TRAIN, CFAR_MIN_TRAIN / 2, CFAR_MAX_CELLS);
+    p->rank = config_int("CFAR_OS_RANK", CFAR_DEFAULT_RANK, 51, 99);
+
+    if (config_get_value("CFAR_PFA", value, sizeof(value)) == 0) {
+        double pfa = atof(value);
+        if (pfa > 0 && pfa < 0.5) {
+            p->pfa = pfa;
+        } else {
+            printf("⚠️ CFAR_PFA=%s вне пределов (0, 0.5), используется %g\n", value, CFAR_DEFAULT_PFA);
+        }
+    }
+}
+
+/**
+ * Освобождение порогов
+ */
+void cfar_release(void) {
+    pthread_mutex_lock(&cfar_mutex);
+    free(thresholds);
+    free(measured);
+    thresholds = NULL;
+    measured = NULL;
+    cell_count = 0;
+    pthread_mutex_unlock(&cfar_mutex);
+}
+
+/**
+ * Сброс порогов (размер - охват плана сканирования) и чтение параметров
+ * До первого пересчета каналы сравниваются с порогом по шуму канала
+ * @return 0 при успехе, -1 при ошибке
+ */
+int cfar_reset(void) {
+    int count = scan_plan_get()->channel_count;
+
+    cfar_release();
+
+    pthread_mutex_lock(&cfar_mutex);
+    load_config(&params);
+    memset(&stats, 0, sizeof(stats));
+    stats.mode = params.mode;
+    if (params.mode != CFAR_OFF) {
+        thresholds = calloc(count, 1);
+        measured = calloc(count, 1);
+        if (!thresholds || !measured) {
+            free(thresholds);
+            free(measured);
+            thresholds = NULL;
+            measured = NULL;
+            pthread_mutex_unlock(&cfar_mutex);
+            return -1;
+        }
+        cell_count = count;
+        stats.cells = count;
+    }
+    pthread_mutex_unlock(&cfar_mutex);
+
+    if (params.mode != CFAR_OFF) {
+        printf("📶 Обнаружитель %s-CFAR: защитных %d МГц, обучающих %d МГц с каждой стороны, Pfa %g\n",
+               params.mode == CFAR_OS ? "OS" : "CA", params.guard, params.train, params.pfa);
+    }
+    return 0;
+}
+
+/**
+ * Пересчет порогов по карте обхода (после обхода)
+ * Измеренными считаются каналы с отсчетом не раньше since_ns: уровни
+ * каналов, не посещенных в обходе (уточнение в режиме bands), устарели
+ * @param since_ns Начало обхода по часам приемника
+ * @return Каналов с порогом CFAR, -1 если CFAR выключен
+ */
+int cfar_update(uint64_t since_ns) {
+    const channel_store_t *store = channel_store_get();
+    int estimated = -1;
+
+    pthread_mutex_lock(&cfar_mutex);
+    if (thresholds && store->count == cell_count) {
+        int count = 0;
+        for (int i = 0; i < cell_count; i++) {
+            measured[i] = store->last_update[i] != 0 && store->last_update[i] >= since_ns;
+            count += measured[i];
+        }
+        estimated = cfar_detect(store->level, measured, cell_count, &params, thresholds);
+
+        uint32_t sum = 0;
+        uint8_t lowest = 100;
+        uint8_t highest = 0;
+        for (int i = 0; i < cell_count; i++) {
+            if (!thresholds[i]) continue;
+            sum += thresholds[i];
+            if (thresholds[i] < lowest) lowest = thresholds[i];
+            if (thresholds[i] > highest) highest = thresholds[i];
+        }
+        stats.updates++;
+        stats.measured = count;
+        stats.estimated = estimated;
+        stats.min_threshold = estimated > 0 ? lowest : 0;
+        stats.max_threshold = highest;
+        stats.mean_threshold = estimated > 0 ? (uint8_t)(sum / estimated) : 0;
+    }
+    pthread_mutex_unlock(&cfar_mutex);
+    return estimated;
+}
+
+/**
+ * Порог CFAR канала
+ * @return Порог RSSI (%), 0 - CFAR выключен или оценки нет
+ */
+uint8_t cfar_threshold(uint16_t frequency) {
+    uint8_t threshold = 0;
+
+    if (params.mode == CFAR_OFF) return 0;
+
+    pthread_mutex_lock(&cfar_mutex);
+    int channel = scan_plan_channel(frequency);
+    if (thresholds && channel >= 0 && channel < cell_count) threshold = thresholds[channel];
+    pthread_mutex_unlock(&cfar_mutex);
+    return threshold;
+}
+
+/**
+ * Копия порогов каналов за одну блокировку
+ * @param out Пороги каналов плана (размер count)
+ * @param count Охват плана
+ * @return Скопировано ячеек, 0 - CFAR выключен или размер не совпал
+ */
+int cfar_snapshot(uint8_t *out, int count) {
+    int copied = 0;
+
+    if (!out || params.mode == CFAR_OFF) return 0;
+
+    pthread_mutex_lock(&cfar_mutex);
+    if (thresholds && count == cell_count) {
+        memcpy(out, thresholds, cell_count);
+        copied = cell_count;
+    }
+    pthread_mutex_unlock(&cfar_mutex);
+    return copied;
+}
+
+/**
+ * Статистика последнего пересчета порогов
+ */
+void get_cfar_stats(cfar_stats_t *out) {
+    if (!out) return;
+
+    pthread_mutex_lock(&cfar_mutex);
+    *out = stats;
+    pthread_mutex_unlock(&cfar_mutex);
+}
+
+/**
+ * Печать порогов CFAR последнего обхода
+ */
+void cfar_print_stats(void) {
+    cfar_stats_t s;
+    get_cfar_stats(&s);
+    if (s.mode == CFAR_OFF || s.updates == 0) return;
+
+    printf("   Порог %s-CFAR: ср. %u%%, от %u%% до %u%% (каналов с оценкой %d из %d измеренных), пересчетов %u\n",
+           s.mode == CFAR_OS ? "OS" : "CA", s.mean_threshold, s.min_threshold, s.max_threshold,
+           s.estimated, s.measured, s.updates);
+}
@@ -0,0 +1,65 @@
+#ifndef CFAR_H
+#define CFAR_H
+
+#include "fpv_interceptor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Обнаружитель (DETECTOR): карта шума каналов или CFAR по спектру
+typedef enum {
+    CFAR_OFF = 0,   // Порог относительно шума канала (noise_floor.c)
+    CFAR_CA,        // Среднее обучающих ячеек (cell-averaging)
+    CFAR_OS         // Порядковая статистика обучающих ячеек (ordered-statistic)
+} cfar_mode_t;
+
+// Параметры CFAR; ячейка - канал плана (1 МГц)
+typedef struct {
+    int mode;       // CFAR_OFF, CFAR_CA или CFAR_OS
+    int guard;      // Защитных ячеек с каждой стороны (CFAR_GUARD)
+    int train;      // Обучающих ячеек с каждой стороны (CFAR_TRAIN)
+    double pfa;     // Вероятность ложной тревоги на ячейку (CFAR_PFA)
+    int rank;       // Ранг OS, % обучающих ячеек (CFAR_OS_RANK, 51-99)
+} cfar_params_t;
+
+typedef struct {
+    int mode;             // Обнаружитель
+    uint32_t updates;     // Пересчетов порогов (по обходу на пересчет)
+    int cells;            // Ячеек спектра
+    int measured;         // Измеренных ячеек
+    int estimated;        // Ячеек с порогом CFAR
+    uint8_t min_threshold;
+    uint8_t max_threshold;
+    uint8_t mean_threshold;
+} cfar_stats_t;
+
+void cfar_default_params(cfar_params_t *params);
+
+// Пороги CFAR по спектру за O(N): thresholds[i] - порог ячейки i,
+// 0 если обучающих ячеек меньше CFAR_MIN_TRAIN. valid - измеренные
+// ячейки (NULL - все)
+// @return Ячеек с порогом, -1 при ошибке
+int cfar_detect(const uint8_t *levels, const uint8_t *valid, int count,
+                const cfar_params_t *params, uint8_t *thresholds);
+
+// Пороги каналов по карте обхода (размер - охват плана)
+int cfar_reset(void);
+void cfar_release(void);
+int cfar_update(uint64_t since_ns);
+
+// Порог CFAR канала; 0 - CFAR выключен или оценки нет
+uint8_t cfar_threshold(uint16_t frequency);
+
+// Копия порогов каналов за одну блокировку (пакетный анализ)
+// @return Скопировано ячеек, 0 - CFAR выключен
+int cfar_snapshot(uint8_t *out, int count);
+
+void get_cfar_stats(cfar_stats_t *out);
+void cfar_print_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CFAR_H
@@ -0,0 +1,125 @@
+#include "channel_store.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Хранилище состояния каналов
+ * Все массивы каналов размещаются одним блоком, каждый с начала строки
+ * кэша. История, время отсчетов, позиция записи, среднее и время последнего
+ * отсчета при STATE_FILE берутся из разделов файла состояния (тоже
+ * выровненных), остальное - производные данные в памяти.
+ */
+
+static channel_store_t store;
+static void *block = NULL;   // Блок производных массивов
+static int mapped = 0;       // История в файле состояния
+
+/**
+ * Выделение массива из блока: смещение выравнивается на строку кэша
+ * @param base Начало блока (NULL - только подсчет размера)
+ * @param offset Текущее смещение, сдвигается за массив
+ */
+static void* carve(uint8_t *base, size_t *offset, size_t size) {
+    size_t start = (*offset + CHANNEL_STORE_ALIGN - 1) & ~(size_t)(CHANNEL_STORE_ALIGN - 1);
+    *offset = start + size;
+    return base ? base + start : NULL;
+}
+
+/**
+ * Раскладка производных массивов (и истории, если она не в файле)
+ * @return Размер блока
+ */
+static size_t layout(uint8_t *base, int count, int with_history) {
+    size_t offset = 0;
+    size_t n = (size_t)count;
+
+    if (with_history) {
+        store.history = carve(base, &offset, n * sizeof(*store.history));
+        store.time_ns = carve(base, &offset, n * sizeof(*store.time_ns));
+        store.index = carve(base, &offset, n);
+        store.smoothed = carve(base, &offset, n);
+        store.last_update = carve(base, &offset, n * sizeof(uint64_t));
+    }
+    store.sum = carve(base, &offset, n * sizeof(uint32_t));
+    store.sum_sq = carve(base, &offset, n * sizeof(uint32_t));
+    store.recent_sum = carve(base, &offset, n * sizeof(uint32_t));
+    store.old_sum = carve(base, &offset, n * sizeof(uint32_t));
+    store.samples = carve(base, &offset, n);
+    store.pairs = carve(base, &offset, n);
+    store.changes = carve(base, &offset, n);
+    store.extrema = carve(base, &offset, n);
+    store.min = carve(base, &offset, n);
+    store.max = carve(base, &offset, n);
+    store.min_head = carve(base, &offset, n);
+    store.min_len = carve(base, &offset, n);
+    store.max_head = carve(base, &offset, n);
+    store.max_len = carve(base, &offset, n);
+    store.min_queue = carve(base, &offset, n * sizeof(*store.min_queue));
+    store.max_queue = carve(base, &offset, n * sizeof(*store.max_queue));
+    store.level = carve(base, &offset, n);
+    return offset;
+}
+
+/**
+ * Размещение хранилища
+ * @param count Охват плана сканирования
+ * @return 1 - история восстановлена из файла состояния, 0 - пустая, -1 при ошибке
+ */
+int channel_store_init(int count) {
+    channel_store_free();
+    if (count <= 0) return -1;
+
+    // Разделы файла состояния: история и карта шума
+    size_t sizes[STATE_SECTION_COUNT] = {0};
+    sizes[STATE_RSSI_HISTORY] = (size_t)count * sizeof(*store.history);
+    sizes[STATE_RSSI_TIME] = (size_t)count * sizeof(*store.time_ns);
+    sizes[STATE_RSSI_INDEX] = (size_t)count;
+    sizes[STATE_RSSI_SMOOTHED] = (size_t)count;
+    sizes[STATE_LAST_UPDATE] = (size_t)count * sizeof(uint64_t);
+    sizes[STATE_NOISE_FLOOR] = noise_floor_state_size(count);
+
+    mapped = scan_state_open(sizes) >= 0;
+
+    size_t size = layout(NULL, count, !mapped);
+    size = (size + CHANNEL_STORE_ALIGN - 1) & ~(size_t)(CHANNEL_STORE_ALIGN - 1);
+    if (posix_memalign(&block, CHANNEL_STORE_ALIGN, size) != 0) {
+        block = NULL;
+        if (mapped) scan_state_close();
+        mapped = 0;
+        return -1;
+    }
+    memset(block, 0, size);
+    layout((uint8_t*)block, count, !mapped);
+
+    if (mapped) {
+        store.history = scan_state_section(STATE_RSSI_HISTORY);
+        store.time_ns = scan_state_section(STATE_RSSI_TIME);
+        store.index = scan_state_section(STATE_RSSI_INDEX);
+        store.smoothed = scan_state_section(STATE_RSSI_SMOOTHED);
+        store.last_update = scan_state_section(STATE_LAST_UPDATE);
+    }
+    store.count = count;
+
+    return mapped && scan_state_restored() ? 1 : 0;
+}
+
+/**
+ * Освобождение хранилища (и закрытие файла состояния)
+ */
+void channel_store_free(void) {
+    if (mapped) {
+        scan_state_close();
+        mapped = 0;
+    }
+    free(block);
+    block = NULL;
+    memset(&store, 0, sizeof(store));
+}
+
+/**
+ * Хранилище состояния каналов
+ */
+channel_store_t* channel_store_get(void) {
+    return &store;
+}
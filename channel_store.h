@@ -0,0 +1,62 @@
+#ifndef CHANNEL_STORE_H
+#define CHANNEL_STORE_H
+
+#include "fpv_interceptor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Выравнивание массивов хранилища (строка кэша)
+#define CHANNEL_STORE_ALIGN 64
+
+// Строка истории канала дополнена до целого числа строк кэша
+#define RSSI_STRIDE ((RSSI_SAMPLES + CHANNEL_STORE_ALIGN - 1) & ~(CHANNEL_STORE_ALIGN - 1))
+
+// Состояние каналов по охвату плана: одно поле - один массив (SoA),
+// каждый массив начинается со строки кэша. Обход и ядра признаков читают
+// одно поле подряд по всем каналам, не затягивая в кэш остальные.
+typedef struct {
+    int count;                            // Каналов (охват плана сканирования)
+
+    // История отсчетов (в разделах состояния при STATE_FILE)
+    uint8_t (*history)[RSSI_STRIDE];      // Кольцо RSSI канала
+    uint64_t (*time_ns)[RSSI_SAMPLES];    // Время отсчетов кольца
+    uint8_t *index;                       // Позиция записи в кольце
+    uint8_t *smoothed;                    // Среднее окна
+    uint64_t *last_update;                // Время последнего отсчета
+
+    // Скользящее окно (пересчитывается по истории после восстановления)
+    uint32_t *sum;                        // Сумма отсчетов окна
+    uint32_t *sum_sq;                     // Сумма квадратов
+    uint32_t *recent_sum;                 // Сумма новейших отсчетов тренда
+    uint32_t *old_sum;                    // Сумма старейших отсчетов тренда
+    uint8_t *samples;                     // Действительных отсчетов в окне
+    uint8_t *pairs;                       // Соседних пар
+    uint8_t *changes;                     // Пар с заметным изменением
+    uint8_t *extrema;                     // Локальных пиков и провалов
+    uint8_t *min;                         // Минимум окна (голова очереди)
+    uint8_t *max;                         // Максимум окна
+    uint8_t *min_head, *min_len;          // Монотонные очереди ячеек кольца
+    uint8_t *max_head, *max_len;
+    uint8_t (*min_queue)[RSSI_STRIDE];
+    uint8_t (*max_queue)[RSSI_STRIDE];
+
+    // Карта обхода: последний проанализированный RSSI частоты
+    uint8_t *level;
+} channel_store_t;
+
+// Размещение хранилища для охвата плана; с STATE_FILE история
+// размещается в разделах состояния (scan_state.c)
+// @return 1 - история восстановлена из файла, 0 - пустая, -1 при ошибке
+int channel_store_init(int count);
+void channel_store_free(void);
+
+// Хранилище (count = 0 до инициализации)
+channel_store_t* channel_store_get(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CHANNEL_STORE_H
@@ -0,0 +1,83 @@
+#include "fpv_interceptor.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Стандартные таблицы каналов аналоговых FPV передатчиков
+ * Bands A (Boscam A), B (Boscam B), E (Boscam E / DJI), F (Fatshark / IRC)
+ * и R (Raceband), по 8 каналов в каждой.
+ */
+typedef struct {
+    char name;
+    uint16_t channels[FPV_BAND_CHANNELS];
+} fpv_band_t;
+
+static const fpv_band_t bands[] = {
+    {'A', {5865, 5845, 5825, 5805, 5785, 5765, 5745, 5725}},
+    {'B', {5733, 5752, 5771, 5790, 5809, 5828, 5847, 5866}},
+    {'E', {5705, 5685, 5665, 5645, 5885, 5905, 5925, 5945}},
+    {'F', {5740, 5760, 5780, 5800, 5820, 5840, 5860, 5880}},
+    {'R', {5658, 5695, 5732, 5769, 5806, 5843, 5880, 5917}},
+};
+
+#define BAND_COUNT ((int)(sizeof(bands) / sizeof(bands[0])))
+
+/**
+ * Центральные частоты стандартных каналов в диапазоне
+ * Частоты отсортированы по возрастанию, совпадающие каналы разных
+ * таблиц (например F8 и R7) возвращаются один раз.
+ * @param start_freq Начальная частота
+ * @param end_freq Конечная частота
+ * @param out Выходной массив частот
+ * @param max Размер массива
+ * @return Количество частот
+ */
+int fpv_band_channels(uint16_t start_freq, uint16_t end_freq, uint16_t *out, int max) {
+    int count = 0;
+
+    for (int b = 0; b < BAND_COUNT; b++) {
+        for (int c = 0; c < FPV_BAND_CHANNELS; c++) {
+            uint16_t freq = bands[b].channels[c];
+            if (freq < start_freq || freq > end_freq) continue;
+
+            // Вставка с сохранением порядка, без повторов
+            int pos = count;
+            while (pos > 0 && out[pos - 1] > freq) pos--;
+            if (pos > 0 && out[pos - 1] == freq) continue;
+            if (count >= max) return count;
+
+            memmove(&out[pos + 1], &out[pos], (count - pos) * sizeof(out[0]));
+            out[pos] = freq;
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * Имя стандартного канала на частоте (например "R7/F8")
+ * @param frequency Частота в МГц
+ * @param name Буфер для имени
+ * @param size Размер буфера
+ * @return 0 если частота совпадает со стандартным каналом, -1 иначе
+ */
+int fpv_band_name(uint16_t frequency, char *name, size_t size) {
+    size_t len = 0;
+
+    if (!name || size == 0) return -1;
+    name[0] = '\0';
+
+    for (int b = 0; b < BAND_COUNT; b++) {
+        for (int c = 0; c < FPV_BAND_CHANNELS; c++) {
+            if (bands[b].channels[c] != frequency) continue;
+
+            int written = snprintf(name + len, size - len, "%s%c%d",
+                                   len > 0 ? "/" : "", bands[b].name, c + 1);
+            if (written < 0 || (size_t)written >= size - len) return 0;
+            len += written;
+        }
+    }
+
+    return len > 0 ? 0 : -1;
+}
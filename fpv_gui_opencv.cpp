@@ -1,4 +1,9 @@
 #include "fpv_interceptor.h"
+#include "rx5808_backend.h"
+#include "scan_queue.h"
+#include "scan_pipeline.h"
+#include "cfar.h"
+#include "signal_track.h"
 #include <gtk/gtk.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <cairo/cairo.h>
@@ -16,6 +21,9 @@ static GtkWidget *stop_button;
 static GtkWidget *frequency_entry;
 static GtkWidget *rssi_chart;
 
+// Отсчетов RSSI в пакете при мониторинге частоты
+#define MONITOR_BURST_SAMPLES 256
+
 // Данные для графика RSSI
 static double rssi_history[100];
 static int rssi_index = 0;
@@ -27,6 +35,11 @@ static gboolean video_capturing = FALSE;
 static guint scan_timer_id = 0;
 static guint video_timer_id = 0;
 
+// Отсчеты сканера (поток опроса frequency_scanner) и очередь для GUI
+#define SCAN_DRAIN_INTERVAL_MS 33 // Разбор очереди с частотой кадров (~30 Гц)
+static gboolean scan_thread_started = FALSE;
+static scan_queue_t scan_queue;
+
 // OpenCV переменные
 static cv::VideoCapture *video_capture = nullptr;
 static cv::Mat current_frame;
@@ -216,83 +229,169 @@ gboolean update_video_display(gpointer data) {
 }
 
 /**
- * Сканирование частот в GUI
+ * Наблюдатель отсчетов сканера: отсчеты обхода после этапа вывода и
+ * отсчеты сопровождения передаются в GUI через очередь scan_queue
+ */
+static void queue_sample(const scan_result_t *sample) {
+    scan_queue_push(&scan_queue, sample);
+}
+
+/**
+ * Разбор результатов сканирования в GUI
+ * Вызывается главным циклом GTK с частотой кадров и забирает из очереди
+ * все накопленные измерения.
  */
 gboolean scan_frequencies(gpointer data) {
     (void)data; // Подавление предупреждения
     if (!scanning) return FALSE;
     
-    static uint16_t current_freq = FREQ_MIN;
-    static int scan_cycle = 0;
     static int signals_found = 0;
-    
-    // Установка частоты
-    if (rx5808_set_frequency(current_freq) == 0) {
-        // Небольшая задержка для стабилизации
-        usleep(50000); // 50 мс
+    static uint32_t last_cycle = 0;
+    static uint64_t rate_start_ns = 0;
+    static int rate_channels = 0;
+    static double channels_per_s = 0;
+    static int rate_updates = 0;
+    static double updates_per_s = 0;
+    static intercept_stats_t intercept; // Оценка перехвата на конец цикла
+    
+    scan_result_t result;
+    int drained = 0;
+    gboolean have_last = FALSE;
+    scan_result_t last;
+    
+    while (scan_queue_pop(&scan_queue, &result) == 0) {
+        drained++;
+        last = result;
+        have_last = TRUE;
         
-        // Чтение RSSI
-        uint8_t rssi = rx5808_read_rssi();
+        // Обновление графика каждым измерением
+        update_rssi_display(result.rssi, result.frequency);
         
-        // Обновление GUI
-        update_rssi_display(rssi, current_freq);
-        
-        // Показ прогресса сканирования
-        int total_channels = (FREQ_MAX - FREQ_MIN) / FREQ_STEP + 1;
-        int current_channel = (current_freq - FREQ_MIN) / FREQ_STEP + 1;
-        int progress_percent = (current_channel * 100) / total_channels;
-        
-        char progress_msg[256];
-        snprintf(progress_msg, sizeof(progress_msg), 
-                "🔍 Сканирование: %d МГц (%d/%d, %d%%) | RSSI: %d%% | Найдено: %d", 
-                current_freq, current_channel, total_channels, progress_percent, rssi, signals_found);
-        update_status(progress_msg);
+        // Сопровождаемый сигнал уже в журнале, видео захватывается
+        if (result.tracking) {
+            if (result.detected) rate_updates++;
+            continue;
+        }
         
-        // Проверка на обнаружение сигнала
-        if (rssi > RSSI_THRESHOLD) {
+        // Обнаружение уже в журнале (этап вывода сканера)
+        if (result.detected) {
             signals_found++;
             char message[256];
             snprintf(message, sizeof(message), 
-                    "🎯 СИГНАЛ ОБНАРУЖЕН: %d МГц, RSSI: %d%% (сигнал #%d) - Сканирование продолжается", 
-                    current_freq, rssi, signals_found);
+                    "🎯 СИГНАЛ ОБНАРУЖЕН: %d МГц, RSSI: %d%% (сигнал #%d) - %s", 
+                    result.frequency, result.rssi, signals_found,
+                    scan_get_tracking() ? "Сопровождение" : "Сканирование продолжается");
             update_status(message);
             
-            // Добавление в список обнаруженных сигналов
-            add_detected_signal(current_freq, rssi, "FPV Video");
-            
             // Захват видео на обнаруженной частоте
-            capture_video_frame(current_freq);
+            capture_video_frame(result.frequency);
             
             // Начало захвата видео (если еще не запущен)
             if (!video_capturing) {
                 video_capturing = TRUE;
                 video_timer_id = g_timeout_add(100, update_video_display, NULL);
-                printf("📹 Захват видео активирован на частоте %d МГц\n", current_freq);
+                printf("📹 Захват видео активирован на частоте %d МГц\n", result.frequency);
             }
         }
         
-        // Переход к следующей частоте
-        current_freq += FREQ_STEP;
-        if (current_freq > FREQ_MAX) {
-            current_freq = FREQ_MIN;
-            scan_cycle++;
-            
-            char cycle_msg[128];
-            snprintf(cycle_msg, sizeof(cycle_msg), 
-                    "🔄 Цикл сканирования #%d завершен. Найдено сигналов: %d", 
-                    scan_cycle, signals_found);
-            update_status(cycle_msg);
+        if (result.cycle != last_cycle) {
+            last_cycle = result.cycle;
+            get_intercept_stats(&intercept);
+            printf("🔄 Цикл сканирования #%u завершен. Найдено сигналов: %d, POI 5 с: %u%%, худшая задержка %.1f с\n",
+                   last_cycle, signals_found, intercept.poi[1], intercept.revisit_max_ns / 1e9);
         }
-    } else {
-        char error_msg[128];
-        snprintf(error_msg, sizeof(error_msg), 
-                "❌ Ошибка установки частоты %d МГц", current_freq);
-        update_status(error_msg);
+    }
+    
+    // Скорость сканирования по окну около секунды
+    uint64_t now = get_monotonic_ns();
+    if (rate_start_ns == 0) rate_start_ns = now;
+    rate_channels += drained;
+    if (now - rate_start_ns >= 1000000000ULL) {
+        channels_per_s = rate_channels * 1e9 / (now - rate_start_ns);
+        updates_per_s = rate_updates * 1e9 / (now - rate_start_ns);
+        rate_start_ns = now;
+        rate_channels = 0;
+        rate_updates = 0;
+    }
+    
+    // Показ сопровождения или прогресса сканирования
+    if (have_last && last.tracking) {
+        track_stats_t track;
+        get_track_stats(&track);
+        
+        char track_msg[256];
+        snprintf(track_msg, sizeof(track_msg),
+                "🎯 Сопровождение: %d МГц | RSSI: %d%% | Сигнал: %s | %.1f обн/с | Завершено сопровождений: %u",
+                last.frequency, last.rssi, last.detected ? "есть" : "потерян",
+                updates_per_s, track.tracks);
+        update_status(track_msg);
+    } else if (have_last && !last.detected) {
+        int total_channels = scan_plan_get()->frequency_count;
+        int current_channel = scan_plan_position(last.frequency) + 1;
+        int progress_percent = (current_channel * 100) / total_channels;
+        
+        char progress_msg[256];
+        snprintf(progress_msg, sizeof(progress_msg), 
+                "🔍 Сканирование: %d МГц (%d/%d, %d%%) | RSSI: %d%% | Найдено: %d | %.0f кан/с | Цикл #%u | POI 5 с: %u%%", 
+                last.frequency, current_channel, total_channels, progress_percent, last.rssi,
+                signals_found, channels_per_s, last.cycle + 1, intercept.poi[1]);
+        update_status(progress_msg);
     }
     
     return TRUE;
 }
 
+/**
+ * Запуск сканирования и разбора очереди
+ * Сканирует тот же движок, что и консольный сканер (scan_continuous_start):
+ * режим обхода, паузы плана, анализ RSSI, пороги шума или CFAR,
+ * планировщик визитов и сопровождение при TRACK_SIGNALS=1
+ * @return 0 при успехе, -1 при ошибке
+ */
+static int start_scan_worker(void) {
+    if (scan_thread_started) return 0;
+    
+    scan_queue_init(&scan_queue);
+    scan_set_observer(queue_sample);
+    
+    if (scan_continuous_start() != 0) {
+        scan_set_observer(NULL);
+        return -1;
+    }
+    
+    scan_thread_started = TRUE;
+    scan_timer_id = g_timeout_add(SCAN_DRAIN_INTERVAL_MS, scan_frequencies, NULL);
+    return 0;
+}
+
+/**
+ * Остановка потока сканирования (ожидание текущего канала)
+ */
+static void stop_scan_worker(void) {
+    if (scan_timer_id) {
+        g_source_remove(scan_timer_id);
+        scan_timer_id = 0;
+    }
+    
+    if (!scan_thread_started) return;
+    
+    // Текущий обход прерывается на следующей частоте
+    scan_continuous_stop();
+    scan_set_observer(NULL);
+    scan_thread_started = FALSE;
+    
+    if (scan_queue_dropped(&scan_queue) > 0) {
+        printf("⚠️ GUI не успел разобрать %u результатов сканирования\n",
+               scan_queue_dropped(&scan_queue));
+    }
+    
+    // Задержка обнаружения и вероятность перехвата за время сканирования,
+    // шум каналов и пороги CFAR (пересчитываются после каждого обхода)
+    intercept_print_stats();
+    noise_floor_print_stats();
+    cfar_print_stats();
+}
+
 /**
  * Обработчик кнопки "Начать сканирование"
  */
@@ -305,8 +404,13 @@ void on_scan_button_clicked(GtkWidget *widget, gpointer data) {
         
         update_status("🔍 Начало сканирования...");
         
-        // Запуск таймера сканирования
-        scan_timer_id = g_timeout_add(100, scan_frequencies, NULL);
+        // Запуск потока сканирования
+        if (start_scan_worker() != 0) {
+            scanning = FALSE;
+            gtk_button_set_label(GTK_BUTTON(scan_button), "🔍 Начать сканирование");
+            gtk_widget_set_sensitive(stop_button, FALSE);
+            update_status("❌ Ошибка запуска потока сканирования");
+        }
     } else {
         scanning = FALSE;
         gtk_button_set_label(GTK_BUTTON(scan_button), "🔍 Начать сканирование");
@@ -314,11 +418,8 @@ void on_scan_button_clicked(GtkWidget *widget, gpointer data) {
         
         update_status("⏹️ Сканирование остановлено");
         
-        // Остановка таймеров
-        if (scan_timer_id) {
-            g_source_remove(scan_timer_id);
-            scan_timer_id = 0;
-        }
+        // Остановка потока и таймеров
+        stop_scan_worker();
         if (video_timer_id) {
             g_source_remove(video_timer_id);
             video_timer_id = 0;
@@ -340,11 +441,8 @@ void on_stop_button_clicked(GtkWidget *widget, gpointer data) {
     
     update_status("⏹️ Все операции остановлены");
     
-    // Остановка таймеров
-    if (scan_timer_id) {
-        g_source_remove(scan_timer_id);
-        scan_timer_id = 0;
-    }
+    // Остановка потока и таймеров
+    stop_scan_worker();
     if (video_timer_id) {
         g_source_remove(video_timer_id);
         video_timer_id = 0;
@@ -359,8 +457,18 @@ void on_monitor_frequency(GtkWidget *widget, gpointer data) {
     const char *freq_text = gtk_entry_get_text(GTK_ENTRY(frequency_entry));
     int frequency = atoi(freq_text);
     
-    if (frequency < FREQ_MIN || frequency > FREQ_MAX) {
-        update_status("❌ Неверная частота. Диапазон: 5725-6000 МГц");
+    const scan_plan_t *plan = scan_plan_get();
+    if (frequency < plan->freq_min || frequency > plan->freq_max) {
+        char message[128];
+        snprintf(message, sizeof(message), "❌ Неверная частота. Диапазон: %d-%d МГц",
+                 plan->freq_min, plan->freq_max);
+        update_status(message);
+        return;
+    }
+    
+    // Приемник занят потоком сканирования
+    if (scan_thread_started) {
+        update_status("⚠️ Остановите сканирование перед мониторингом частоты");
         return;
     }
     
@@ -371,19 +479,23 @@ void on_monitor_frequency(GtkWidget *widget, gpointer data) {
         // Небольшая задержка для стабилизации
         usleep(100000); // 100 мс
         
-        // Чтение RSSI несколько раз для усреднения
-        uint8_t rssi = rx5808_read_rssi_averaged(5);
+        // Пакет отсчетов RSSI подряд на скорости шины
+        uint8_t samples[MONITOR_BURST_SAMPLES];
+        rssi_stats_t burst;
+        int count = rx5808_read_rssi_burst(samples, MONITOR_BURST_SAMPLES);
+        rssi_burst_stats(samples, count, &burst);
+        uint8_t rssi = burst.avg_rssi;
         update_rssi_display(rssi, frequency);
         
         char monitor_msg[128];
         snprintf(monitor_msg, sizeof(monitor_msg), 
-                "✅ Мониторинг %d МГц | RSSI: %d%% | %s", 
-                frequency, rssi, 
-                rssi > RSSI_THRESHOLD ? "СИГНАЛ ОБНАРУЖЕН!" : "Сигнал не обнаружен");
+                "✅ Мониторинг %d МГц | RSSI: %d%% (%d-%d%%, %d отсч.) | %s", 
+                frequency, rssi, burst.min_rssi, burst.max_rssi, burst.samples,
+                rssi > noise_floor_threshold(frequency) ? "СИГНАЛ ОБНАРУЖЕН!" : "Сигнал не обнаружен");
         update_status(monitor_msg);
         
         // Если сигнал обнаружен, начинаем захват видео
-        if (rssi > RSSI_THRESHOLD) {
+        if (rssi > noise_floor_threshold(frequency)) {
             add_detected_signal(frequency, rssi, "Manual Monitor");
             capture_video_frame(frequency);
             
@@ -519,9 +631,7 @@ gboolean on_window_delete_event(GtkWidget *widget, GdkEvent *event, gpointer dat
     scanning = FALSE;
     video_capturing = FALSE;
     
-    if (scan_timer_id) {
-        g_source_remove(scan_timer_id);
-    }
+    stop_scan_worker();
     if (video_timer_id) {
         g_source_remove(video_timer_id);
     }
@@ -548,6 +658,11 @@ int main(int argc, char *argv[]) {
     
     printf("🚀 Запуск FPV Interceptor GUI с OpenCV...\n");
     
+    // Выбор бэкенда приемника (--backend=hw|stub|sim или RECEIVER_BACKEND)
+    if (rx5808_select_backend_from_args(&argc, argv) != 0) {
+        return -1;
+    }
+    
     // Инициализация модулей
     if (rx5808_init() != 0) {
         printf("❌ Ошибка инициализации RX5808\n");
@@ -583,7 +698,8 @@ int main(int argc, char *argv[]) {
     // Запуск главного цикла GTK
     gtk_main();
     
-    // Очистка ресурсов
+    // Очистка ресурсов (анализатор закрывает файл состояния)
+    rssi_analyzer_cleanup();
     cleanup_resources();
     video_detector_cleanup();
     rx5808_cleanup();
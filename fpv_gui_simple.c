@@ -123,7 +123,13 @@ gboolean scan_frequencies(gpointer data) {
     (void)data; // Подавление предупреждения
     if (!scanning) return FALSE;
     
-    static uint16_t current_freq = FREQ_MIN;
+    static uint16_t current_freq = 0;
+    
+    // Обход частот плана сканирования
+    if (scan_plan_get()->frequency_count == 0) return FALSE;
+    if (scan_plan_position(current_freq) < 0) {
+        scan_plan_frequencies(0, UINT16_MAX, &current_freq, 1);
+    }
     
     // Заглушка для сканирования - симулируем RSSI
     uint8_t rssi = 30 + (rand() % 40); // Случайный RSSI 30-70
@@ -132,7 +138,7 @@ gboolean scan_frequencies(gpointer data) {
     update_rssi_display(rssi, current_freq);
     
     // Проверка на обнаружение сигнала
-    if (rssi > RSSI_THRESHOLD) {
+    if (rssi > noise_floor_threshold(current_freq)) {
         char message[256];
         snprintf(message, sizeof(message), 
                 "🎯 Сигнал обнаружен: %d МГц, RSSI: %d%%", current_freq, rssi);
@@ -145,11 +151,12 @@ gboolean scan_frequencies(gpointer data) {
         }
     }
     
-    // Переход к следующей частоте
-    current_freq += FREQ_STEP;
-    if (current_freq > FREQ_MAX) {
-        current_freq = FREQ_MIN;
+    // Переход к следующей частоте плана
+    uint16_t next = current_freq;
+    if (scan_plan_frequencies(current_freq + 1, UINT16_MAX, &next, 1) == 0) {
+        scan_plan_frequencies(0, UINT16_MAX, &next, 1);
     }
+    current_freq = next;
     
     return TRUE;
 }
@@ -220,8 +227,12 @@ void on_monitor_frequency(GtkWidget *widget, gpointer data) {
     const char *freq_text = gtk_entry_get_text(GTK_ENTRY(frequency_entry));
     int frequency = atoi(freq_text);
     
-    if (frequency < FREQ_MIN || frequency > FREQ_MAX) {
-        update_status("❌ Неверная частота. Диапазон: 5725-6000 МГц");
+    const scan_plan_t *plan = scan_plan_get();
+    if (frequency < plan->freq_min || frequency > plan->freq_max) {
+        char message[128];
+        snprintf(message, sizeof(message), "❌ Неверная частота. Диапазон: %d-%d МГц",
+                 plan->freq_min, plan->freq_max);
+        update_status(message);
         return;
     }
     
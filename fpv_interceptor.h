@@ -14,16 +14,49 @@ extern "C" {
 #include <signal.h>
 #include <sys/time.h>
 
-// Конфигурация частот
-#define FREQ_MIN 5725    // Минимальная частота (МГц)
-#define FREQ_MAX 6000    // Максимальная частота (МГц)
-#define FREQ_STEP 1      // Шаг сканирования (МГц)
+// Пределы перестройки RX5808 (МГц); диапазоны обхода задает план сканирования
+#define RX5808_FREQ_MIN 5645
+#define RX5808_FREQ_MAX 6000
+
+// План сканирования по умолчанию (без SCAN_RANGES в конфигурации)
+#define SCAN_DEFAULT_FREQ_MIN  5725 // Минимальная частота (МГц)
+#define SCAN_DEFAULT_FREQ_MAX  6000 // Максимальная частота (МГц)
+#define SCAN_DEFAULT_STEP      1    // Шаг сканирования (МГц)
+#define SCAN_DEFAULT_THRESHOLD 50   // Порог RSSI для детекции сигнала
+#define SCAN_DEFAULT_DWELL_MS  100  // Пауза на частоте (мс)
+
+// Ограничения плана сканирования
+#define SCAN_PLAN_MAX_RANGES   16
+#define SCAN_PLAN_MAX_EXCLUDES 32
+#define SCAN_DWELL_PLAN (-1) // Пауза на частоте берется из плана
 
 // RSSI настройки
-#define RSSI_THRESHOLD 50    // Порог RSSI для детекции сигнала
 #define RSSI_SAMPLES 100     // Количество образцов RSSI для анализа
 #define RSSI_HISTORY_SIZE 50 // Размер истории RSSI
-#define CHANNELS_COUNT (FREQ_MAX - FREQ_MIN + 1) // Количество каналов
+#define MAX_DETECTED_SIGNALS 100 // Размер журнала обнаружений
+
+// Разделы файла состояния (STATE_FILE, scan_state.c)
+enum {
+    STATE_RSSI_HISTORY,   // История RSSI каналов
+    STATE_RSSI_TIME,      // Время отсчетов истории
+    STATE_RSSI_INDEX,     // Позиция записи в истории
+    STATE_RSSI_SMOOTHED,  // Сглаженный RSSI
+    STATE_LAST_UPDATE,    // Время последнего отсчета канала
+    STATE_NOISE_FLOOR,    // Карта шума
+    STATE_SIGNALS,        // Журнал обнаружений
+    STATE_SECTION_COUNT
+};
+
+// Стандартные каналы FPV (таблицы A/B/E/F/R по 8 каналов)
+#define FPV_BAND_CHANNELS 8
+
+// Режимы обхода диапазона
+#define SCAN_MODE_FULL  0 // Все частоты плана сканирования
+#define SCAN_MODE_BANDS 1 // Стандартные каналы, затем уточнение по 1 МГц
+#define SCAN_MODE_ADAPTIVE 2 // Приоритетные повторные визиты активных каналов
+
+// Конфигурационный файл (создается make create-config)
+#define FPV_CONFIG_FILE "config/fpv_config.conf"
 
 // GPIO пины для RX5808
 #define CS_PIN 8      // Chip Select
@@ -32,6 +65,9 @@ extern "C" {
 #define SCK_PIN 11    // Serial Clock
 #define RSSI_PIN 7    // RSSI Input
 
+// Несколько приемников на отдельных CS (см. CS_PINS в конфигурации)
+#define RX5808_MAX_RECEIVERS 4
+
 // RX5808 команды
 #define RX5808_CMD_READ  0x00
 #define RX5808_CMD_WRITE 0x80
@@ -40,7 +76,7 @@ extern "C" {
 typedef struct {
     uint16_t frequency;    // Частота в МГц
     uint8_t rssi;          // Уровень RSSI (0-100)
-    uint32_t timestamp;    // Временная метка
+    uint64_t timestamp_ns; // Время CLOCK_MONOTONIC (нс)
     char signal_type[32];  // Тип сигнала
     int quality;          // Качество сигнала (0-100)
 } signal_info_t;
@@ -51,39 +87,173 @@ typedef struct {
     uint8_t max_rssi;      // Максимальный RSSI
     uint8_t min_rssi;      // Минимальный RSSI
     uint8_t avg_rssi;      // Средний RSSI
+    uint8_t deviation;     // Среднеквадратичное отклонение RSSI
     int samples;           // Количество образцов
     uint8_t stability;     // Стабильность сигнала
-    uint32_t last_update;  // Время последнего обновления
+    uint64_t last_update_ns; // Время последнего отсчета (нс, часы приемника)
 } rssi_stats_t;
 
+// Признаки окна истории канала (слитное ядро анализатора)
+typedef struct {
+    uint16_t frequency;    // Частота
+    uint8_t samples;       // Отсчетов в окне
+    uint8_t mean;          // Среднее
+    uint8_t min;           // Минимум
+    uint8_t max;           // Максимум
+    uint8_t range;         // Размах (глубина модуляции)
+    uint8_t trend;         // Тренд (50 - без изменения)
+    uint8_t extrema;       // Локальных пиков и провалов
+    uint8_t change_rate;   // Доля соседних пар с заметным изменением (%)
+    uint8_t stability;     // Оценка стабильности (0-100)
+    uint8_t modulation;    // Оценка амплитудной модуляции (0-100)
+    uint8_t periodicity;   // Оценка периодичности (0-100)
+    uint8_t change_score;  // Оценка частоты изменений (0-100)
+    uint8_t fpv_score;     // Оценка характеристик FPV (0-100)
+} rssi_features_t;
+
 typedef struct {
     uint16_t frequency;
     uint8_t rssi;
-    uint32_t timestamp;
+    uint64_t timestamp_ns; // Время обнаружения (нс, часы приемника)
     char filename[256];
     int video_quality;
     int motion_detected;
 } detected_signal_t;
 
+// Статистика стабилизации PLL после перестройки
+#define SETTLE_STEP_BUCKETS 5 // Группы по величине шага перестройки
+
+typedef struct {
+    uint32_t tunes;                         // Количество перестроек
+    uint32_t timeouts;                      // Перестройки без сходимости RSSI
+    uint64_t settle_us_total;               // Суммарное время ожидания (мкс)
+    uint32_t saved_ms_total;                // Экономия относительно 50 мс на перестройку
+    uint32_t lock_us[SETTLE_STEP_BUCKETS];  // Изученное время захвата по группам шага
+} settle_stats_t;
+
+// Статистика обращений к регистрам RX5808 (теневой кэш и объем шины)
+typedef struct {
+    uint64_t writes_issued;  // Записей регистров отправлено по SPI
+    uint64_t writes_elided;  // Записей пропущено (значение совпало с кэшем)
+    uint64_t reads;          // Чтений регистров (включая RSSI)
+    uint64_t bus_bytes;      // Байт по шине: счетчик бэкенда или оценка
+    int bus_bytes_measured;  // 1 - счетчик бэкенда, 0 - оценка (2 байта на запись или чтение)
+} register_stats_t;
+
+// Распределение интервалов между визитами канала
+#define REVISIT_BUCKETS 16 // Корзина i - интервал до 2^i мс
+
+typedef struct {
+    uint32_t visits;                      // Количество визитов
+    uint32_t detections;                  // Визитов с RSSI выше порога
+    uint64_t revisit_total_ns;            // Сумма интервалов между визитами
+    uint64_t revisit_max_ns;              // Максимальный интервал
+    uint32_t histogram[REVISIT_BUCKETS];  // Распределение интервалов
+    uint32_t weight;                      // Вес активности на момент последнего визита
+    uint64_t revisit_ewma_ns;             // Скользящая оценка интервала между визитами
+} revisit_stats_t;
+
+// Время до обнаружения и вероятность перехвата
+#define INTERCEPT_PHASE_BUCKETS 4 // Четверти обхода
+#define INTERCEPT_POI_DURATIONS 3 // Длительности включения для оценки POI
+#define INTERCEPT_PHASE_UNKNOWN 255
+
+// Новое обнаружение (первое после тихого визита канала)
+typedef struct {
+    uint16_t frequency;
+    uint8_t phase;            // Фаза обхода (%), INTERCEPT_PHASE_UNKNOWN до конца обхода
+    uint32_t cycle;           // Номер обхода
+    uint64_t timestamp_ns;    // Время обнаружения (часы приемника)
+    uint64_t since_visit_ns;  // Время с предыдущего визита канала (0 - первый визит)
+    uint64_t sweep_offset_ns; // Время от начала обхода
+} intercept_record_t;
+
+typedef struct {
+    uint32_t detections;                    // Новых обнаружений
+    uint32_t first_visit;                   // Из них при первом визите канала
+    uint64_t since_visit_total_ns;          // Сумма времени с предыдущего визита
+    uint64_t since_visit_max_ns;            // Наибольшее время (наблюдаемая худшая задержка)
+    uint32_t phase[INTERCEPT_PHASE_BUCKETS]; // Обнаружения по четвертям обхода
+    int channels;                           // Частот плана с оценкой интервала визитов
+    int unvisited;                          // Частот плана без оценки (меньше двух визитов)
+    uint64_t revisit_mean_ns;               // Средний интервал визитов
+    uint64_t revisit_max_ns;                // Наибольший интервал (худшая задержка)
+    uint32_t poi_ms[INTERCEPT_POI_DURATIONS]; // Длительность включения передатчика
+    uint8_t poi[INTERCEPT_POI_DURATIONS];     // Вероятность перехвата за это время (%)
+} intercept_stats_t;
+
+// Диапазон плана сканирования
+typedef struct {
+    uint16_t start;     // Начальная частота (МГц)
+    uint16_t end;       // Конечная частота (МГц)
+    uint16_t step;      // Шаг (МГц)
+    uint16_t dwell_ms;  // Пауза на частоте (мс)
+    uint8_t threshold;  // Порог RSSI обнаружения (%)
+} scan_range_t;
+
+// План сканирования: диапазоны, исключенные частоты и охват таблиц каналов
+typedef struct {
+    scan_range_t ranges[SCAN_PLAN_MAX_RANGES];
+    int range_count;
+    uint16_t exclude_start[SCAN_PLAN_MAX_EXCLUDES];
+    uint16_t exclude_end[SCAN_PLAN_MAX_EXCLUDES];
+    int exclude_count;
+    uint16_t freq_min;    // Нижняя частота всех диапазонов
+    uint16_t freq_max;    // Верхняя частота всех диапазонов
+    int channel_count;    // Размер таблиц каналов: freq_max - freq_min + 1
+    int frequency_count;  // Частот в полном обходе
+    uint8_t threshold;    // Порог вне диапазонов (RSSI_THRESHOLD конфигурации)
+    uint16_t dwell_ms;    // Пауза вне диапазонов (SCAN_DWELL_TIME)
+} scan_plan_t;
+
 // Глобальные переменные
-extern detected_signal_t detected_signals[100];
+extern detected_signal_t detected_signals[MAX_DETECTED_SIGNALS];
 extern int detected_count;
 
-// Функции RX5808 драйвера (заглушки для GUI)
+// Функции RX5808 (реализация выбирается бэкендом, см. rx5808_backend.h)
 int rx5808_init(void);
 int rx5808_reset(void);
 void rx5808_write_register(uint8_t reg, uint8_t data);
 uint8_t rx5808_read_register(uint8_t reg);
 int rx5808_set_frequency(uint16_t frequency);
 uint8_t rx5808_read_rssi(void);
+int rx5808_read_rssi_burst(uint8_t *buf, int count);
+int rx5808_read_rssi_burst_ts(uint8_t *buf, uint64_t *timestamps_ns, int count);
 uint8_t rx5808_read_rssi_averaged(int samples);
 void rx5808_get_info(void);
 void rx5808_cleanup(void);
+uint64_t rx5808_now_ns(void);
+void rx5808_delay_us(uint32_t us);
+void rx5808_sleep_until_ns(uint64_t deadline_ns);
+void rx5808_note_detection(uint16_t frequency);
+void rx5808_note_detection_at(int rx, uint16_t frequency, uint64_t timestamp_ns);
+void rx5808_get_register_stats(register_stats_t *out);
+
+// Несколько приемников: функции выше работают с приемником,
+// привязанным к текущему потоку (по умолчанию #0)
+int rx5808_get_receiver_count(void);
+void rx5808_bind_receiver(int rx);
+int rx5808_current_receiver(void);
+
+// Адаптивное ожидание стабилизации PLL
+uint32_t rx5808_settle_wait(uint16_t prev_freq, uint16_t frequency);
+void rx5808_settle_calibrate(int passes);
+void rx5808_settle_reset(void);
+void rx5808_get_settle_stats(settle_stats_t *out);
 
 // Функции анализатора RSSI
 int rssi_analyzer_init(void);
 uint8_t analyze_rssi(uint16_t frequency);
+uint8_t analyze_rssi_sample(uint16_t frequency, uint8_t rssi, uint64_t timestamp_ns);
 void get_rssi_stats(uint16_t frequency, rssi_stats_t *stats);
+int get_rssi_features(uint16_t frequency, rssi_features_t *features);
+int rssi_features_batch(int first, int count, rssi_features_t *out);
+int rssi_spectrum_features(const uint8_t *rows, size_t stride, int samples, int count,
+                           uint16_t first_frequency, rssi_features_t *out);
+int get_rssi_history(uint16_t frequency, uint8_t *rssi, uint64_t *timestamps_ns, int max);
+void rssi_burst_stats(const uint8_t *samples, int count, rssi_stats_t *stats);
+int rssi_decimate(const uint8_t *samples, int count, int factor, uint8_t *out);
+int rssi_decimate_peak(const uint8_t *samples, int count, int factor, uint8_t *out);
 int detect_signal_presence(uint16_t frequency);
 uint8_t analyze_amplitude_modulation(int channel);
 void rssi_analyzer_cleanup(void);
@@ -95,6 +265,7 @@ void save_video_stream(uint16_t frequency);
 void get_video_info(void);
 void set_gui_callbacks(void (*update_callback)(void*), void (*status_callback)(const char*));
 void* get_current_frame(void);
+uint64_t get_current_frame_timestamp_ns(void);
 int analyze_video_quality(void* frame);
 int detect_motion(void* frame);
 void set_video_parameters(int width, int height, int fps);
@@ -106,11 +277,79 @@ int frequency_scanner_init(void);
 int scan_frequency_range(uint16_t start_freq, uint16_t end_freq, int dwell_time);
 int monitor_frequency(uint16_t frequency, int timeout_ms);
 int auto_scan_for_signals(void);
+int scan_continuous(void);
+int scan_continuous_start(void);
+void scan_continuous_stop(void);
+void scan_set_mode(int mode);
+int scan_get_mode(void);
+void scan_set_tracking(int enable);
+int scan_get_tracking(void);
+void get_scan_stats(void);
 void frequency_scanner_cleanup(void);
 
+// Планировщик повторных визитов (режим SCAN_MODE_ADAPTIVE)
+void scan_scheduler_reset(void);
+void scan_scheduler_begin(const uint16_t *list, int count);
+int scan_scheduler_next(uint64_t now_ns, uint16_t *frequency);
+int scan_scheduler_update(uint16_t frequency, uint8_t rssi, uint64_t now_ns, uint64_t *since_visit_ns);
+void get_revisit_stats(uint16_t frequency, revisit_stats_t *out);
+void scan_scheduler_print_stats(void);
+
+// Время до обнаружения и вероятность перехвата
+void intercept_reset(void);
+void intercept_record(uint16_t frequency, uint64_t timestamp_ns, uint64_t since_visit_ns,
+                      uint32_t cycle, uint64_t sweep_offset_ns);
+void intercept_sweep_done(uint32_t cycle, uint64_t duration_ns);
+int get_intercept_records(intercept_record_t *out, int max);
+void get_intercept_stats(intercept_stats_t *out);
+void intercept_print_stats(void);
+
+// План сканирования (config/fpv_config.conf)
+int scan_plan_load(void);
+const scan_plan_t* scan_plan_get(void);
+int scan_plan_channel(uint16_t frequency);
+int scan_plan_allows(uint16_t frequency);
+int scan_plan_position(uint16_t frequency);
+uint8_t scan_plan_threshold(uint16_t frequency);
+uint16_t scan_plan_dwell(uint16_t frequency);
+int scan_plan_frequencies(uint16_t start_freq, uint16_t end_freq, uint16_t *out, int max);
+void scan_plan_print(void);
+
+// Карта шума каналов: пороги обнаружения относительно шума канала
+int noise_floor_reset(void);
+void noise_floor_release(void);
+size_t noise_floor_state_size(int channels);
+void noise_floor_update(uint16_t frequency, uint8_t rssi, uint64_t now_ns);
+uint8_t noise_floor_observe(uint16_t frequency, uint8_t rssi, uint64_t now_ns, int update, uint8_t cfar);
+uint8_t noise_floor_level(uint16_t frequency);
+uint8_t noise_floor_threshold(uint16_t frequency);
+int noise_floor_quiet(uint16_t frequency, uint8_t rssi);
+void noise_floor_print_stats(void);
+
+// Контрольная точка состояния в отображаемом файле
+int scan_state_open(const size_t sizes[STATE_SECTION_COUNT]);
+void* scan_state_section(int section);
+int scan_state_restored(void);
+uint64_t scan_state_rebase(uint64_t timestamp_ns);
+void scan_state_save_signals(void);
+void scan_state_sync(int force);
+void scan_state_close(void);
+
+// Таблицы стандартных каналов
+int fpv_band_channels(uint16_t start_freq, uint16_t end_freq, uint16_t *out, int max);
+int fpv_band_name(uint16_t frequency, char *name, size_t size);
+
 // Утилиты
-uint32_t get_timestamp(void);
+// Все метки времени - 64-битные наносекунды CLOCK_MONOTONIC;
+// календарное время нужно только при экспорте и считается от привязки
+uint64_t get_monotonic_ns(void);
+uint64_t monotonic_to_wall_ns(uint64_t monotonic_ns);
+int format_wall_time(uint64_t monotonic_ns, char *buf, size_t size);
+void time_anchor_refresh(void);
+int config_get_value(const char *key, char *value, size_t size);
 void add_detected_signal(uint16_t frequency, uint8_t rssi, const char* signal_type);
+void add_detected_signal_at(uint16_t frequency, uint8_t rssi, const char* signal_type,
+                            int rx, uint64_t timestamp_ns);
 void print_detected_signals(void);
 void save_signal_data(void);
 void cleanup_resources(void);
@@ -1,29 +1,93 @@
 #include "fpv_interceptor.h"
+#include "rx5808_backend.h"
+#include "rt_acquisition.h"
+#include "scan_pipeline.h"
+#include "signal_track.h"
+#include "channel_store.h"
+#include "cfar.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <time.h>
 #include <signal.h>
+#include <pthread.h>
 
 // Глобальные переменные
 static int running = 1;
 static int scan_running = 0;
+static int acquisition_started = 0;
+static pthread_t acquisition_thread;
 static int signal_count = 0;
+static int pipeline_found = 0; // Обнаружений на этапе вывода конвейера
+static uint32_t sweep_count = 0;
+static uint64_t last_sweep_ns = 0;
+static uint64_t sweep_start_ns = 0; // Начало текущего обхода (фаза обнаружения)
 #define MAX_SIGNALS 100
-#define SCAN_DWELL_TIME 100
+#define MONITOR_PERIOD_NS 100000000ULL // Период опроса при мониторинге (100 мс)
+#define BAND_HOT_MARGIN 10  // Превышение RSSI над шумом для уточнения канала (%)
+#define BAND_REFINE_SPAN 1   // Радиус уточнения вокруг частоты с сигналом (МГц)
+#define BAND_COVER_SPAN 8    // Наибольшее удаление частоты плана от точки грубого прохода (МГц)
+#define QUIET_DWELL_DEFAULT_MS 20 // Пауза на канале с отсчетом на уровне шума
 
-// Структура канала
+// Режим обхода и статистика последнего обхода по стандартным каналам
+static int scan_mode = SCAN_MODE_FULL;
+static uint32_t band_coarse_channels = 0;
+static uint32_t band_refined_channels = 0;
+static uint8_t band_noise_floor = 0;
+
+// Короткая пауза на тихих каналах (QUIET_DWELL_MS) и ее эффект
+static int quiet_dwell_ms = QUIET_DWELL_DEFAULT_MS;
+static uint32_t quiet_dwells = 0;
+static uint64_t quiet_saved_ms = 0;
+
+// Сопровождение сильнейшего сигнала обхода (TRACK_SIGNALS=1)
+static int track_enabled = 0;
+static uint16_t track_candidate = 0;      // Пишет только этап вывода
+static uint8_t track_candidate_rssi = 0;
+static scan_report_fn observer = NULL;    // Наблюдатель отсчетов (GUI)
+
+// Карта обхода (последний RSSI частоты) в хранилище каналов анализатора
+static uint8_t *channel_level = NULL;
+static int channel_total = 0;
+
+// Срез диапазона приемника при параллельном сканировании
+// Индексы шагов [next, end) относительно начальной частоты обхода
 typedef struct {
-    uint8_t rssi_index;
-    uint8_t rssi_smoothed;
-} channel_info_t;
+    int next;
+    int end;
+} scan_slice_t;
 
-static channel_info_t channels[CHANNELS_COUNT];
+// Поток-обработчик одного приемника
+typedef struct {
+    pthread_t thread;
+    int rx;
+    int dwell_time;
+    uint32_t scanned;      // Просканировано каналов
+    uint32_t stolen;       // Каналов забрано у других приемников
+    uint64_t elapsed_ns;   // Время обхода по часам приемника
+} scan_worker_t;
+
+static scan_slice_t slices[RX5808_MAX_RECEIVERS];
+static scan_worker_t workers[RX5808_MAX_RECEIVERS];
+static int worker_count = 0;
+static const uint16_t *slice_list = NULL; // Частоты обхода
+static int slice_scheduled = 0;           // Частоты выдает планировщик визитов
+static pthread_mutex_t slice_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 // Объявления функций
 static int scan_single_frequency(uint16_t frequency);
 static void print_status(uint16_t freq, uint8_t rssi);
+static int analyze_sample(scan_result_t *sample);
+static void report_sample(const scan_result_t *sample);
+static int scan_sweep(uint16_t start_freq, uint16_t end_freq, int dwell_time);
+static int acquire_frequency(uint16_t frequency, int dwell_time);
+static int scan_parallel_list(const uint16_t *list, int count, int dwell_time);
+static int scan_list(const uint16_t *list, int count, int dwell_time);
+static int scan_bands(const uint16_t *list, int count, int dwell_time);
+static int scan_adaptive(const uint16_t *list, int count, int dwell_time);
+static int continuous_loop(void);
+static int track_update(const scan_result_t *sample);
 
 /**
  * Инициализация частотного сканера
@@ -32,18 +96,62 @@ static void print_status(uint16_t freq, uint8_t rssi);
 int frequency_scanner_init(void) {
     printf("🔍 Инициализация частотного сканера...\n");
     
-    // Инициализация каналов
-    for (int i = 0; i < CHANNELS_COUNT; i++) {
-        channels[i].rssi_index = 0;
-        channels[i].rssi_smoothed = 0;
+    // Карта каналов по охвату плана размещена анализатором RSSI
+    const scan_plan_t *plan = scan_plan_get();
+    channel_store_t *store = channel_store_get();
+    if (store->count != plan->channel_count) {
+        printf("❌ Анализатор RSSI не инициализирован\n");
+        channel_level = NULL;
+        channel_total = 0;
+        return -1;
+    }
+    channel_level = store->level;
+    channel_total = plan->channel_count;
+    scan_plan_print();
+    
+    // Режим обхода: SCAN_MODE=full (все частоты), bands (стандартные каналы)
+    // или adaptive (приоритетные повторные визиты)
+    char mode[16];
+    if (config_get_value("SCAN_MODE", mode, sizeof(mode)) == 0) {
+        if (strcmp(mode, "bands") == 0) {
+            scan_set_mode(SCAN_MODE_BANDS);
+        } else if (strcmp(mode, "adaptive") == 0) {
+            scan_set_mode(SCAN_MODE_ADAPTIVE);
+        } else {
+            scan_set_mode(SCAN_MODE_FULL);
+        }
+    }
+    scan_scheduler_reset();
+    intercept_reset();
+    
+    // Пауза на канале, отсчет которого явно на уровне шума
+    char quiet[16];
+    if (config_get_value("QUIET_DWELL_MS", quiet, sizeof(quiet)) == 0 && atoi(quiet) >= 0) {
+        quiet_dwell_ms = atoi(quiet);
+    }
+    
+    // После обнаружения приемник остается на сигнале до его потери
+    char track[8];
+    if (config_get_value("TRACK_SIGNALS", track, sizeof(track)) == 0) {
+        scan_set_tracking(atoi(track));
     }
     
+    // Анализ и вывод идут в отдельных потоках, пока приемник перестраивается.
+    // В виртуальном времени симулятора анализ времени не занимает, и этапы
+    // выполняются в потоке приемника: результат остается детерминированным
+    scan_pipeline_start(analyze_sample, report_sample, rx5808_get_backend()->now_ns == NULL);
+    
     // Инициализация счетчиков
     signal_count = 0;
-    for (int i = 0; i < MAX_SIGNALS; i++) {
+    pipeline_found = 0;
+    sweep_count = 0;
+    quiet_dwells = 0;
+    quiet_saved_ms = 0;
+    // Сигналы, восстановленные из файла состояния, остаются в журнале
+    for (int i = detected_count; i < MAX_SIGNALS; i++) {
         detected_signals[i].frequency = 0;
         detected_signals[i].rssi = 0;
-        detected_signals[i].timestamp = 0;
+        detected_signals[i].timestamp_ns = 0;
         detected_signals[i].motion_detected = 0;
         detected_signals[i].video_quality = 0;
     }
@@ -56,38 +164,102 @@ int frequency_scanner_init(void) {
  * Сканирование диапазона частот
  * @param start_freq Начальная частота
  * @param end_freq Конечная частота
- * @param dwell_time Время задержки на частоте (мс)
+ * @param dwell_time Время задержки на частоте (мс) или SCAN_DWELL_PLAN
  * @return 0 при успехе, -1 при ошибке
  */
 int scan_frequency_range(uint16_t start_freq, uint16_t end_freq, int dwell_time) {
-    if (start_freq < FREQ_MIN || end_freq > FREQ_MAX) {
-        printf("❌ Неверный диапазон частот\n");
+    const scan_plan_t *plan = scan_plan_get();
+    
+    if (start_freq < plan->freq_min || end_freq > plan->freq_max || start_freq > end_freq) {
+        printf("❌ Неверный диапазон частот (план: %d-%d МГц)\n", plan->freq_min, plan->freq_max);
         return -1;
     }
     
     printf("🔍 Сканирование диапазона %d-%d МГц...\n", start_freq, end_freq);
     
-    for (uint16_t freq = start_freq; freq <= end_freq && running; freq += FREQ_STEP) {
-        if (scan_single_frequency(freq) == 0) {
-            uint8_t rssi = analyze_rssi(freq);
-            int channel = freq - FREQ_MIN;
-            
-            if (channel >= 0 && channel < CHANNELS_COUNT) {
-                channels[channel].rssi_smoothed = rssi;
-            }
-            
-            if (rssi > RSSI_THRESHOLD) {
-                printf("🎯 Сигнал обнаружен: %d МГц, RSSI: %d%%\n", freq, rssi);
-                add_detected_signal(freq, rssi, "FPV");
-            }
-            
-            print_status(freq, rssi);
-        }
-        
-        usleep(dwell_time * 1000);
+    scan_sweep(start_freq, end_freq, dwell_time);
+    return 0;
+}
+
+/**
+ * Проверка продолжения обхода
+ * Поток непрерывного сканирования останавливается сбросом scan_running
+ */
+static int sweep_active(void) {
+    return running && (scan_running || !acquisition_started);
+}
+
+/**
+ * Количество обнаружений с отметки mark
+ * Дожидается вывода всех переданных в конвейер отсчетов
+ */
+static int found_since(int mark) {
+    scan_pipeline_flush();
+    return __atomic_load_n(&pipeline_found, __ATOMIC_ACQUIRE) - mark;
+}
+
+/**
+ * Один обход частот плана в пределах [start_freq, end_freq] в текущем режиме
+ * @return Количество обнаруженных сигналов
+ */
+static int scan_sweep(uint16_t start_freq, uint16_t end_freq, int dwell_time) {
+    const scan_plan_t *plan = scan_plan_get();
+    uint16_t *list = malloc((plan->frequency_count > 0 ? plan->frequency_count : 1) * sizeof(*list));
+    int found = 0;
+    
+    if (!list) {
+        printf("❌ Недостаточно памяти для списка частот\n");
+        return 0;
     }
     
-    return 0;
+    int count = scan_plan_frequencies(start_freq, end_freq, list, plan->frequency_count);
+    track_candidate = 0;
+    track_candidate_rssi = 0;
+    sweep_start_ns = rx5808_now_ns();
+    
+    if (scan_mode == SCAN_MODE_BANDS) {
+        found = scan_bands(list, count, dwell_time);
+    } else if (scan_mode == SCAN_MODE_ADAPTIVE) {
+        found = scan_adaptive(list, count, dwell_time);
+    } else {
+        // Несколько приемников делят список между собой
+        found = scan_list(list, count, dwell_time);
+    }
+    
+    free(list);
+    intercept_sweep_done(sweep_count, rx5808_now_ns() - sweep_start_ns);
+    sweep_count++;
+    
+    // Пороги CFAR по карте обхода действуют в следующем обходе
+    cfar_update(sweep_start_ns);
+    
+    // Изученное состояние раз в STATE_SYNC_MS сбрасывается на носитель
+    scan_state_sync(0);
+    
+    // Режимы обхода дожидаются вывода всех отсчетов, поэтому кандидат
+    // этапа вывода уже записан
+    if (track_enabled && track_candidate && sweep_active()) {
+        track_signal(track_candidate, track_update, NULL);
+    }
+    return found;
+}
+
+/**
+ * Обновление сопровождения: карта каналов и строка статуса
+ * @return 1 - продолжить сопровождение, 0 - сканирование остановлено
+ */
+static int track_update(const scan_result_t *sample) {
+    channel_level[scan_plan_channel(sample->frequency)] = sample->rssi;
+    print_status(sample->frequency, sample->rssi);
+    
+    scan_report_fn notify = __atomic_load_n(&observer, __ATOMIC_ACQUIRE);
+    if (notify) {
+        // Сопровождение продолжает обход, в котором сигнал обнаружен
+        scan_result_t result = *sample;
+        result.cycle = sweep_count > 0 ? sweep_count - 1 : 0;
+        notify(&result);
+    }
+    return sweep_active();
 }
 
 /**
@@ -96,23 +268,125 @@ int scan_frequency_range(uint16_t start_freq, uint16_t end_freq, int dwell_time)
  * @return 0 при успехе, -1 при ошибке
  */
 static int scan_single_frequency(uint16_t frequency) {
-    if (frequency < FREQ_MIN || frequency > FREQ_MAX) {
+    if (scan_plan_channel(frequency) < 0) {
         printf("❌ Частота %d МГц вне диапазона\n", frequency);
         return -1;
     }
     
-    // Установка частоты на RX5808
+    // Установка частоты на RX5808 (драйвер сам дожидается стабилизации PLL)
     if (rx5808_set_frequency(frequency) != 0) {
         printf("❌ Ошибка установки частоты %d МГц\n", frequency);
         return -1;
     }
     
-    // Ожидание стабилизации
-    usleep(50000); // 50 мс
-    
     return 0;
 }
 
+/**
+ * Этап приемника: перестройка, чтение RSSI и пауза на частоте
+ * Отсчет уходит в конвейер, и приемник сразу переходит к следующей
+ * частоте: анализ и вывод не задерживают перестройку. Если отсчет явно
+ * на уровне изученного шума канала, пауза сокращается до QUIET_DWELL_MS
+ * @param dwell_time Пауза (мс) или SCAN_DWELL_PLAN - пауза диапазона плана
+ * @return 0 при успехе, -1 при ошибке
+ */
+static int acquire_frequency(uint16_t frequency, int dwell_time) {
+    int result = scan_single_frequency(frequency);
+    int quiet = 0;
+    
+    if (dwell_time == SCAN_DWELL_PLAN) {
+        dwell_time = scan_plan_dwell(frequency);
+    }
+    
+    if (result == 0) {
+        scan_result_t sample;
+        sample.frequency = frequency;
+        sample.rssi = rx5808_read_rssi();
+        quiet = noise_floor_quiet(frequency, sample.rssi);
+        sample.detected = 0;
+        sample.receiver = (uint8_t)rx5808_current_receiver();
+        sample.tracking = 0;
+        sample.cycle = sweep_count;
+        sample.timestamp_ns = rx5808_now_ns();
+        scan_pipeline_submit(&sample);
+    }
+    
+    if (quiet && dwell_time > quiet_dwell_ms) {
+        __atomic_fetch_add(&quiet_dwells, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&quiet_saved_ms, (uint64_t)(dwell_time - quiet_dwell_ms), __ATOMIC_RELAXED);
+        dwell_time = quiet_dwell_ms;
+    }
+    rx5808_delay_us(dwell_time * 1000);
+    return result;
+}
+
+/**
+ * Этап анализа: карта шума, сглаживание, карта каналов и планировщик визитов
+ * @param sample Отсчет; rssi заменяется сглаженным значением
+ * @return 1 - отсчет передается на вывод
+ */
+static int analyze_sample(scan_result_t *sample) {
+    uint16_t freq = sample->frequency;
+    noise_floor_update(freq, sample->rssi, sample->timestamp_ns);
+    uint8_t rssi = analyze_rssi_sample(freq, sample->rssi, sample->timestamp_ns);
+    
+    // Порог относительно шума канала
+    uint8_t threshold = noise_floor_threshold(freq);
+    
+    channel_level[scan_plan_channel(freq)] = rssi;
+    uint64_t since_visit = 0;
+    int fresh = scan_scheduler_update(freq, rssi, sample->timestamp_ns, &since_visit);
+    
+    // Задержка обнаружения: передатчик включился не раньше прошлого визита
+    if (rssi > threshold && fresh) {
+        uint64_t offset = sample->timestamp_ns > sweep_start_ns ? sample->timestamp_ns - sweep_start_ns : 0;
+        intercept_record(freq, sample->timestamp_ns, since_visit, sample->cycle, offset);
+    }
+    
+    // При повторных визитах в список попадает только новое обнаружение
+    sample->rssi = rssi;
+    sample->detected = rssi > threshold && (scan_mode != SCAN_MODE_ADAPTIVE || fresh);
+    if (rssi > threshold && !sample->detected) {
+        rx5808_note_detection_at(sample->receiver, freq, sample->timestamp_ns);
+    }
+    
+    return 1;
+}
+
+/**
+ * Этап вывода: журнал обнаружений и строка статуса
+ */
+static void report_sample(const scan_result_t *sample) {
+    if (sample->detected) {
+        if (rx5808_get_receiver_count() > 1) {
+            printf("🎯 Сигнал обнаружен: %d МГц, RSSI: %d%% (приемник #%d)\n",
+                   sample->frequency, sample->rssi, sample->receiver);
+        } else {
+            printf("🎯 Сигнал обнаружен: %d МГц, RSSI: %d%%\n", sample->frequency, sample->rssi);
+        }
+        add_detected_signal_at(sample->frequency, sample->rssi, "FPV",
+                               sample->receiver, sample->timestamp_ns);
+        if (sample->rssi > track_candidate_rssi) {
+            track_candidate = sample->frequency;
+            track_candidate_rssi = sample->rssi;
+        }
+        __atomic_fetch_add(&pipeline_found, 1, __ATOMIC_RELEASE);
+    }
+    
+    print_status(sample->frequency, sample->rssi);
+    
+    scan_report_fn notify = __atomic_load_n(&observer, __ATOMIC_ACQUIRE);
+    if (notify) notify(sample);
+}
+
+/**
+ * Наблюдатель отсчетов сканера (NULL - отключить)
+ * Обнаружения уже записаны в журнал этапом вывода
+ */
+void scan_set_observer(scan_report_fn fn) {
+    __atomic_store_n(&observer, fn, __ATOMIC_RELEASE);
+}
+
 /**
  * Непрерывное сканирование
  * @return 0 при успехе, -1 при ошибке
@@ -121,32 +395,64 @@ int scan_continuous(void) {
     printf("🔄 Непрерывное сканирование...\n");
     scan_running = 1;
     
+    return continuous_loop();
+}
+
+/**
+ * Цикл непрерывного сканирования (до сброса scan_running)
+ */
+static int continuous_loop(void) {
     while (running && scan_running) {
-        for (uint16_t freq = FREQ_MIN; freq <= FREQ_MAX && running; freq += FREQ_STEP) {
-            if (scan_single_frequency(freq) == 0) {
-                uint8_t rssi = analyze_rssi(freq);
-                int channel = freq - FREQ_MIN;
-                
-                if (channel >= 0 && channel < CHANNELS_COUNT) {
-                    channels[channel].rssi_smoothed = rssi;
-                }
-                
-                if (rssi > RSSI_THRESHOLD) {
-                    printf("🎯 Сигнал обнаружен: %d МГц, RSSI: %d%%\n", freq, rssi);
-                    add_detected_signal(freq, rssi, "FPV");
-                }
-                
-                print_status(freq, rssi);
-            }
-            
-            usleep(SCAN_DWELL_TIME * 1000);
-        }
+        scan_sweep(0, UINT16_MAX, SCAN_DWELL_PLAN);
     }
     
     scan_running = 0;
     return 0;
 }
 
+/**
+ * Поток непрерывного сканирования
+ */
+static void* acquisition_thread_main(void *arg) {
+    (void)arg;
+    continuous_loop();
+    return NULL;
+}
+
+/**
+ * Запуск непрерывного сканирования в отдельном потоке опроса
+ * При RT_ACQUISITION=1 поток работает с SCHED_FIFO на ядре RT_CPU
+ * @return 0 при успехе, -1 при ошибке
+ */
+int scan_continuous_start(void) {
+    if (acquisition_started) {
+        printf("⚠️ Сканирование уже запущено\n");
+        return 0;
+    }
+    
+    printf("🔄 Непрерывное сканирование в потоке опроса...\n");
+    scan_running = 1;
+    if (rt_thread_create(&acquisition_thread, acquisition_thread_main, NULL, 0) != 0) {
+        printf("❌ Ошибка запуска потока сканирования\n");
+        scan_running = 0;
+        return -1;
+    }
+    
+    acquisition_started = 1;
+    return 0;
+}
+
+/**
+ * Остановка потока непрерывного сканирования
+ */
+void scan_continuous_stop(void) {
+    if (!acquisition_started) return;
+    
+    scan_running = 0;
+    pthread_join(acquisition_thread, NULL);
+    acquisition_started = 0;
+}
+
 /**
  * Мониторинг конкретной частоты
  * @param frequency Частота для мониторинга
@@ -154,26 +460,24 @@ int scan_continuous(void) {
  * @return 0 при успехе, -1 при ошибке
  */
 int monitor_frequency(uint16_t frequency, int timeout_ms) {
-    if (frequency < FREQ_MIN || frequency > FREQ_MAX) {
+    int channel = scan_plan_channel(frequency);
+    if (channel < 0) {
         printf("❌ Частота %d МГц вне диапазона\n", frequency);
         return -1;
     }
     
     printf("👁️ Мониторинг частоты %d МГц...\n", frequency);
     
-    uint32_t start_time = get_timestamp();
-    uint32_t timeout = timeout_ms;
+    uint64_t start_time = rx5808_now_ns();
+    uint64_t timeout = (uint64_t)timeout_ms * 1000000ULL;
+    uint64_t next_poll = start_time;
     
     while (running) {
         if (scan_single_frequency(frequency) == 0) {
             uint8_t rssi = analyze_rssi(frequency);
-            int channel = frequency - FREQ_MIN;
-            
-            if (channel >= 0 && channel < CHANNELS_COUNT) {
-                channels[channel].rssi_smoothed = rssi;
-            }
+            channel_level[channel] = rssi;
             
-            if (rssi > RSSI_THRESHOLD) {
+            if (rssi > noise_floor_threshold(frequency)) {
                 printf("🎯 Сигнал обнаружен: %d МГц, RSSI: %d%%\n", frequency, rssi);
                 add_detected_signal(frequency, rssi, "FPV");
                 return 0;
@@ -183,12 +487,14 @@ int monitor_frequency(uint16_t frequency, int timeout_ms) {
         }
         
         // Проверка таймаута
-        if (timeout > 0 && (get_timestamp() - start_time) > timeout) {
+        if (timeout > 0 && (rx5808_now_ns() - start_time) > timeout) {
             printf("⏰ Таймаут мониторинга\n");
             break;
         }
         
-        usleep(100000); // 100 мс
+        // Опрос строго каждые 100 мс: ряд RSSI равномерен по времени
+        next_poll += MONITOR_PERIOD_NS;
+        rx5808_sleep_until_ns(next_poll);
     }
     
     return -1;
@@ -201,25 +507,458 @@ int monitor_frequency(uint16_t frequency, int timeout_ms) {
 int auto_scan_for_signals(void) {
     printf("🤖 Автоматический поиск сигналов...\n");
     
-    int found_signals = 0;
     signal_count = 0;
+    int found_signals = scan_sweep(0, UINT16_MAX, SCAN_DWELL_PLAN);
     
-    for (uint16_t freq = FREQ_MIN; freq <= FREQ_MAX && running; freq += FREQ_STEP) {
-        if (scan_single_frequency(freq) == 0) {
-            uint8_t rssi = analyze_rssi(freq);
+    printf("✅ Найдено сигналов: %d\n", found_signals);
+    return found_signals;
+}
+
+/**
+ * Получение следующей частоты для приемника
+ * Когда собственный срез исчерпан, приемник забирает половину
+ * оставшейся части самого длинного чужого среза (work stealing)
+ * @param rx Номер приемника
+ * @param frequency Выходная частота
+ * @param stolen Устанавливается в 1 если частота получена из чужого среза
+ * @return 1 если частота выдана, 0 если диапазон исчерпан
+ */
+static int take_next_frequency(int rx, uint16_t *frequency, int *stolen) {
+    if (slice_scheduled) {
+        *stolen = 0;
+        return scan_scheduler_next(rx5808_now_ns(), frequency);
+    }
+    
+    pthread_mutex_lock(&slice_mutex);
+    
+    scan_slice_t *own = &slices[rx];
+    *stolen = 0;
+    
+    if (own->next >= own->end) {
+        int victim = -1;
+        int victim_remaining = 0;
+        
+        for (int i = 0; i < worker_count; i++) {
+            int remaining = slices[i].end - slices[i].next;
+            if (i != rx && remaining > victim_remaining) {
+                victim = i;
+                victim_remaining = remaining;
+            }
+        }
+        
+        if (victim < 0) {
+            pthread_mutex_unlock(&slice_mutex);
+            return 0;
+        }
+        
+        // Забираем верхнюю половину (с округлением вверх)
+        int half = (victim_remaining + 1) / 2;
+        own->end = slices[victim].end;
+        own->next = own->end - half;
+        slices[victim].end = own->next;
+        *stolen = 1;
+    }
+    
+    *frequency = slice_list[own->next];
+    own->next++;
+    
+    pthread_mutex_unlock(&slice_mutex);
+    return 1;
+}
+
+/**
+ * Один шаг приемника: получение канала, настройка, чтение и пауза
+ * Вызывается в потоке, привязанном к приемнику worker->rx
+ * @return 1 если канал обработан, 0 если диапазон исчерпан
+ */
+static int scan_worker_step(scan_worker_t *worker) {
+    uint16_t freq;
+    int stolen;
+    
+    if (!running || !take_next_frequency(worker->rx, &freq, &stolen)) {
+        return 0;
+    }
+    
+    if (stolen) {
+        worker->stolen++;
+    }
+    
+    if (acquire_frequency(freq, worker->dwell_time) == 0) {
+        worker->scanned++;
+    }
+    
+    return 1;
+}
+
+/**
+ * Поток сканирования одного приемника
+ */
+static void* scan_worker_thread(void *arg) {
+    scan_worker_t *worker = (scan_worker_t*)arg;
+    
+    rx5808_bind_receiver(worker->rx);
+    uint64_t start = rx5808_now_ns();
+    
+    while (scan_worker_step(worker)) {
+    }
+    
+    worker->elapsed_ns = rx5808_now_ns() - start;
+    return NULL;
+}
+
+/**
+ * Пошаговое сканирование для бэкенда с виртуальным временем
+ * Потоки симулятора не тратят реального времени, поэтому порядок шагов
+ * задается явно: следующим ходит приемник с наименьшим временем по своим
+ * часам. Результат детерминирован и совпадает с работой реальных потоков.
+ */
+static void scan_virtual_time(int receivers) {
+    uint64_t start[RX5808_MAX_RECEIVERS];
+    uint64_t clock[RX5808_MAX_RECEIVERS];
+    int done[RX5808_MAX_RECEIVERS] = {0};
+    int active = receivers;
+    
+    for (int rx = 0; rx < receivers; rx++) {
+        rx5808_bind_receiver(rx);
+        start[rx] = clock[rx] = rx5808_now_ns();
+    }
+    
+    while (active > 0) {
+        int rx = -1;
+        for (int i = 0; i < receivers; i++) {
+            if (!done[i] && (rx < 0 || clock[i] < clock[rx])) {
+                rx = i;
+            }
+        }
+        
+        rx5808_bind_receiver(rx);
+        if (!scan_worker_step(&workers[rx])) {
+            done[rx] = 1;
+            active--;
+        }
+        clock[rx] = rx5808_now_ns();
+        workers[rx].elapsed_ns = clock[rx] - start[rx];
+    }
+}
+
+/**
+ * Параллельное сканирование диапазона несколькими приемниками
+ * Диапазон делится на равные срезы, каждый приемник обходит свой
+ * срез в отдельном потоке и помогает остальным, закончив раньше.
+ * @param total Количество частот в обходе
+ * @return Количество обнаруженных сигналов
+ */
+static int scan_parallel_run(int total, int dwell_time) {
+    int receivers = rx5808_get_receiver_count();
+    int mark = __atomic_load_n(&pipeline_found, __ATOMIC_ACQUIRE);
+    
+    worker_count = receivers;
+    
+    for (int rx = 0; rx < receivers; rx++) {
+        slices[rx].next = total * rx / receivers;
+        slices[rx].end = total * (rx + 1) / receivers;
+        
+        memset(&workers[rx], 0, sizeof(workers[rx]));
+        workers[rx].rx = rx;
+        workers[rx].dwell_time = dwell_time;
+    }
+    
+    if (rx5808_get_backend()->now_ns) {
+        scan_virtual_time(receivers);
+    } else {
+        int started = 0;
+        for (int rx = 0; rx < receivers; rx++) {
+            if (rt_thread_create(&workers[rx].thread, scan_worker_thread, &workers[rx], rx) != 0) {
+                printf("❌ Ошибка запуска потока приемника #%d\n", rx);
+                break;
+            }
+            started++;
+        }
+        
+        for (int rx = 0; rx < started; rx++) {
+            pthread_join(workers[rx].thread, NULL);
+        }
+        
+        // Срезы незапущенных потоков забирают остальные приемники;
+        // если не запустился ни один, сканирует текущий поток
+        if (started == 0) {
+            scan_worker_thread(&workers[0]);
+        }
+    }
+    rx5808_bind_receiver(0);
+    
+    int found = found_since(mark);
+    uint64_t longest = 0;
+    for (int rx = 0; rx < receivers; rx++) {
+        if (workers[rx].elapsed_ns > longest) {
+            longest = workers[rx].elapsed_ns;
+        }
+    }
+    
+    last_sweep_ns = longest;
+    return found;
+}
+
+/**
+ * Параллельное сканирование произвольного списка частот
+ * @param list Частоты в порядке обхода
+ * @param count Количество частот
+ * @return Количество обнаруженных сигналов
+ */
+static int scan_parallel_list(const uint16_t *list, int count, int dwell_time) {
+    slice_list = list;
+    int found = scan_parallel_run(count, dwell_time);
+    slice_list = NULL;
+    return found;
+}
+
+/**
+ * Последовательное сканирование списка частот одним приемником
+ * RSSI каждой частоты сохраняется в карте каналов channel_level
+ * (к возврату все отсчеты списка проанализированы)
+ * @return Количество обнаруженных сигналов
+ */
+static int scan_list(const uint16_t *list, int count, int dwell_time) {
+    if (rx5808_get_receiver_count() > 1) {
+        return scan_parallel_list(list, count, dwell_time);
+    }
+    
+    int mark = __atomic_load_n(&pipeline_found, __ATOMIC_ACQUIRE);
+    uint64_t start = rx5808_now_ns();
+    
+    for (int i = 0; i < count && sweep_active(); i++) {
+        acquire_frequency(list[i], dwell_time);
+    }
+    
+    // Карта каналов нужна вызывающему обходу, поэтому ждем конца анализа
+    int found = found_since(mark);
+    last_sweep_ns = rx5808_now_ns() - start;
+    return found;
+}
+
+static int compare_u8(const void *a, const void *b) {
+    return *(const uint8_t*)a - *(const uint8_t*)b;
+}
+
+static int compare_u16(const void *a, const void *b) {
+    return *(const uint16_t*)a - *(const uint16_t*)b;
+}
+
+/**
+ * Дополнение грубого прохода точками плана в промежутках между стандартными
+ * каналами (например 5885-5905 и 5945-6000 МГц), чтобы каждая частота плана
+ * была не дальше BAND_COVER_SPAN от точки грубого прохода - меньше
+ * полуполосы видеосигнала
+ * @param plan_list Частоты полного обхода (по возрастанию)
+ * @param list Точки грубого прохода (дополняются, по возрастанию на выходе)
+ * @param count Количество точек
+ * @param covered Рабочий массив по охвату плана (нули, портится)
+ * @return Количество точек после дополнения
+ */
+static int cover_plan_gaps(const uint16_t *plan_list, int plan_count,
+                           uint16_t *list, int count, uint8_t *covered) {
+    int coarse = count;
+    
+    for (int i = 0; i < coarse; i++) {
+        for (int d = -BAND_COVER_SPAN; d <= BAND_COVER_SPAN; d++) {
+            int channel = scan_plan_channel((uint16_t)(list[i] + d));
+            if (channel >= 0) covered[channel] = 1;
+        }
+    }
+    
+    // Непокрытые участки плана: точки равномерно по участку, каждая
+    // покрывает до 2 * BAND_COVER_SPAN + 1 МГц
+    int i = 0;
+    while (i < plan_count) {
+        if (covered[scan_plan_channel(plan_list[i])] || !scan_plan_allows(plan_list[i])) {
+            i++;
+            continue;
+        }
+        
+        int end = i;
+        while (end + 1 < plan_count && !covered[scan_plan_channel(plan_list[end + 1])] &&
+               scan_plan_allows(plan_list[end + 1])) {
+            end++;
+        }
+        
+        int first = plan_list[i];
+        int width = plan_list[end] - first;
+        int points = width / (2 * BAND_COVER_SPAN + 1) + 1;
+        int j = i;
+        for (int k = 0; k < points && count < channel_total; k++) {
+            int target = first + (2 * k + 1) * width / (2 * points);
+            while (j < end && abs(plan_list[j + 1] - target) <= abs(plan_list[j] - target)) j++;
+            list[count++] = plan_list[j];
+        }
+        i = end + 1;
+    }
+    
+    qsort(list, count, sizeof(list[0]), compare_u16);
+    return count;
+}
+
+/**
+ * Обход от грубого к точному по стандартным каналам
+ * Сначала измеряются центры каналов A/B/E/F/R и точки плана в промежутках
+ * между ними (любая частота плана не дальше BAND_COVER_SPAN от измеренной),
+ * уровень шума оценивается медианой их RSSI. Затем вокруг каждой частоты, превысившей шум на
+ * BAND_HOT_MARGIN, с шагом 1 МГц измеряются соседние частоты в радиусе
+ * BAND_REFINE_SPAN; уточнение повторяется, пока сигнал не опустится до
+ * шума. Частоты выше порога обнаружения те же, что и при полном обходе.
+ * Измеряются только частоты диапазонов плана без исключенных; шаг
+ * диапазона при уточнении не учитывается.
+ * @param plan_list Частоты полного обхода (задают пределы)
+ * @return Количество обнаруженных сигналов
+ */
+static int scan_bands(const uint16_t *plan_list, int plan_count, int dwell_time) {
+    if (plan_count == 0) {
+        last_sweep_ns = 0;
+        return 0;
+    }
+    
+    uint16_t start_freq = plan_list[0];
+    uint16_t end_freq = plan_list[plan_count - 1];
+    uint16_t *list = malloc(channel_total * sizeof(*list));
+    uint8_t *measured = calloc(channel_total, sizeof(*measured));
+    uint8_t *levels = malloc(channel_total * sizeof(*levels));
+    uint64_t elapsed = 0;
+    int found = 0;
+    int count = 0;
+    
+    if (!list || !measured || !levels) {
+        printf("❌ Недостаточно памяти для обхода по каналам\n");
+        free(list);
+        free(measured);
+        free(levels);
+        return 0;
+    }
+    
+    // Грубый проход по центрам стандартных каналов
+    int band_count = fpv_band_channels(start_freq, end_freq, list, channel_total);
+    for (int i = 0; i < band_count; i++) {
+        if (scan_plan_allows(list[i])) list[count++] = list[i];
+    }
+    // Промежутки между стандартными каналами (measured пока чист)
+    count = cover_plan_gaps(plan_list, plan_count, list, count, measured);
+    memset(measured, 0, channel_total * sizeof(*measured));
+    if (count == 0) {
+        free(list);
+        free(measured);
+        free(levels);
+        last_sweep_ns = 0;
+        return 0;
+    }
+    
+    found += scan_list(list, count, dwell_time);
+    elapsed += last_sweep_ns;
+    band_coarse_channels = count;
+    band_refined_channels = 0;
+    
+    for (int i = 0; i < count; i++) {
+        int channel = scan_plan_channel(list[i]);
+        measured[channel] = 1;
+        levels[i] = channel_level[channel];
+    }
+    qsort(levels, count, sizeof(levels[0]), compare_u8);
+    band_noise_floor = levels[count / 2];
+    
+    int hot = band_noise_floor + BAND_HOT_MARGIN;
+    
+    // Уточнение по 1 МГц вокруг частот выше шума (или порога диапазона)
+    while (sweep_active()) {
+        count = 0;
+        
+        for (int freq = start_freq; freq <= end_freq; freq++) {
+            if (measured[scan_plan_channel(freq)] || !scan_plan_allows(freq)) continue;
             
-            if (rssi > RSSI_THRESHOLD) {
-                printf("🎯 Сигнал найден: %d МГц, RSSI: %d%%\n", freq, rssi);
-                add_detected_signal(freq, rssi, "FPV");
-                found_signals++;
+            int lo = freq - BAND_REFINE_SPAN < start_freq ? start_freq : freq - BAND_REFINE_SPAN;
+            int hi = freq + BAND_REFINE_SPAN > end_freq ? end_freq : freq + BAND_REFINE_SPAN;
+            for (int near = lo; near <= hi; near++) {
+                int channel = scan_plan_channel(near);
+                uint8_t rssi = channel_level[channel];
+                if (measured[channel] && (rssi > hot || rssi > noise_floor_threshold(near))) {
+                    list[count++] = freq;
+                    break;
+                }
             }
         }
         
-        usleep(SCAN_DWELL_TIME * 1000);
+        if (count == 0) break;
+        
+        found += scan_list(list, count, dwell_time);
+        elapsed += last_sweep_ns;
+        band_refined_channels += count;
+        
+        for (int i = 0; i < count; i++) {
+            measured[scan_plan_channel(list[i])] = 1;
+        }
     }
     
-    printf("✅ Найдено сигналов: %d\n", found_signals);
-    return found_signals;
+    free(list);
+    free(measured);
+    free(levels);
+    last_sweep_ns = elapsed;
+    return found;
+}
+
+/**
+ * Обход с приоритетными повторными визитами
+ * Один вызов - один цикл обзора: каждая частота списка посещается хотя
+ * бы раз, а между обзорными визитами планировщик возвращается к активным
+ * каналам (см. scan_scheduler.c). Длительность цикла ограничена
+ * SCHED_MAX_REVISIT_MS. Планировщик получает результат визита с этапа
+ * анализа конвейера, то есть с запаздыванием не больше одного-двух визитов.
+ * @return Количество новых обнаружений
+ */
+static int scan_adaptive(const uint16_t *list, int count, int dwell_time) {
+    scan_scheduler_begin(list, count);
+    
+    if (rx5808_get_receiver_count() > 1) {
+        slice_scheduled = 1;
+        int found = scan_parallel_run(0, dwell_time);
+        slice_scheduled = 0;
+        return found;
+    }
+    
+    int mark = __atomic_load_n(&pipeline_found, __ATOMIC_ACQUIRE);
+    uint16_t freq;
+    uint64_t start = rx5808_now_ns();
+    
+    while (sweep_active() && scan_scheduler_next(rx5808_now_ns(), &freq)) {
+        acquire_frequency(freq, dwell_time);
+    }
+    
+    int found = found_since(mark);
+    last_sweep_ns = rx5808_now_ns() - start;
+    return found;
+}
+
+/**
+ * Выбор режима обхода диапазона
+ * @param mode SCAN_MODE_FULL, SCAN_MODE_BANDS или SCAN_MODE_ADAPTIVE
+ */
+void scan_set_mode(int mode) {
+    scan_mode = (mode == SCAN_MODE_BANDS || mode == SCAN_MODE_ADAPTIVE) ? mode : SCAN_MODE_FULL;
+}
+
+/**
+ * Текущий режим обхода диапазона
+ */
+int scan_get_mode(void) {
+    return scan_mode;
+}
+
+/**
+ * Включение сопровождения сигнала после обхода
+ * @param enable 1 - приемник остается на сильнейшем обнаруженном сигнале
+ *               до его потери на TRACK_LOST_MS, 0 - обход без остановок
+ */
+void scan_set_tracking(int enable) {
+    track_enabled = enable ? 1 : 0;
+}
+
+int scan_get_tracking(void) {
+    return track_enabled;
 }
 
 /**
@@ -238,9 +977,68 @@ static void print_status(uint16_t freq, uint8_t rssi) {
 void get_scan_stats(void) {
     printf("📊 Статистика сканирования:\n");
     printf("   Обнаружено сигналов: %d\n", signal_count);
-    printf("   Диапазон: %d-%d МГц\n", FREQ_MIN, FREQ_MAX);
-    printf("   Шаг: %d МГц\n", FREQ_STEP);
+    const scan_plan_t *plan = scan_plan_get();
+    printf("   Диапазон: %d-%d МГц, частот в обходе %d (диапазонов %d, исключений %d)\n",
+           plan->freq_min, plan->freq_max, plan->frequency_count,
+           plan->range_count, plan->exclude_count);
+    printf("   Режим: %s\n", scan_mode == SCAN_MODE_BANDS ? "стандартные каналы A/B/E/F/R с уточнением" :
+                             scan_mode == SCAN_MODE_ADAPTIVE ? "приоритетные повторные визиты" :
+                             "полный обход");
+    if (track_enabled) {
+        printf("   Сопровождение: сильнейший сигнал обхода до его потери\n");
+    }
+    if (scan_mode == SCAN_MODE_BANDS && band_coarse_channels > 0) {
+        printf("   Каналов за обход: %u (грубый проход %u, уточнение %u), шум %u%%\n",
+               band_coarse_channels + band_refined_channels, band_coarse_channels,
+               band_refined_channels, band_noise_floor);
+    }
     printf("   Статус: %s\n", scan_running ? "Активно" : "Остановлено");
+    
+    // Время повторного посещения канала (длительность полного обхода)
+    if (last_sweep_ns > 0) {
+        printf("   Время обхода диапазона: %.1f мс\n", last_sweep_ns / 1e6);
+    }
+    for (int rx = 0; rx < worker_count; rx++) {
+        printf("   Приемник #%d: каналов %u, забрано у других %u\n",
+               rx, workers[rx].scanned, workers[rx].stolen);
+    }
+    
+    // Интервалы повторных визитов каналов
+    scan_scheduler_print_stats();
+    
+    // Задержка обнаружения и вероятность перехвата
+    intercept_print_stats();
+    
+    // Шум каналов и сокращенные паузы на тихих каналах
+    noise_floor_print_stats();
+    cfar_print_stats();
+    if (quiet_dwells > 0) {
+        printf("   Коротких пауз на тихих каналах: %u (%d мс), экономия %llu мс\n",
+               quiet_dwells, quiet_dwell_ms, (unsigned long long)quiet_saved_ms);
+    }
+    
+    // Непрерывность и частота обновлений сопровождаемых сигналов
+    track_print_stats();
+    
+    // Конвейер перестройка -> анализ -> вывод
+    scan_pipeline_print_stats();
+    
+    // Эффект адаптивной стабилизации PLL
+    settle_stats_t settle;
+    rx5808_get_settle_stats(&settle);
+    printf("   Перестроек: %u (без сходимости: %u)\n", settle.tunes, settle.timeouts);
+    if (settle.tunes > 0) {
+        printf("   Среднее время стабилизации: %llu мкс\n",
+               (unsigned long long)(settle.settle_us_total / settle.tunes));
+    }
+    printf("   Экономия на стабилизации: %u мс всего", settle.saved_ms_total);
+    if (sweep_count > 0) {
+        printf(", %u мс/цикл (%u циклов)", settle.saved_ms_total / sweep_count, sweep_count);
+    }
+    printf("\n");
+    
+    // Точность пробуждений потоков опроса (только реальное время)
+    rt_print_jitter_stats();
 }
 
 /**
@@ -249,14 +1047,14 @@ void get_scan_stats(void) {
 void frequency_scanner_cleanup(void) {
     printf("🧹 Очистка частотного сканера...\n");
     
+    scan_continuous_stop();
     scan_running = 0;
     running = 0;
+    scan_pipeline_stop();
     
-    // Очистка каналов
-    for (int i = 0; i < CHANNELS_COUNT; i++) {
-        channels[i].rssi_index = 0;
-        channels[i].rssi_smoothed = 0;
-    }
+    // Карта каналов освобождается вместе с анализатором RSSI
+    channel_level = NULL;
+    channel_total = 0;
     
     printf("✅ Частотный сканер очищен\n");
 }
@@ -0,0 +1,196 @@
+#include "fpv_interceptor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/**
+ * Время до обнаружения и вероятность перехвата
+ * Для каждого нового обнаружения записывается время с предыдущего визита
+ * канала (передатчик включился не раньше этого визита, значит задержка
+ * тревоги не больше этого времени) и фаза обхода, на которой оно произошло.
+ * По скользящей оценке интервала визитов R каждого канала (scan_scheduler.c)
+ * вероятность перехватить передатчик, включенный на время T, равна
+ * min(1, T/R); среднее по каналам плана - POI плана, наибольший R -
+ * худшая задержка тревоги. Прогон на симуляторе (make bench-sim) дает
+ * эти показатели для сравнения планов и режимов обхода.
+ */
+
+#define INTERCEPT_MAX_RECORDS 256 // Последних обнаружений в журнале
+
+// Длительности включения передатчика для оценки POI (мс)
+static const uint32_t poi_durations_ms[INTERCEPT_POI_DURATIONS] = { 1000, 5000, 30000 };
+
+static intercept_record_t records[INTERCEPT_MAX_RECORDS];
+static int record_head = 0;  // Следующая запись
+static int record_count = 0;
+static intercept_stats_t totals;
+static uint64_t last_sweep_ns = 0; // Длительность последнего обхода
+static pthread_mutex_t intercept_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Сброс журнала и статистики обнаружений
+ */
+void intercept_reset(void) {
+    pthread_mutex_lock(&intercept_mutex);
+    memset(records, 0, sizeof(records));
+    memset(&totals, 0, sizeof(totals));
+    record_head = 0;
+    record_count = 0;
+    last_sweep_ns = 0;
+    pthread_mutex_unlock(&intercept_mutex);
+}
+
+/**
+ * Запись нового обнаружения
+ * @param frequency Частота
+ * @param timestamp_ns Время обнаружения по часам приемника
+ * @param since_visit_ns Время с предыдущего визита канала (0 - первый визит)
+ * @param cycle Номер обхода
+ * @param sweep_offset_ns Время от начала обхода
+ */
+void intercept_record(uint16_t frequency, uint64_t timestamp_ns, uint64_t since_visit_ns,
+                      uint32_t cycle, uint64_t sweep_offset_ns) {
+    pthread_mutex_lock(&intercept_mutex);
+    intercept_record_t *r = &records[record_head];
+    r->frequency = frequency;
+    r->phase = INTERCEPT_PHASE_UNKNOWN;
+    r->cycle = cycle;
+    r->timestamp_ns = timestamp_ns;
+    r->since_visit_ns = since_visit_ns;
+    r->sweep_offset_ns = sweep_offset_ns;
+    record_head = (record_head + 1) % INTERCEPT_MAX_RECORDS;
+    if (record_count < INTERCEPT_MAX_RECORDS) record_count++;
+
+    totals.detections++;
+    if (since_visit_ns == 0) {
+        totals.first_visit++;
+    } else {
+        totals.since_visit_total_ns += since_visit_ns;
+        if (since_visit_ns > totals.since_visit_max_ns) totals.since_visit_max_ns = since_visit_ns;
+    }
+    pthread_mutex_unlock(&intercept_mutex);
+}
+
+/**
+ * Завершение обхода: фаза обнаружений этого обхода
+ * @param cycle Номер завершенного обхода
+ * @param duration_ns Длительность обхода
+ */
+void intercept_sweep_done(uint32_t cycle, uint64_t duration_ns) {
+    pthread_mutex_lock(&intercept_mutex);
+    if (duration_ns > 0) last_sweep_ns = duration_ns;
+
+    // Обнаружения обхода - последние записи журнала
+    for (int i = 1; i <= record_count; i++) {
+        intercept_record_t *r = &records[(record_head - i + INTERCEPT_MAX_RECORDS) % INTERCEPT_MAX_RECORDS];
+        if (r->cycle != cycle) break;
+        if (r->phase != INTERCEPT_PHASE_UNKNOWN) continue;
+
+        uint64_t offset = r->sweep_offset_ns < duration_ns ? r->sweep_offset_ns : duration_ns;
+        r->phase = (uint8_t)(duration_ns ? offset * 100 / duration_ns : 0);
+        totals.phase[r->phase * INTERCEPT_PHASE_BUCKETS / 101]++;
+    }
+    pthread_mutex_unlock(&intercept_mutex);
+}
+
+/**
+ * Последние записи журнала обнаружений (от старых к новым)
+ * @param out Массив записей
+ * @param max Размер массива
+ * @return Количество записей
+ */
+int get_intercept_records(intercept_record_t *out, int max) {
+    if (!out || max <= 0) return 0;
+
+    pthread_mutex_lock(&intercept_mutex);
+    int count = record_count < max ? record_count : max;
+    for (int i = 0; i < count; i++) {
+        out[i] = records[(record_head - count + i + INTERCEPT_MAX_RECORDS) % INTERCEPT_MAX_RECORDS];
+    }
+    pthread_mutex_unlock(&intercept_mutex);
+    return count;
+}
+
+/**
+ * Статистика обнаружений и оценка вероятности перехвата
+ * Каналы, посещенные один раз, оцениваются по длительности последнего обхода
+ * @param out Указатель на структуру статистики
+ */
+void get_intercept_stats(intercept_stats_t *out) {
+    if (!out) return;
+
+    pthread_mutex_lock(&intercept_mutex);
+    *out = totals;
+    uint64_t sweep_ns = last_sweep_ns;
+    pthread_mutex_unlock(&intercept_mutex);
+
+    const scan_plan_t *plan = scan_plan_get();
+    uint16_t *list = malloc((plan->frequency_count > 0 ? plan->frequency_count : 1) * sizeof(*list));
+    if (!list) return;
+    int count = scan_plan_frequencies(plan->freq_min, plan->freq_max, list, plan->frequency_count);
+
+    uint64_t revisit_sum = 0;
+    uint64_t poi_sum[INTERCEPT_POI_DURATIONS] = {0};
+
+    for (int i = 0; i < count; i++) {
+        revisit_stats_t stats;
+        get_revisit_stats(list[i], &stats);
+
+        uint64_t revisit = stats.revisit_ewma_ns;
+        if (stats.visits < 2) revisit = stats.visits > 0 ? sweep_ns : 0;
+        if (revisit == 0) {
+            out->unvisited++;
+            continue;
+        }
+
+        out->channels++;
+        revisit_sum += revisit;
+        if (revisit > out->revisit_max_ns) out->revisit_max_ns = revisit;
+        for (int d = 0; d < INTERCEPT_POI_DURATIONS; d++) {
+            uint64_t on_ns = (uint64_t)poi_durations_ms[d] * 1000000ULL;
+            poi_sum[d] += on_ns >= revisit ? 1000 : on_ns * 1000 / revisit;
+        }
+    }
+    free(list);
+
+    for (int d = 0; d < INTERCEPT_POI_DURATIONS; d++) {
+        out->poi_ms[d] = poi_durations_ms[d];
+        // Частоты плана без визитов передатчик на них не перехватят
+        int total = out->channels + out->unvisited;
+        out->poi[d] = (uint8_t)(total > 0 ? (poi_sum[d] / total + 5) / 10 : 0);
+    }
+    if (out->channels > 0) out->revisit_mean_ns = revisit_sum / out->channels;
+}
+
+/**
+ * Печать задержки обнаружения и вероятности перехвата
+ */
+void intercept_print_stats(void) {
+    intercept_stats_t s;
+    get_intercept_stats(&s);
+
+    if (s.channels == 0) return;
+
+    printf("   Вероятность перехвата: ");
+    for (int d = 0; d < INTERCEPT_POI_DURATIONS; d++) {
+        printf("%s%u с - %u%%", d ? ", " : "", s.poi_ms[d] / 1000, s.poi[d]);
+    }
+    printf(" (каналов %d, без визитов %d)\n", s.channels, s.unvisited);
+    printf("   Интервал визитов: ср. %.1f мс, худшая задержка тревоги %.1f мс\n",
+           s.revisit_mean_ns / 1e6, s.revisit_max_ns / 1e6);
+
+    if (s.detections == 0) return;
+
+    printf("   Новых обнаружений: %u (при первом визите %u)", s.detections, s.first_visit);
+    uint32_t revisited = s.detections - s.first_visit;
+    if (revisited > 0) {
+        printf(", с прошлого визита ср. %.1f мс, наиб. %.1f мс",
+               s.since_visit_total_ns / revisited / 1e6, s.since_visit_max_ns / 1e6);
+    }
+    printf("\n   Фаза обхода при обнаружении (четверти):");
+    for (int b = 0; b < INTERCEPT_PHASE_BUCKETS; b++) {
+        printf(" %u", s.phase[b]);
+    }
+    printf("\n");
+}
@@ -0,0 +1,302 @@
+#include "fpv_interceptor.h"
+#include "cfar.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/**
+ * Карта уровня шума каналов
+ * Для каждой частоты плана ведется экспоненциальное среднее тихих отсчетов
+ * (шум) и их среднее отклонение (разброс). Отсчет считается тихим, если он
+ * не выше шума больше чем на NOISE_QUIET_MARGIN или три разброса. Порог
+ * обнаружения отсчитывается от шума канала: порог плана задан для эталонного
+ * шума NOISE_REFERENCE (15%), и на канале с шумом 25% он на 10% выше.
+ * Канал, непрерывно превышающий шум дольше NOISE_ABSORB_MS, считается
+ * постоянной помехой: его уровень становится шумом, и ложные обнаружения
+ * на нем прекращаются. С DETECTOR=ca или os порог канала задает CFAR по
+ * соседним каналам спектра (cfar.c), а карта шума - только пока у канала
+ * нет оценки CFAR.
+ */
+
+#define NOISE_DEFAULT_REFERENCE 15     // Эталонный шум порогов плана (%)
+#define NOISE_DEFAULT_ABSORB_MS 300000 // Постоянная помеха через 5 минут
+#define NOISE_QUIET_MARGIN      5      // Наименьшая полоса тихих отсчетов (%)
+#define NOISE_LEARN_SAMPLES     2      // Отсчетов до использования шума канала
+#define NOISE_MIN_MARGIN        10     // Наименьшее превышение порога над шумом (%)
+#define NOISE_SHIFT             3      // Вес нового тихого отсчета 1/8
+
+// Состояние канала (уровни в 1/256 %)
+typedef struct {
+    uint32_t floor_q8;      // Уровень шума
+    uint32_t spread_q8;     // Средний разброс тихих отсчетов
+    uint32_t samples;       // Отсчетов
+    uint32_t quiet;         // Тихих отсчетов
+    uint64_t hot_since_ns;  // Начало непрерывного превышения (0 - канал тихий)
+    uint8_t absorbed;       // Уровень постоянной помехи был принят за шум
+} noise_channel_t;
+
+static noise_channel_t *noise = NULL;
+static int noise_count = 0;
+static int noise_mapped = 0; // Карта в разделе состояния (STATE_FILE)
+static pthread_mutex_t noise_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int config_loaded = 0;
+static int reference = NOISE_DEFAULT_REFERENCE;
+static uint64_t absorb_ns = NOISE_DEFAULT_ABSORB_MS * 1000000ULL;
+
+/**
+ * Состояние канала частоты (NULL если частота вне плана)
+ */
+static noise_channel_t* channel_state(uint16_t frequency) {
+    int channel = scan_plan_channel(frequency);
+    return channel >= 0 && channel < noise_count ? &noise[channel] : NULL;
+}
+
+/**
+ * Чтение NOISE_REFERENCE и NOISE_ABSORB_MS из конфигурации
+ */
+static void load_config(void) {
+    char value[16];
+
+    if (config_loaded) return;
+    config_loaded = 1;
+
+    if (config_get_value("NOISE_REFERENCE", value, sizeof(value)) == 0 &&
+        atoi(value) >= 0 && atoi(value) < 100) {
+        reference = atoi(value);
+    }
+    if (config_get_value("NOISE_ABSORB_MS", value, sizeof(value)) == 0 && atoi(value) >= 0) {
+        absorb_ns = (uint64_t)atoi(value) * 1000000ULL;
+    }
+}
+
+/**
+ * Шум канала в процентах
+ */
+static uint8_t floor_level(const noise_channel_t *ch) {
+    return (uint8_t)((ch->floor_q8 + 128) >> 8);
+}
+
+/**
+ * Верхняя граница тихих отсчетов канала
+ */
+static int quiet_limit(const noise_channel_t *ch) {
+    int band = (int)((ch->spread_q8 * 3 + 128) >> 8);
+    return floor_level(ch) + (band > NOISE_QUIET_MARGIN ? band : NOISE_QUIET_MARGIN);
+}
+
+/**
+ * Размер карты шума в файле состояния
+ * @param channels Охват плана сканирования
+ */
+size_t noise_floor_state_size(int channels) {
+    return channels > 0 ? (size_t)channels * sizeof(noise_channel_t) : 0;
+}
+
+/**
+ * Освобождение карты (вызывается до закрытия файла состояния)
+ */
+void noise_floor_release(void) {
+    pthread_mutex_lock(&noise_mutex);
+    if (!noise_mapped) free(noise);
+    noise = NULL;
+    noise_count = 0;
+    noise_mapped = 0;
+    pthread_mutex_unlock(&noise_mutex);
+}
+
+/**
+ * Сброс карты шума (размер - охват плана сканирования)
+ * Если открыт файл состояния, карта размещается в нем; восстановленная
+ * из файла карта не сбрасывается, и шум каналов не изучается заново
+ * @return 0 при успехе, -1 при ошибке
+ */
+int noise_floor_reset(void) {
+    const scan_plan_t *plan = scan_plan_get();
+    noise_channel_t *mapped = scan_state_section(STATE_NOISE_FLOOR);
+
+    pthread_mutex_lock(&noise_mutex);
+    load_config();
+    if (mapped) {
+        if (!noise_mapped) free(noise);
+        noise = mapped;
+        noise_count = plan->channel_count;
+        noise_mapped = 1;
+        if (scan_state_restored()) {
+            for (int i = 0; i < noise_count; i++) {
+                noise[i].hot_since_ns = scan_state_rebase(noise[i].hot_since_ns);
+            }
+            pthread_mutex_unlock(&noise_mutex);
+            return 0;
+        }
+    } else if (noise_mapped || noise_count != plan->channel_count) {
+        if (!noise_mapped) free(noise);
+        noise = malloc(plan->channel_count * sizeof(*noise));
+        noise_count = noise ? plan->channel_count : 0;
+        noise_mapped = 0;
+    }
+    if (noise) memset(noise, 0, noise_count * sizeof(*noise));
+    pthread_mutex_unlock(&noise_mutex);
+
+    return noise ? 0 : -1;
+}
+
+/**
+ * Учет отсчета в состоянии канала (вызывается под noise_mutex)
+ */
+static void update_channel(noise_channel_t *ch, uint8_t rssi, uint64_t now_ns) {
+    uint32_t level_q8 = (uint32_t)rssi << 8;
+
+    if (ch->samples++ == 0) {
+        // Первый отсчет может прийтись на склон сигнала: шум не выше эталонного,
+        // более шумный канал поднимется до своего уровня через NOISE_ABSORB_MS
+        ch->floor_q8 = (uint32_t)(rssi < reference ? rssi : reference) << 8;
+        ch->spread_q8 = 0;
+    }
+
+    if (rssi <= quiet_limit(ch)) {
+        uint32_t deviation = level_q8 > ch->floor_q8 ? level_q8 - ch->floor_q8 : ch->floor_q8 - level_q8;
+        ch->floor_q8 = ch->floor_q8 - (ch->floor_q8 >> NOISE_SHIFT) + (level_q8 >> NOISE_SHIFT);
+        ch->spread_q8 = ch->spread_q8 - (ch->spread_q8 >> NOISE_SHIFT) + (deviation >> NOISE_SHIFT);
+        ch->quiet++;
+        ch->hot_since_ns = 0;
+    } else if (ch->hot_since_ns == 0) {
+        ch->hot_since_ns = now_ns ? now_ns : 1;
+    } else if (absorb_ns > 0 && now_ns - ch->hot_since_ns >= absorb_ns) {
+        // Постоянная помеха: уровень канала становится его шумом
+        ch->floor_q8 = ch->floor_q8 - (ch->floor_q8 >> NOISE_SHIFT) + (level_q8 >> NOISE_SHIFT);
+        ch->absorbed = 1;
+    }
+}
+
+/**
+ * Порог канала по порогу плана (вызывается под noise_mutex)
+ * @param ch Состояние канала (NULL - частота вне карты)
+ */
+static uint8_t channel_threshold(int threshold, const noise_channel_t *ch) {
+    if (ch && ch->samples >= NOISE_LEARN_SAMPLES) {
+        int level = floor_level(ch);
+        threshold += level - reference;
+        if (threshold < level + NOISE_MIN_MARGIN) threshold = level + NOISE_MIN_MARGIN;
+        if (threshold > 100) threshold = 100;
+    }
+    return (uint8_t)threshold;
+}
+
+/**
+ * Учет отсчета обхода в карте шума
+ * Отсчеты сопровождения и мониторинга не учитываются: долгое наблюдение
+ * за одним передатчиком не должно превращать его в шум
+ * @param frequency Частота
+ * @param rssi Измеренный (несглаженный) RSSI
+ * @param now_ns Время отсчета по часам приемника
+ */
+void noise_floor_update(uint16_t frequency, uint8_t rssi, uint64_t now_ns) {
+    pthread_mutex_lock(&noise_mutex);
+    noise_channel_t *ch = channel_state(frequency);
+    if (ch) update_channel(ch, rssi, now_ns);
+    pthread_mutex_unlock(&noise_mutex);
+}
+
+/**
+ * Учет отсчета и порог канала после него без блокировки карты
+ * (пакетный анализ спектра). Каналы разделены между потоками пакетного
+ * анализа, и состояние канала принадлежит одному потоку; вызывающий
+ * гарантирует, что карта не сбрасывается и те же каналы не обновляются
+ * другими вызовами одновременно
+ * @param update 0 - отсчет не учитывается (сопровождение), только порог
+ * @param cfar Порог CFAR канала (0 - порог по шуму канала)
+ * @return Порог RSSI (%)
+ */
+uint8_t noise_floor_observe(uint16_t frequency, uint8_t rssi, uint64_t now_ns, int update, uint8_t cfar) {
+    noise_channel_t *ch = channel_state(frequency);
+    if (ch && update) update_channel(ch, rssi, now_ns);
+    return cfar ? cfar : channel_threshold(scan_plan_threshold(frequency), ch);
+}
+
+/**
+ * Уровень шума канала
+ * @return Шум в процентах (эталонный, пока канал не изучен)
+ */
+uint8_t noise_floor_level(uint16_t frequency) {
+    uint8_t level = (uint8_t)reference;
+
+    pthread_mutex_lock(&noise_mutex);
+    const noise_channel_t *ch = channel_state(frequency);
+    if (ch && ch->samples >= NOISE_LEARN_SAMPLES) level = floor_level(ch);
+    pthread_mutex_unlock(&noise_mutex);
+    return level;
+}
+
+/**
+ * Порог обнаружения канала
+ * Порог CFAR по соседним каналам, если он оценен (DETECTOR=ca/os), иначе
+ * порог плана, сдвинутый на отклонение шума канала от эталонного
+ * @return Порог RSSI (%)
+ */
+uint8_t noise_floor_threshold(uint16_t frequency) {
+    uint8_t cfar = cfar_threshold(frequency);
+    if (cfar) return cfar;
+
+    int threshold = scan_plan_threshold(frequency);
+
+    pthread_mutex_lock(&noise_mutex);
+    uint8_t result = channel_threshold(threshold, channel_state(frequency));
+    pthread_mutex_unlock(&noise_mutex);
+    return result;
+}
+
+/**
+ * Проверка, что отсчет явно на уровне шума изученного канала
+ * Такой канал можно покинуть, не выдерживая полную паузу
+ * @param frequency Частота
+ * @param rssi Только что измеренный RSSI
+ * @return 1 если канал изучен и отсчет в полосе шума
+ */
+int noise_floor_quiet(uint16_t frequency, uint8_t rssi) {
+    int quiet = 0;
+
+    pthread_mutex_lock(&noise_mutex);
+    const noise_channel_t *ch = channel_state(frequency);
+    if (ch && ch->samples >= NOISE_LEARN_SAMPLES) {
+        quiet = rssi <= quiet_limit(ch);
+    }
+    pthread_mutex_unlock(&noise_mutex);
+    return quiet;
+}
+
+/**
+ * Печать карты шума: средний, наименьший и наибольший шум изученных каналов
+ */
+void noise_floor_print_stats(void) {
+    uint64_t sum = 0;
+    uint64_t samples = 0;
+    uint64_t quiet = 0;
+    int learned = 0;
+    int absorbed = 0;
+    int lowest = 100;
+    int highest = 0;
+
+    pthread_mutex_lock(&noise_mutex);
+    for (int i = 0; i < noise_count; i++) {
+        const noise_channel_t *ch = &noise[i];
+        samples += ch->samples;
+        quiet += ch->quiet;
+        if (ch->samples < NOISE_LEARN_SAMPLES) continue;
+
+        int level = floor_level(ch);
+        sum += level;
+        learned++;
+        if (ch->absorbed) absorbed++;
+        if (level < lowest) lowest = level;
+        if (level > highest) highest = level;
+    }
+    pthread_mutex_unlock(&noise_mutex);
+
+    if (learned == 0) return;
+
+    printf("   Шум каналов: ср. %llu%%, от %d%% до %d%% (изучено %d), тихих отсчетов %llu%%, постоянных помех %d\n",
+           (unsigned long long)(sum / learned), lowest, highest, learned,
+           (unsigned long long)(quiet * 100 / samples), absorbed);
+}
@@ -1,18 +1,192 @@
 #include "fpv_interceptor.h"
+#include "channel_store.h"
+#include "rssi_kernels.h"
+#include "cfar.h"
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
-// Глобальные переменные для анализа RSSI
-static uint8_t rssi_history[CHANNELS_COUNT][RSSI_SAMPLES];
-static uint8_t rssi_index[CHANNELS_COUNT] = {0};
-static uint8_t rssi_smoothed[CHANNELS_COUNT] = {0};
-static uint32_t last_update[CHANNELS_COUNT] = {0};
+// Состояние каналов (размер - охват плана сканирования) в хранилище
+// channel_store: история, время отсчетов и статистика скользящего окна
+// лежат отдельными выровненными массивами по всем каналам
+static channel_store_t *cs = NULL;
+
+// Статистика скользящего окна истории канала, обновляется за O(1) на отсчет:
+// суммы, сумма квадратов, минимум и максимум по монотонным очередям номеров
+// ячеек истории, счетчики соседних пар и локальных экстремумов, суммы
+// новейших и старейших отсчетов для тренда (rssi_kernels.h). Окно - последние
+// samples отсчетов в хронологическом порядке; отсчет 0 действителен, как и
+// любой другой.
 
 // Объявления функций
-static uint8_t analyze_rssi_trend(int channel);
-static uint8_t calculate_signal_stability(int channel);
-static uint8_t analyze_fpv_characteristics(int channel);
-static uint8_t analyze_periodicity(int channel);
-static uint8_t analyze_frequency_characteristics(int channel);
+static void smooth_rssi_at(int channel, uint8_t rssi, uint64_t now);
+
+/**
+ * Номер канала частоты (-1 если частота вне плана или анализатор не готов)
+ */
+static int frequency_channel(uint16_t frequency) {
+    int channel = scan_plan_channel(frequency);
+    return cs && channel < cs->count ? channel : -1;
+}
+
+/**
+ * Ячейка истории на k отсчетов раньше ячейки slot
+ */
+static inline int slot_back(int slot, int k) {
+    return (slot - k + RSSI_SAMPLES) % RSSI_SAMPLES;
+}
+
+/**
+ * Локальный экстремум: средний из трех соседних отсчетов
+ */
+static inline int is_extremum(uint8_t before, uint8_t middle, uint8_t after) {
+    return (middle > before && middle > after) || (middle < before && middle < after);
+}
+
+/**
+ * Минимум и максимум окна - головы монотонных очередей
+ * Кэшируются в cs->min/cs->max, чтобы ядро признаков не читало историю
+ */
+static inline void window_extremes(int channel) {
+    const uint8_t *h = cs->history[channel];
+    cs->min[channel] = cs->min_len[channel] ? h[cs->min_queue[channel][cs->min_head[channel]]] : 0;
+    cs->max[channel] = cs->max_len[channel] ? h[cs->max_queue[channel][cs->max_head[channel]]] : 0;
+}
+
+/**
+ * Добавление в окно отсчета, уже записанного в ячейку slot
+ * Окно не заполнено (samples < RSSI_SAMPLES)
+ */
+static void window_add(int channel, int slot) {
+    const uint8_t *h = cs->history[channel];
+    uint8_t x = h[slot];
+    uint8_t count = cs->samples[channel];
+    
+    cs->sum[channel] += x;
+    cs->sum_sq[channel] += (uint32_t)x * x;
+    
+    if (count >= 1) {
+        uint8_t prev = h[slot_back(slot, 1)];
+        cs->pairs[channel]++;
+        if (abs(x - prev) > WINDOW_CHANGE) cs->changes[channel]++;
+        if (count >= 2 && is_extremum(h[slot_back(slot, 2)], prev, x)) cs->extrema[channel]++;
+    }
+    
+    // Новый отсчет вытесняет из хвоста очередей значения, которые уже не
+    // станут минимумом (максимумом) окна
+    uint8_t *queue = cs->min_queue[channel];
+    uint8_t head = cs->min_head[channel];
+    uint8_t len = cs->min_len[channel];
+    while (len > 0 && h[queue[(head + len - 1) % RSSI_SAMPLES]] >= x) len--;
+    queue[(head + len++) % RSSI_SAMPLES] = (uint8_t)slot;
+    cs->min_len[channel] = len;
+    
+    queue = cs->max_queue[channel];
+    head = cs->max_head[channel];
+    len = cs->max_len[channel];
+    while (len > 0 && h[queue[(head + len - 1) % RSSI_SAMPLES]] <= x) len--;
+    queue[(head + len++) % RSSI_SAMPLES] = (uint8_t)slot;
+    cs->max_len[channel] = len;
+    
+    cs->recent_sum[channel] += x;
+    if (count >= WINDOW_RECENT) cs->recent_sum[channel] -= h[slot_back(slot, WINDOW_RECENT)];
+    if (count < WINDOW_OLD) cs->old_sum[channel] += x;
+    
+    cs->samples[channel] = count + 1;
+}
+
+/**
+ * Удаление из полного окна старейшего отсчета (ячейка slot)
+ * Вызывается до записи нового отсчета в эту ячейку
+ */
+static void window_remove_oldest(int channel, int slot) {
+    const uint8_t *h = cs->history[channel];
+    uint8_t x = h[slot];
+    uint8_t next = h[(slot + 1) % RSSI_SAMPLES];
+    
+    cs->sum[channel] -= x;
+    cs->sum_sq[channel] -= (uint32_t)x * x;
+    
+    cs->pairs[channel]--;
+    if (abs(next - x) > WINDOW_CHANGE) cs->changes[channel]--;
+    if (is_extremum(x, next, h[(slot + 2) % RSSI_SAMPLES])) cs->extrema[channel]--;
+    
+    // Старейший отсчет может быть только в голове очередей
+    if (cs->min_len[channel] > 0 && cs->min_queue[channel][cs->min_head[channel]] == slot) {
+        cs->min_head[channel] = (uint8_t)((cs->min_head[channel] + 1) % RSSI_SAMPLES);
+        cs->min_len[channel]--;
+    }
+    if (cs->max_len[channel] > 0 && cs->max_queue[channel][cs->max_head[channel]] == slot) {
+        cs->max_head[channel] = (uint8_t)((cs->max_head[channel] + 1) % RSSI_SAMPLES);
+        cs->max_len[channel]--;
+    }
+    
+    // Старейшие отсчеты сдвигаются на один
+    cs->old_sum[channel] += h[(slot + WINDOW_OLD) % RSSI_SAMPLES];
+    cs->old_sum[channel] -= x;
+    
+    cs->samples[channel]--;
+}
+
+/**
+ * Пересчет окон по истории (после восстановления из файла состояния)
+ * Действительные отсчеты - с ненулевым временем, от старейшего
+ */
+static void rebuild_windows(void) {
+    for (int ch = 0; ch < cs->count; ch++) {
+        for (int i = 0; i < RSSI_SAMPLES; i++) {
+            int slot = (cs->index[ch] + i) % RSSI_SAMPLES;
+            if (cs->time_ns[ch][slot] != 0) window_add(ch, slot);
+        }
+        window_extremes(ch);
+        if (cs->samples[ch] > 0) {
+            cs->smoothed[ch] = (uint8_t)(cs->sum[ch] / cs->samples[ch]);
+        }
+    }
+}
+
+/**
+ * Среднеквадратичное отклонение по сумме и сумме квадратов
+ */
+static uint8_t window_deviation(uint32_t sum, uint32_t sum_sq, int count) {
+    if (count < 2) return 0;
+    
+    uint64_t spread = (uint64_t)count * sum_sq - (uint64_t)sum * sum; // count^2 * дисперсия
+    return (uint8_t)(sqrt((double)spread) / count + 0.5);
+}
+
+/**
+ * Слитное ядро признаков канала
+ * За один проход по полям хранилища считает все признаки окна: среднее,
+ * размах, тренд, пики и провалы, долю изменений и оценки FPV. Историю не
+ * читает: всё берется из счетчиков окна и кэша минимума и максимума.
+ * @param channel Номер канала
+ * @param f Признаки канала
+ */
+static inline void channel_features(int channel, rssi_features_t *f) {
+    rssi_window_sums_t w;
+    w.sum = cs->sum[channel];
+    w.sum_sq = cs->sum_sq[channel];
+    w.recent_sum = cs->recent_sum[channel];
+    w.old_sum = cs->old_sum[channel];
+    w.samples = cs->samples[channel];
+    w.pairs = cs->pairs[channel];
+    w.changes = cs->changes[channel];
+    w.extrema = cs->extrema[channel];
+    w.min = cs->min[channel];
+    w.max = cs->max[channel];
+    rssi_features_from_sums(&w, f);
+}
+
+/**
+ * Освобождение истории каналов
+ */
+static void free_history(void) {
+    cfar_release();
+    noise_floor_release();
+    channel_store_free();
+    cs = NULL;
+}
 
 /**
  * Инициализация анализатора RSSI
@@ -21,17 +195,45 @@ static uint8_t analyze_frequency_characteristics(int channel);
 int rssi_analyzer_init(void) {
     printf("🔍 Инициализация анализатора RSSI...\n");
     
-    // Очистка истории RSSI
-    for (int i = 0; i < CHANNELS_COUNT; i++) {
-        for (int j = 0; j < RSSI_SAMPLES; j++) {
-            rssi_history[i][j] = 0;
+    // История RSSI по всем каналам охвата плана. С STATE_FILE история
+    // размещается в файле состояния и восстанавливается после перезапуска,
+    // иначе - в памяти (пустая)
+    free_history();
+    int restored = channel_store_init(scan_plan_get()->channel_count);
+    if (restored < 0) {
+        printf("❌ Недостаточно памяти для истории RSSI\n");
+        free_history();
+        return -1;
+    }
+    cs = channel_store_get();
+    
+    // Метки времени прошлого запуска переносятся на текущие часы
+    if (restored) {
+        for (int ch = 0; ch < cs->count; ch++) {
+            for (int i = 0; i < RSSI_SAMPLES; i++) {
+                cs->time_ns[ch][i] = scan_state_rebase(cs->time_ns[ch][i]);
+            }
+            cs->last_update[ch] = scan_state_rebase(cs->last_update[ch]);
+            if (cs->index[ch] >= RSSI_SAMPLES) cs->index[ch] = 0;
         }
-        rssi_index[i] = 0;
-        rssi_smoothed[i] = 0;
-        last_update[i] = 0;
+        rebuild_windows();
+    }
+    
+    // Шум каналов изучается заново (или восстанавливается из файла состояния)
+    if (noise_floor_reset() != 0) {
+        printf("❌ Недостаточно памяти для карты шума\n");
+        free_history();
+        return -1;
+    }
+    
+    // Пороги CFAR (DETECTOR=ca/os) появляются после первого обхода
+    if (cfar_reset() != 0) {
+        printf("❌ Недостаточно памяти для порогов CFAR\n");
+        free_history();
+        return -1;
     }
     
-    printf("✅ Анализатор RSSI инициализирован\n");
+    printf("✅ Анализатор RSSI инициализирован (ядро признаков спектра: %s)\n", rssi_kernel_name());
     return 0;
 }
 
@@ -41,30 +243,35 @@ int rssi_analyzer_init(void) {
  * @param rssi Новое значение RSSI
  */
 void smooth_rssi(uint16_t frequency, uint8_t rssi) {
-    if (frequency < FREQ_MIN || frequency > FREQ_MAX) return;
-    
-    int channel = frequency - FREQ_MIN;
-    
-    // Добавление нового значения в историю
-    rssi_history[channel][rssi_index[channel]] = rssi;
-    rssi_index[channel] = (rssi_index[channel] + 1) % RSSI_SAMPLES;
-    
-    // Расчет сглаженного значения
-    uint32_t sum = 0;
-    uint8_t count = 0;
+    int channel = frequency_channel(frequency);
+    if (channel < 0) return;
     
-    for (int i = 0; i < RSSI_SAMPLES; i++) {
-        if (rssi_history[channel][i] > 0) {
-            sum += rssi_history[channel][i];
-            count++;
-        }
+    // Отсчет получает время по часам приемника (CLOCK_MONOTONIC на железе)
+    smooth_rssi_at(channel, rssi, rx5808_now_ns());
+}
+
+/**
+ * Сглаживание RSSI сигнала по отсчету с известным временем
+ * @param channel Номер канала
+ * @param rssi Новое значение RSSI
+ * @param now Время отсчета по часам приемника
+ */
+static void smooth_rssi_at(int channel, uint8_t rssi, uint64_t now) {
+    // Новое значение заменяет старейшее в истории и в окне
+    int slot = cs->index[channel];
+    if (cs->samples[channel] == RSSI_SAMPLES) {
+        window_remove_oldest(channel, slot);
     }
+    cs->history[channel][slot] = rssi;
+    cs->time_ns[channel][slot] = now;
+    cs->index[channel] = (uint8_t)((slot + 1) % RSSI_SAMPLES);
+    window_add(channel, slot);
+    window_extremes(channel);
     
-    if (count > 0) {
-        rssi_smoothed[channel] = (uint8_t)(sum / count);
-    }
+    // Сглаженное значение - среднее окна
+    cs->smoothed[channel] = (uint8_t)(cs->sum[channel] / cs->samples[channel]);
     
-    last_update[channel] = get_timestamp();
+    cs->last_update[channel] = now;
 }
 
 /**
@@ -73,289 +280,263 @@ void smooth_rssi(uint16_t frequency, uint8_t rssi) {
  * @return Уровень RSSI (0-100)
  */
 uint8_t analyze_rssi(uint16_t frequency) {
-    if (frequency < FREQ_MIN || frequency > FREQ_MAX) return 0;
+    if (frequency_channel(frequency) < 0) return 0;
     
-    int channel = frequency - FREQ_MIN;
-    
-    // Чтение текущего RSSI (заглушка)
+    // Чтение текущего RSSI
     uint8_t current_rssi = rx5808_read_rssi();
+    return analyze_rssi_sample(frequency, current_rssi, rx5808_now_ns());
+}
+
+/**
+ * Анализ уже измеренного отсчета RSSI
+ * Не обращается к приемнику, поэтому может выполняться в потоке
+ * анализа, пока приемник перестраивается на следующую частоту
+ * @param frequency Частота в МГц
+ * @param current_rssi Измеренный RSSI
+ * @param timestamp_ns Время отсчета по часам приемника
+ * @return Уровень RSSI (0-100)
+ */
+uint8_t analyze_rssi_sample(uint16_t frequency, uint8_t current_rssi, uint64_t timestamp_ns) {
+    int channel = frequency_channel(frequency);
+    if (channel < 0) return 0;
     
     // Сглаживание
-    smooth_rssi(frequency, current_rssi);
-    
-    // Анализ тренда
-    uint8_t trend = analyze_rssi_trend(channel);
+    smooth_rssi_at(channel, current_rssi, timestamp_ns);
     
     // Коррекция на основе тренда
+    uint8_t trend = rssi_window_trend(cs->samples[channel], cs->recent_sum[channel], cs->old_sum[channel]);
     uint8_t corrected_rssi = current_rssi;
     if (trend > 50) {
-        corrected_rssi = (current_rssi + rssi_smoothed[channel]) / 2;
+        corrected_rssi = (current_rssi + cs->smoothed[channel]) / 2;
     }
     
     return corrected_rssi;
 }
 
-/**
- * Анализ тренда RSSI
- * @param channel Номер канала
- * @return Тренд (0-100)
- */
-uint8_t analyze_rssi_trend(int channel) {
-    if (channel < 0 || channel >= CHANNELS_COUNT) return 0;
-    
-    uint8_t recent_sum = 0;
-    uint8_t old_sum = 0;
-    uint8_t recent_count = 0;
-    uint8_t old_count = 0;
-    
-    // Анализ последних 20% выборок
-    int recent_start = (RSSI_SAMPLES * 8) / 10;
-    int old_start = 0;
-    int old_end = RSSI_SAMPLES / 2;
-    
-    for (int i = recent_start; i < RSSI_SAMPLES; i++) {
-        if (rssi_history[channel][i] > 0) {
-            recent_sum += rssi_history[channel][i];
-            recent_count++;
-        }
-    }
-    
-    for (int i = old_start; i < old_end; i++) {
-        if (rssi_history[channel][i] > 0) {
-            old_sum += rssi_history[channel][i];
-            old_count++;
-        }
-    }
-    
-    if (recent_count == 0 || old_count == 0) return 50;
-    
-    uint8_t recent_avg = recent_sum / recent_count;
-    uint8_t old_avg = old_sum / old_count;
-    
-    // Расчет тренда
-    if (recent_avg > old_avg) {
-        return 50 + ((recent_avg - old_avg) * 25) / 100;
-    } else {
-        return 50 - ((old_avg - recent_avg) * 25) / 100;
-    }
-}
-
 /**
  * Обнаружение видеосигнала по RSSI
  * @param frequency Частота в МГц
  * @return 1 если видеосигнал обнаружен, 0 если нет
  */
 uint8_t detect_video_signal(uint16_t frequency) {
-    if (frequency < FREQ_MIN || frequency > FREQ_MAX) return 0;
+    int channel = frequency_channel(frequency);
+    if (channel < 0) return 0;
     
-    int channel = frequency - FREQ_MIN;
     uint8_t rssi = analyze_rssi(frequency);
     
-    // Проверка базового порога
-    if (rssi < RSSI_THRESHOLD) return 0;
-    
-    // Анализ стабильности сигнала
-    uint8_t stability = calculate_signal_stability(channel);
+    // Проверка порога диапазона плана
+    if (rssi < noise_floor_threshold(frequency)) return 0;
     
-    // Анализ характеристик FPV сигнала
-    uint8_t fpv_characteristics = analyze_fpv_characteristics(channel);
+    // Стабильность и характеристики FPV сигнала
+    rssi_features_t f;
+    channel_features(channel, &f);
     
-    // Комбинированная оценка
-    uint8_t video_score = (rssi * 40 + stability * 30 + fpv_characteristics * 30) / 100;
-    
-    return (video_score > 60) ? 1 : 0;
+    return rssi_video_detected(rssi, &f);
 }
 
 /**
- * Расчет стабильности сигнала
+ * Анализ амплитудной модуляции
  * @param channel Номер канала
- * @return Стабильность (0-100)
+ * @return Оценка АМ (0-100)
  */
-uint8_t calculate_signal_stability(int channel) {
-    if (channel < 0 || channel >= CHANNELS_COUNT) return 0;
-    
-    uint8_t min_rssi = 255;
-    uint8_t max_rssi = 0;
-    uint8_t valid_samples = 0;
-    
-    for (int i = 0; i < RSSI_SAMPLES; i++) {
-        if (rssi_history[channel][i] > 0) {
-            if (rssi_history[channel][i] < min_rssi) {
-                min_rssi = rssi_history[channel][i];
-            }
-            if (rssi_history[channel][i] > max_rssi) {
-                max_rssi = rssi_history[channel][i];
-            }
-            valid_samples++;
-        }
-    }
-    
-    if (valid_samples < 5) return 0;
-    
-    uint8_t range = max_rssi - min_rssi;
-    uint8_t stability = (range < 20) ? 100 : (range < 40) ? 80 : (range < 60) ? 60 : 40;
+uint8_t analyze_amplitude_modulation(int channel) {
+    if (!cs || channel < 0 || channel >= cs->count) return 0;
     
-    return stability;
+    rssi_features_t f;
+    channel_features(channel, &f);
+    return f.modulation;
 }
 
 /**
- * Анализ характеристик FPV сигнала
- * @param channel Номер канала
- * @return Оценка FPV характеристик (0-100)
+ * Признаки окна истории канала
+ * @param frequency Частота в МГц
+ * @param features Указатель на структуру признаков
+ * @return 0 при успехе, -1 если частота вне плана
  */
-uint8_t analyze_fpv_characteristics(int channel) {
-    if (channel < 0 || channel >= CHANNELS_COUNT) return 0;
-    
-    // Анализ периодичности (FPV имеет характерную периодичность)
-    uint8_t periodicity = analyze_periodicity(channel);
+int get_rssi_features(uint16_t frequency, rssi_features_t *features) {
+    int channel = frequency_channel(frequency);
+    if (!features || channel < 0) return -1;
     
-    // Анализ амплитудной модуляции
-    uint8_t amplitude_mod = analyze_amplitude_modulation(channel);
-    
-    // Анализ частотных характеристик
-    uint8_t frequency_chars = analyze_frequency_characteristics(channel);
-    
-    return (periodicity + amplitude_mod + frequency_chars) / 3;
+    channel_features(channel, features);
+    features->frequency = frequency;
+    return 0;
 }
 
 /**
- * Анализ периодичности сигнала
- * @param channel Номер канала
- * @return Периодичность (0-100)
+ * Признаки подряд идущих каналов плана
+ * Проход по каналам читает поля хранилища последовательно
+ * @param first Первый канал
+ * @param count Количество каналов
+ * @param out Массив признаков (count элементов)
+ * @return Количество обработанных каналов
  */
-uint8_t analyze_periodicity(int channel) {
-    if (channel < 0 || channel >= CHANNELS_COUNT) return 0;
-    
-    uint8_t peaks = 0;
-    uint8_t valleys = 0;
-    
-    for (int i = 1; i < RSSI_SAMPLES - 1; i++) {
-        if (rssi_history[channel][i] > 0) {
-            uint8_t prev = rssi_history[channel][i-1];
-            uint8_t curr = rssi_history[channel][i];
-            uint8_t next = rssi_history[channel][i+1];
-            
-            if (curr > prev && curr > next) {
-                peaks++;
-            } else if (curr < prev && curr < next) {
-                valleys++;
-            }
-        }
+int rssi_features_batch(int first, int count, rssi_features_t *out) {
+    if (!cs || !out || first < 0 || first >= cs->count || count <= 0) return 0;
+    if (count > cs->count - first) count = cs->count - first;
+    
+    uint16_t base = scan_plan_get()->freq_min;
+    for (int i = 0; i < count; i++) {
+        channel_features(first + i, &out[i]);
+        out[i].frequency = (uint16_t)(base + first + i);
     }
-    
-    // FPV сигнал имеет характерную периодичность
-    uint8_t periodicity_score = (peaks + valleys) * 10;
-    return (periodicity_score > 100) ? 100 : periodicity_score;
+    return count;
 }
 
 /**
- * Анализ амплитудной модуляции
- * @param channel Номер канала
- * @return Оценка АМ (0-100)
+ * Признаки окон по матрице отсчетов (весь спектр за один проход)
+ * Строка - окно канала в хронологическом порядке, например обход из
+ * архива; суммы считает векторная реализация (rssi_kernels.c)
+ * @param rows Первая строка
+ * @param stride Шаг строк в байтах
+ * @param samples Отсчетов в строке (не больше 255)
+ * @param count Количество строк (каналов)
+ * @param first_frequency Частота первой строки, следующие - через 1 МГц
+ * @param out Массив признаков (count элементов)
+ * @return Количество обработанных строк
  */
-uint8_t analyze_amplitude_modulation(int channel) {
-    if (channel < 0 || channel >= CHANNELS_COUNT) return 0;
-    
-    uint32_t sum = 0;
-    uint8_t count = 0;
-    uint8_t max_val = 0;
-    uint8_t min_val = 255;
-    
-    for (int i = 0; i < RSSI_SAMPLES; i++) {
-        if (rssi_history[channel][i] > 0) {
-            sum += rssi_history[channel][i];
-            count++;
-            if (rssi_history[channel][i] > max_val) {
-                max_val = rssi_history[channel][i];
-            }
-            if (rssi_history[channel][i] < min_val) {
-                min_val = rssi_history[channel][i];
-            }
+int rssi_spectrum_features(const uint8_t *rows, size_t stride, int samples, int count,
+                           uint16_t first_frequency, rssi_features_t *out) {
+    if (!rows || !out || count <= 0 || samples < 0 || samples > 255) return 0;
+    
+    // Суммы блоками строк: блок сумм остается в кэше до расчета признаков
+    rssi_window_sums_t sums[64];
+    for (int first = 0; first < count; first += 64) {
+        int n = count - first < 64 ? count - first : 64;
+        rssi_window_sums(rows + (size_t)first * stride, stride, samples, n, sums);
+        for (int i = 0; i < n; i++) {
+            rssi_features_from_sums(&sums[i], &out[first + i]);
+            out[first + i].frequency = (uint16_t)(first_frequency + first + i);
         }
     }
+    return count;
+}
+
+/**
+ * Получение статистики RSSI для канала
+ * @param frequency Частота в МГц
+ * @param stats Указатель на структуру статистики
+ */
+void get_rssi_stats(uint16_t frequency, rssi_stats_t *stats) {
+    int channel = frequency_channel(frequency);
+    if (!stats || channel < 0) return;
     
-    if (count < 5) return 0;
-    
-    uint8_t modulation_depth = max_val - min_val;
-    
-    // FPV имеет характерную глубину модуляции
-    uint8_t am_score = (modulation_depth > 20 && modulation_depth < 60) ? 80 : 
-                       (modulation_depth > 10 && modulation_depth < 80) ? 60 : 40;
+    rssi_features_t f;
+    channel_features(channel, &f);
     
-    return am_score;
+    stats->frequency = frequency;
+    stats->current_rssi = cs->smoothed[channel];
+    stats->samples = f.samples;
+    stats->max_rssi = f.samples > 0 ? f.max : 0;
+    stats->min_rssi = f.samples > 0 ? f.min : 255;
+    stats->avg_rssi = f.mean;
+    stats->deviation = window_deviation(cs->sum[channel], cs->sum_sq[channel], f.samples);
+    
+    stats->stability = f.stability;
+    stats->last_update_ns = cs->last_update[channel];
 }
 
 /**
- * Анализ частотных характеристик
- * @param channel Номер канала
- * @return Оценка частотных характеристик (0-100)
+ * История отсчетов канала в хронологическом порядке
+ * @param frequency Частота в МГц
+ * @param rssi Буфер для отсчетов
+ * @param timestamps_ns Буфер для времени отсчетов (может быть NULL)
+ * @param max Размер буферов
+ * @return Количество отсчетов
  */
-uint8_t analyze_frequency_characteristics(int channel) {
-    if (channel < 0 || channel >= CHANNELS_COUNT) return 0;
-    
-    // Простой анализ изменений RSSI
-    uint8_t changes = 0;
-    uint8_t valid_samples = 0;
-    
-    for (int i = 1; i < RSSI_SAMPLES; i++) {
-        if (rssi_history[channel][i] > 0 && rssi_history[channel][i-1] > 0) {
-            uint8_t diff = abs(rssi_history[channel][i] - rssi_history[channel][i-1]);
-            if (diff > 5) {
-                changes++;
-            }
-            valid_samples++;
+int get_rssi_history(uint16_t frequency, uint8_t *rssi, uint64_t *timestamps_ns, int max) {
+    int channel = frequency_channel(frequency);
+    if (!rssi || max <= 0 || channel < 0) return 0;
+    int count = 0;
+    
+    // Самый старый отсчет - на текущей позиции записи
+    for (int i = 0; i < RSSI_SAMPLES && count < max; i++) {
+        int index = (cs->index[channel] + i) % RSSI_SAMPLES;
+        if (cs->time_ns[channel][index] == 0) continue;
+        
+        rssi[count] = cs->history[channel][index];
+        if (timestamps_ns) {
+            timestamps_ns[count] = cs->time_ns[channel][index];
         }
+        count++;
     }
-    
-    if (valid_samples < 5) return 0;
-    
-    uint8_t change_rate = (changes * 100) / valid_samples;
-    
-    // FPV имеет характерную частоту изменений
-    uint8_t freq_score = (change_rate > 20 && change_rate < 60) ? 80 :
-                         (change_rate > 10 && change_rate < 80) ? 60 : 40;
-    
-    return freq_score;
+    return count;
 }
 
 /**
- * Получение статистики RSSI для канала
- * @param frequency Частота в МГц
+ * Статистика пакета отсчетов RSSI (rx5808_read_rssi_burst)
+ * @param samples Отсчеты
+ * @param count Количество отсчетов
  * @param stats Указатель на структуру статистики
  */
-void get_rssi_stats(uint16_t frequency, rssi_stats_t *stats) {
-    if (!stats || frequency < FREQ_MIN || frequency > FREQ_MAX) return;
+void rssi_burst_stats(const uint8_t *samples, int count, rssi_stats_t *stats) {
+    if (!stats) return;
     
-    int channel = frequency - FREQ_MIN;
+    memset(stats, 0, sizeof(*stats));
+    if (!samples || count <= 0) return;
     
-    stats->frequency = frequency;
-    stats->current_rssi = rssi_smoothed[channel];
-    stats->max_rssi = 0;
+    uint32_t sum = 0;
+    uint32_t sum_sq = 0;
     stats->min_rssi = 255;
-    stats->avg_rssi = 0;
-    stats->samples = 0;
     
-    uint32_t sum = 0;
+    for (int i = 0; i < count; i++) {
+        if (samples[i] > stats->max_rssi) stats->max_rssi = samples[i];
+        if (samples[i] < stats->min_rssi) stats->min_rssi = samples[i];
+        sum += samples[i];
+        sum_sq += (uint32_t)samples[i] * samples[i];
+    }
     
-    for (int i = 0; i < RSSI_SAMPLES; i++) {
-        if (rssi_history[channel][i] > 0) {
-            if (rssi_history[channel][i] > stats->max_rssi) {
-                stats->max_rssi = rssi_history[channel][i];
-            }
-            if (rssi_history[channel][i] < stats->min_rssi) {
-                stats->min_rssi = rssi_history[channel][i];
-            }
-            sum += rssi_history[channel][i];
-            stats->samples++;
+    stats->samples = count;
+    stats->avg_rssi = (uint8_t)(sum / count);
+    stats->deviation = window_deviation(sum, sum_sq, count);
+    stats->current_rssi = samples[count - 1];
+    
+    uint8_t range = stats->max_rssi - stats->min_rssi;
+    stats->stability = (range < 20) ? 100 : (range < 40) ? 80 : (range < 60) ? 60 : 40;
+    stats->last_update_ns = rx5808_now_ns();
+}
+
+/**
+ * Прореживание пакета RSSI усреднением по блокам
+ * Неполный последний блок усредняется по фактической длине
+ * @param samples Входные отсчеты
+ * @param count Количество входных отсчетов
+ * @param factor Коэффициент прореживания
+ * @param out Выходной буфер (не меньше (count + factor - 1) / factor)
+ * @return Количество выходных отсчетов
+ */
+int rssi_decimate(const uint8_t *samples, int count, int factor, uint8_t *out) {
+    if (!samples || !out || count <= 0 || factor <= 0) return 0;
+    
+    int produced = 0;
+    for (int start = 0; start < count; start += factor) {
+        int end = (start + factor < count) ? start + factor : count;
+        uint32_t sum = 0;
+        for (int i = start; i < end; i++) {
+            sum += samples[i];
         }
+        out[produced++] = (uint8_t)(sum / (end - start));
     }
-    
-    if (stats->samples > 0) {
-        stats->avg_rssi = sum / stats->samples;
+    return produced;
+}
+
+/**
+ * Прореживание пакета RSSI с удержанием пика по блокам
+ * Короткие импульсы не размываются, в отличие от усреднения
+ * @return Количество выходных отсчетов
+ */
+int rssi_decimate_peak(const uint8_t *samples, int count, int factor, uint8_t *out) {
+    if (!samples || !out || count <= 0 || factor <= 0) return 0;
+    
+    int produced = 0;
+    for (int start = 0; start < count; start += factor) {
+        int end = (start + factor < count) ? start + factor : count;
+        uint8_t peak = 0;
+        for (int i = start; i < end; i++) {
+            if (samples[i] > peak) peak = samples[i];
+        }
+        out[produced++] = peak;
     }
-    
-    stats->stability = calculate_signal_stability(channel);
-    stats->last_update = last_update[channel];
+    return produced;
 }
 
 /**
@@ -364,14 +545,7 @@ void get_rssi_stats(uint16_t frequency, rssi_stats_t *stats) {
 void rssi_analyzer_cleanup(void) {
     printf("🧹 Очистка анализатора RSSI...\n");
     
-    for (int i = 0; i < CHANNELS_COUNT; i++) {
-        for (int j = 0; j < RSSI_SAMPLES; j++) {
-            rssi_history[i][j] = 0;
-        }
-        rssi_index[i] = 0;
-        rssi_smoothed[i] = 0;
-        last_update[i] = 0;
-    }
+    free_history();
     
     printf("✅ Анализатор RSSI очищен\n");
 }
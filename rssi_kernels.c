@@ -0,0 +1,548 @@
+#include "rssi_kernels.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#include <immintrin.h>
+#define KERNELS_X86 1
+#endif
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#define KERNELS_NEON 1
+#elif defined(__arm__) && defined(__ARM_FP) && defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 8
+// 32-битный Raspberry Pi OS собирается без -mfpu=neon (база ARMv6): ядро
+// NEON компилируется с target("fpu=neon") и выбирается по HWCAP_NEON
+#define KERNELS_NEON 1
+#define KERNELS_NEON_TARGET 1
+#endif
+
+#if defined(KERNELS_NEON) && !defined(__aarch64__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+/**
+ * Ядра сумм окон по матрице отсчетов RSSI
+ * Строка матрицы - окно канала в хронологическом порядке (история
+ * хранилища каналов или окно из архива обходов). Реализации считают все
+ * суммы строки за один проход по ней: сумму, сумму квадратов, минимум,
+ * максимум, пары с заметным изменением и локальные экстремумы. Векторные
+ * реализации обрабатывают по 16 (SSE2, NEON) или 32 (AVX2) отсчета, хвост
+ * строки - скалярно; результаты всех реализаций совпадают. Реализация
+ * выбирается по процессору при первом вызове, RSSI_KERNEL в конфигурации
+ * задает ее явно.
+ */
+
+typedef void (*rssi_sums_fn)(const uint8_t *rows, size_t stride, int samples, int count,
+                             rssi_window_sums_t *out);
+
+typedef struct {
+    const char *name;
+    rssi_sums_fn sums;
+    int (*supported)(void);
+} rssi_kernel_t;
+
+static const rssi_kernel_t *active = NULL;
+static const char *available[8];
+static pthread_once_t kernel_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Начало сумм строки: окно из samples отсчетов
+ */
+static inline void sums_begin(rssi_window_sums_t *w, int samples) {
+    memset(w, 0, sizeof(*w));
+    w->samples = (uint8_t)samples;
+    w->pairs = (uint8_t)(samples > 0 ? samples - 1 : 0);
+    w->min = 255;
+}
+
+/**
+ * Скалярные суммы отсчетов [from, to): сумма, квадраты, минимум, максимум
+ */
+static inline void scalar_values(const uint8_t *h, int from, int to, rssi_window_sums_t *w) {
+    for (int i = from; i < to; i++) {
+        uint8_t x = h[i];
+        w->sum += x;
+        w->sum_sq += (uint32_t)x * x;
+        if (x < w->min) w->min = x;
+        if (x > w->max) w->max = x;
+    }
+}
+
+/**
+ * Скалярный подсчет изменений в парах (i - 1, i) для i из [from, to)
+ */
+static inline int scalar_changes(const uint8_t *h, int from, int to) {
+    int changes = 0;
+    for (int i = from; i < to; i++) {
+        if (abs(h[i] - h[i - 1]) > WINDOW_CHANGE) changes++;
+    }
+    return changes;
+}
+
+/**
+ * Скалярный подсчет экстремумов с серединой i из [from, to)
+ */
+static inline int scalar_extrema(const uint8_t *h, int from, int to) {
+    int extrema = 0;
+    for (int i = from; i < to; i++) {
+        if ((h[i] > h[i - 1] && h[i] > h[i + 1]) || (h[i] < h[i - 1] && h[i] < h[i + 1])) extrema++;
+    }
+    return extrema;
+}
+
+/**
+ * Скалярная сумма отсчетов [from, to)
+ */
+static inline uint32_t scalar_sum(const uint8_t *h, int from, int to) {
+    uint32_t sum = 0;
+    for (int i = from; i < to; i++) sum += h[i];
+    return sum;
+}
+
+/**
+ * Конец сумм строки: суммы тренда и минимум пустого окна
+ * @param sum Функция суммы отсчетов строки (скалярная или векторная)
+ */
+static inline void sums_end(const uint8_t *h, int samples, rssi_window_sums_t *w,
+                            uint32_t (*sum)(const uint8_t*, int, int)) {
+    int recent = samples < WINDOW_RECENT ? samples : WINDOW_RECENT;
+    int old = samples < WINDOW_OLD ? samples : WINDOW_OLD;
+    w->recent_sum = sum(h, samples - recent, samples);
+    w->old_sum = sum(h, 0, old);
+    if (samples == 0) w->min = 0;
+}
+
+static uint32_t scalar_sum_fn(const uint8_t *h, int from, int to) {
+    return scalar_sum(h, from, to);
+}
+
+/**
+ * Переносимая реализация (эталон для векторных)
+ */
+static void sums_scalar(const uint8_t *rows, size_t stride, int samples, int count,
+                        rssi_window_sums_t *out) {
+    for (int ch = 0; ch < count; ch++) {
+        const uint8_t *h = rows + (size_t)ch * stride;
+        rssi_window_sums_t *w = &out[ch];
+
+        sums_begin(w, samples);
+        scalar_values(h, 0, samples, w);
+        w->changes = (uint8_t)scalar_changes(h, 1, samples);
+        w->extrema = (uint8_t)scalar_extrema(h, 1, samples - 1);
+        sums_end(h, samples, w, scalar_sum_fn);
+    }
+}
+
+static int always_supported(void) {
+    return 1;
+}
+
+#ifdef KERNELS_X86
+
+/**
+ * Горизонтальные свертки 128-битных регистров
+ */
+static inline uint32_t hsum_epi32(__m128i v) {
+    v = _mm_add_epi32(v, _mm_srli_si128(v, 8));
+    v = _mm_add_epi32(v, _mm_srli_si128(v, 4));
+    return (uint32_t)_mm_cvtsi128_si32(v);
+}
+
+static inline uint32_t hsum_sad(__m128i v) {
+    return (uint32_t)_mm_cvtsi128_si32(v) + (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+}
+
+static inline uint8_t hmin_epu8(__m128i v) {
+    v = _mm_min_epu8(v, _mm_srli_si128(v, 8));
+    v = _mm_min_epu8(v, _mm_srli_si128(v, 4));
+    v = _mm_min_epu8(v, _mm_srli_si128(v, 2));
+    v = _mm_min_epu8(v, _mm_srli_si128(v, 1));
+    return (uint8_t)_mm_cvtsi128_si32(v);
+}
+
+static inline uint8_t hmax_epu8(__m128i v) {
+    v = _mm_max_epu8(v, _mm_srli_si128(v, 8));
+    v = _mm_max_epu8(v, _mm_srli_si128(v, 4));
+    v = _mm_max_epu8(v, _mm_srli_si128(v, 2));
+    v = _mm_max_epu8(v, _mm_srli_si128(v, 1));
+    return (uint8_t)_mm_cvtsi128_si32(v);
+}
+
+static uint32_t sse2_sum(const uint8_t *h, int from, int to) {
+    __m128i acc = _mm_setzero_si128();
+    int i = from;
+    for (; i + 16 <= to; i += 16) {
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128((const __m128i*)(h + i)), _mm_setzero_si128()));
+    }
+    return hsum_sad(acc) + scalar_sum(h, i, to);
+}
+
+/**
+ * SSE2: по 16 отсчетов
+ * Сравнение без знака через вычитание с насыщением: a > b <=> (a -sat b) != 0
+ */
+static void sums_sse2(const uint8_t *rows, size_t stride, int samples, int count,
+                      rssi_window_sums_t *out) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i change = _mm_set1_epi8(WINDOW_CHANGE);
+
+    for (int ch = 0; ch < count; ch++) {
+        const uint8_t *h = rows + (size_t)ch * stride;
+        rssi_window_sums_t *w = &out[ch];
+        sums_begin(w, samples);
+
+        __m128i vsum = zero, vsq = zero, vmax = zero;
+        __m128i vmin = _mm_set1_epi8((char)0xFF);
+        int i = 0;
+        for (; i + 16 <= samples; i += 16) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(h + i));
+            __m128i lo = _mm_unpacklo_epi8(x, zero);
+            __m128i hi = _mm_unpackhi_epi8(x, zero);
+            vsum = _mm_add_epi64(vsum, _mm_sad_epu8(x, zero));
+            vsq = _mm_add_epi32(vsq, _mm_add_epi32(_mm_madd_epi16(lo, lo), _mm_madd_epi16(hi, hi)));
+            vmin = _mm_min_epu8(vmin, x);
+            vmax = _mm_max_epu8(vmax, x);
+        }
+        if (i > 0) {
+            w->sum = hsum_sad(vsum);
+            w->sum_sq = hsum_epi32(vsq);
+            w->min = hmin_epu8(vmin);
+            w->max = hmax_epu8(vmax);
+        }
+        scalar_values(h, i, samples, w);
+
+        // Пары (i - 1, i): |a - b| > WINDOW_CHANGE
+        int changes = 0;
+        for (i = 1; i + 16 <= samples; i += 16) {
+            __m128i a = _mm_loadu_si128((const __m128i*)(h + i));
+            __m128i b = _mm_loadu_si128((const __m128i*)(h + i - 1));
+            __m128i diff = _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+            __m128i small = _mm_cmpeq_epi8(_mm_subs_epu8(diff, change), zero);
+            changes += 16 - __builtin_popcount((unsigned)_mm_movemask_epi8(small));
+        }
+        w->changes = (uint8_t)(changes + scalar_changes(h, i, samples));
+
+        // Середина i выше (ниже) обоих соседей
+        int extrema = 0;
+        for (i = 1; i + 17 <= samples; i += 16) {
+            __m128i m = _mm_loadu_si128((const __m128i*)(h + i));
+            __m128i b = _mm_loadu_si128((const __m128i*)(h + i - 1));
+            __m128i a = _mm_loadu_si128((const __m128i*)(h + i + 1));
+            __m128i not_peak = _mm_or_si128(_mm_cmpeq_epi8(_mm_subs_epu8(m, b), zero),
+                                            _mm_cmpeq_epi8(_mm_subs_epu8(m, a), zero));
+            __m128i not_valley = _mm_or_si128(_mm_cmpeq_epi8(_mm_subs_epu8(b, m), zero),
+                                              _mm_cmpeq_epi8(_mm_subs_epu8(a, m), zero));
+            extrema += 32 - __builtin_popcount((unsigned)_mm_movemask_epi8(not_peak))
+                          - __builtin_popcount((unsigned)_mm_movemask_epi8(not_valley));
+        }
+        w->extrema = (uint8_t)(extrema + scalar_extrema(h, i, samples - 1));
+
+        sums_end(h, samples, w, sse2_sum);
+    }
+}
+
+__attribute__((target("avx2")))
+static uint32_t avx2_sum(const uint8_t *h, int from, int to) {
+    __m256i acc = _mm256_setzero_si256();
+    int i = from;
+    for (; i + 32 <= to; i += 32) {
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_loadu_si256((const __m256i*)(h + i)),
+                                                    _mm256_setzero_si256()));
+    }
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    return hsum_sad(half) + sse2_sum(h, i, to);
+}
+
+/**
+ * AVX2: по 32 отсчета, свертка через половины 128 бит
+ */
+__attribute__((target("avx2")))
+static void sums_avx2(const uint8_t *rows, size_t stride, int samples, int count,
+                      rssi_window_sums_t *out) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i change = _mm256_set1_epi8(WINDOW_CHANGE);
+
+    for (int ch = 0; ch < count; ch++) {
+        const uint8_t *h = rows + (size_t)ch * stride;
+        rssi_window_sums_t *w = &out[ch];
+        sums_begin(w, samples);
+
+        __m256i vsum = zero, vsq = zero, vmax = zero;
+        __m256i vmin = _mm256_set1_epi8((char)0xFF);
+        int i = 0;
+        for (; i + 32 <= samples; i += 32) {
+            __m256i x = _mm256_loadu_si256((const __m256i*)(h + i));
+            __m256i lo = _mm256_unpacklo_epi8(x, zero);
+            __m256i hi = _mm256_unpackhi_epi8(x, zero);
+            vsum = _mm256_add_epi64(vsum, _mm256_sad_epu8(x, zero));
+            vsq = _mm256_add_epi32(vsq, _mm256_add_epi32(_mm256_madd_epi16(lo, lo), _mm256_madd_epi16(hi, hi)));
+            vmin = _mm256_min_epu8(vmin, x);
+            vmax = _mm256_max_epu8(vmax, x);
+        }
+        if (i > 0) {
+            __m128i low = _mm256_castsi256_si128(vsum), high = _mm256_extracti128_si256(vsum, 1);
+            w->sum = hsum_sad(_mm_add_epi64(low, high));
+            low = _mm256_castsi256_si128(vsq);
+            high = _mm256_extracti128_si256(vsq, 1);
+            w->sum_sq = hsum_epi32(_mm_add_epi32(low, high));
+            w->min = hmin_epu8(_mm_min_epu8(_mm256_castsi256_si128(vmin), _mm256_extracti128_si256(vmin, 1)));
+            w->max = hmax_epu8(_mm_max_epu8(_mm256_castsi256_si128(vmax), _mm256_extracti128_si256(vmax, 1)));
+        }
+        scalar_values(h, i, samples, w);
+
+        int changes = 0;
+        for (i = 1; i + 32 <= samples; i += 32) {
+            __m256i a = _mm256_loadu_si256((const __m256i*)(h + i));
+            __m256i b = _mm256_loadu_si256((const __m256i*)(h + i - 1));
+            __m256i diff = _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a));
+            __m256i small = _mm256_cmpeq_epi8(_mm256_subs_epu8(diff, change), zero);
+            changes += 32 - __builtin_popcount((unsigned)_mm256_movemask_epi8(small));
+        }
+        w->changes = (uint8_t)(changes + scalar_changes(h, i, samples));
+
+        int extrema = 0;
+        for (i = 1; i + 33 <= samples; i += 32) {
+            __m256i m = _mm256_loadu_si256((const __m256i*)(h + i));
+            __m256i b = _mm256_loadu_si256((const __m256i*)(h + i - 1));
+            __m256i a = _mm256_loadu_si256((const __m256i*)(h + i + 1));
+            __m256i not_peak = _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_subs_epu8(m, b), zero),
+                                               _mm256_cmpeq_epi8(_mm256_subs_epu8(m, a), zero));
+            __m256i not_valley = _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_subs_epu8(b, m), zero),
+                                                 _mm256_cmpeq_epi8(_mm256_subs_epu8(a, m), zero));
+            extrema += 64 - __builtin_popcount((unsigned)_mm256_movemask_epi8(not_peak))
+                          - __builtin_popcount((unsigned)_mm256_movemask_epi8(not_valley));
+        }
+        w->extrema = (uint8_t)(extrema + scalar_extrema(h, i, samples - 1));
+
+        sums_end(h, samples, w, avx2_sum);
+    }
+}
+
+static int sse2_supported(void) {
+    return __builtin_cpu_supports("sse2");
+}
+
+static int avx2_supported(void) {
+    return __builtin_cpu_supports("avx2");
+}
+
+#endif // KERNELS_X86
+
+#ifdef KERNELS_NEON
+
+// Только функции NEON собираются с fpu=neon: остальной код файла не должен
+// получить инструкции NEON, недоступные на ARMv6
+#ifdef KERNELS_NEON_TARGET
+#pragma GCC push_options
+#pragma GCC target("fpu=neon")
+#endif
+#include <arm_neon.h>
+
+/**
+ * Горизонтальные свертки регистров NEON (без инструкций только AArch64)
+ */
+static inline uint32_t neon_hsum_u16(uint16x8_t v) {
+    uint64x2_t s = vpaddlq_u32(vpaddlq_u16(v));
+    return (uint32_t)(vgetq_lane_u64(s, 0) + vgetq_lane_u64(s, 1));
+}
+
+static inline uint32_t neon_hsum_u32(uint32x4_t v) {
+    uint64x2_t s = vpaddlq_u32(v);
+    return (uint32_t)(vgetq_lane_u64(s, 0) + vgetq_lane_u64(s, 1));
+}
+
+static inline uint8_t neon_hmin(uint8x16_t v) {
+    uint8x8_t m = vmin_u8(vget_low_u8(v), vget_high_u8(v));
+    m = vpmin_u8(m, m);
+    m = vpmin_u8(m, m);
+    m = vpmin_u8(m, m);
+    return vget_lane_u8(m, 0);
+}
+
+static inline uint8_t neon_hmax(uint8x16_t v) {
+    uint8x8_t m = vmax_u8(vget_low_u8(v), vget_high_u8(v));
+    m = vpmax_u8(m, m);
+    m = vpmax_u8(m, m);
+    m = vpmax_u8(m, m);
+    return vget_lane_u8(m, 0);
+}
+
+static uint32_t neon_sum(const uint8_t *h, int from, int to) {
+    uint16x8_t acc = vdupq_n_u16(0);
+    int i = from;
+    for (; i + 16 <= to; i += 16) {
+        acc = vpadalq_u8(acc, vld1q_u8(h + i));
+    }
+    return neon_hsum_u16(acc) + scalar_sum(h, i, to);
+}
+
+/**
+ * NEON: по 16 отсчетов
+ * Счетчики - вычитание масок сравнения (0xFF = -1) в байтовых линиях
+ */
+static void sums_neon(const uint8_t *rows, size_t stride, int samples, int count,
+                      rssi_window_sums_t *out) {
+    const uint8x16_t change = vdupq_n_u8(WINDOW_CHANGE);
+
+    for (int ch = 0; ch < count; ch++) {
+        const uint8_t *h = rows + (size_t)ch * stride;
+        rssi_window_sums_t *w = &out[ch];
+        sums_begin(w, samples);
+
+        uint16x8_t vsum = vdupq_n_u16(0);
+        uint32x4_t vsq = vdupq_n_u32(0);
+        uint8x16_t vmin = vdupq_n_u8(0xFF), vmax = vdupq_n_u8(0);
+        int i = 0;
+        for (; i + 16 <= samples; i += 16) {
+            uint8x16_t x = vld1q_u8(h + i);
+            vsum = vpadalq_u8(vsum, x);
+            vsq = vpadalq_u16(vsq, vmull_u8(vget_low_u8(x), vget_low_u8(x)));
+            vsq = vpadalq_u16(vsq, vmull_u8(vget_high_u8(x), vget_high_u8(x)));
+            vmin = vminq_u8(vmin, x);
+            vmax = vmaxq_u8(vmax, x);
+        }
+        if (i > 0) {
+            w->sum = neon_hsum_u16(vsum);
+            w->sum_sq = neon_hsum_u32(vsq);
+            w->min = neon_hmin(vmin);
+            w->max = neon_hmax(vmax);
+        }
+        scalar_values(h, i, samples, w);
+
+        uint8x16_t changes = vdupq_n_u8(0);
+        for (i = 1; i + 16 <= samples; i += 16) {
+            uint8x16_t diff = vabdq_u8(vld1q_u8(h + i), vld1q_u8(h + i - 1));
+            changes = vsubq_u8(changes, vcgtq_u8(diff, change));
+        }
+        w->changes = (uint8_t)(neon_hsum_u16(vpaddlq_u8(changes)) + scalar_changes(h, i, samples));
+
+        uint8x16_t extrema = vdupq_n_u8(0);
+        for (i = 1; i + 17 <= samples; i += 16) {
+            uint8x16_t m = vld1q_u8(h + i);
+            uint8x16_t b = vld1q_u8(h + i - 1);
+            uint8x16_t a = vld1q_u8(h + i + 1);
+            uint8x16_t peak = vandq_u8(vcgtq_u8(m, b), vcgtq_u8(m, a));
+            uint8x16_t valley = vandq_u8(vcltq_u8(m, b), vcltq_u8(m, a));
+            extrema = vsubq_u8(extrema, vorrq_u8(peak, valley));
+        }
+        w->extrema = (uint8_t)(neon_hsum_u16(vpaddlq_u8(extrema)) + scalar_extrema(h, i, samples - 1));
+
+        sums_end(h, samples, w, neon_sum);
+    }
+}
+
+#ifdef KERNELS_NEON_TARGET
+#pragma GCC pop_options
+#endif
+
+static int neon_supported(void) {
+#if defined(__aarch64__)
+    return 1;
+#else
+    return (getauxval(AT_HWCAP) & HWCAP_NEON) != 0;
+#endif
+}
+
+#endif // KERNELS_NEON
+
+// Реализации в порядке предпочтения при автоматическом выборе
+static const rssi_kernel_t kernels[] = {
+#ifdef KERNELS_X86
+    { "avx2", sums_avx2, avx2_supported },
+    { "sse2", sums_sse2, sse2_supported },
+#endif
+#ifdef KERNELS_NEON
+    { "neon", sums_neon, neon_supported },
+#endif
+    { "scalar", sums_scalar, always_supported },
+};
+
+#define KERNEL_COUNT ((int)(sizeof(kernels) / sizeof(kernels[0])))
+
+/**
+ * Реализация по имени ("auto" - лучшая доступная)
+ * @return NULL если реализация не собрана или недоступна на процессоре
+ */
+static const rssi_kernel_t* find_kernel(const char *name) {
+    int any = strcmp(name, "auto") == 0;
+    for (int i = 0; i < KERNEL_COUNT; i++) {
+        if ((any || strcmp(name, kernels[i].name) == 0) && kernels[i].supported()) {
+            return &kernels[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Выбор реализации по процессору и RSSI_KERNEL из конфигурации
+ */
+static void load_config(void) {
+    char value[16];
+    int count = 0;
+
+    for (int i = 0; i < KERNEL_COUNT; i++) {
+        if (kernels[i].supported()) available[count++] = kernels[i].name;
+    }
+    available[count] = NULL;
+
+    active = find_kernel("auto");
+    if (config_get_value("RSSI_KERNEL", value, sizeof(value)) == 0 && value[0] != '\0') {
+        const rssi_kernel_t *chosen = find_kernel(value);
+        if (chosen) {
+            active = chosen;
+        } else {
+            printf("⚠️ RSSI_KERNEL=%s недоступно, используется %s\n", value, active->name);
+        }
+    }
+}
+
+/**
+ * Суммы окон по матрице отсчетов
+ * @param rows Первая строка (окно первого канала)
+ * @param stride Шаг строк в байтах
+ * @param samples Отсчетов в каждой строке (0-255)
+ * @param count Количество строк
+ * @param out Суммы окон (count элементов)
+ */
+void rssi_window_sums(const uint8_t *rows, size_t stride, int samples, int count,
+                      rssi_window_sums_t *out) {
+    if (!rows || !out || count <= 0) return;
+    if (samples < 0) samples = 0;
+    if (samples > 255) samples = 255;
+
+    pthread_once(&kernel_once, load_config);
+    active->sums(rows, stride, samples, count, out);
+}
+
+/**
+ * Выбор реализации сумм окон
+ * @param name Имя реализации или "auto"
+ * @return 0 при успехе, -1 если реализация недоступна
+ */
+int rssi_kernel_select(const char *name) {
+    pthread_once(&kernel_once, load_config);
+    const rssi_kernel_t *chosen = name ? find_kernel(name) : NULL;
+    if (!chosen) return -1;
+
+    active = chosen;
+    return 0;
+}
+
+/**
+ * Имя выбранной реализации
+ */
+const char* rssi_kernel_name(void) {
+    pthread_once(&kernel_once, load_config);
+    return active->name;
+}
+
+/**
+ * Реализации, доступные на этом процессоре (от предпочтительной)
+ */
+const char* const* rssi_kernel_list(void) {
+    pthread_once(&kernel_once, load_config);
+    return available;
+}
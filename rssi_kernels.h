@@ -0,0 +1,112 @@
+#ifndef RSSI_KERNELS_H
+#define RSSI_KERNELS_H
+
+#include "fpv_interceptor.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Окно признаков: тренд сравнивает новейшие 20% отсчетов со старейшей
+// половиной, изменением считается разница соседних отсчетов больше 5%
+#define WINDOW_RECENT (RSSI_SAMPLES / 5)  // Новейшие отсчеты тренда
+#define WINDOW_OLD    (RSSI_SAMPLES / 2)  // Старейшие отсчеты тренда
+#define WINDOW_CHANGE 5                   // Изменение соседних отсчетов (%)
+
+// Накопленные суммы окна канала - всё, из чего считаются признаки
+typedef struct {
+    uint32_t sum;          // Сумма отсчетов
+    uint32_t sum_sq;       // Сумма квадратов
+    uint32_t recent_sum;   // Сумма WINDOW_RECENT новейших
+    uint32_t old_sum;      // Сумма WINDOW_OLD старейших
+    uint8_t samples;       // Отсчетов в окне
+    uint8_t pairs;         // Соседних пар
+    uint8_t changes;       // Пар с изменением больше WINDOW_CHANGE
+    uint8_t extrema;       // Локальных пиков и провалов
+    uint8_t min;           // Минимум (0 для пустого окна)
+    uint8_t max;           // Максимум
+} rssi_window_sums_t;
+
+/**
+ * Тренд окна: новейшие 20% отсчетов против старейшей половины
+ * @return Тренд (0-100, 50 - без изменения или мало отсчетов)
+ */
+static inline uint8_t rssi_window_trend(uint8_t samples, uint32_t recent_sum, uint32_t old_sum) {
+    if (samples < WINDOW_RECENT + WINDOW_OLD) return 50;
+
+    uint8_t recent_avg = (uint8_t)(recent_sum / WINDOW_RECENT);
+    uint8_t old_avg = (uint8_t)(old_sum / WINDOW_OLD);
+
+    if (recent_avg > old_avg) {
+        return 50 + ((recent_avg - old_avg) * 25) / 100;
+    } else {
+        return 50 - ((old_avg - recent_avg) * 25) / 100;
+    }
+}
+
+/**
+ * Признаки канала по суммам окна (частота не заполняется)
+ */
+static inline void rssi_features_from_sums(const rssi_window_sums_t *w, rssi_features_t *f) {
+    uint8_t samples = w->samples;
+    uint8_t range = samples ? w->max - w->min : 0;
+
+    f->samples = samples;
+    f->mean = samples ? (uint8_t)(w->sum / samples) : 0;
+    f->min = w->min;
+    f->max = w->max;
+    f->range = range;
+    f->trend = rssi_window_trend(samples, w->recent_sum, w->old_sum);
+    f->extrema = w->extrema;
+    f->change_rate = w->pairs ? (uint8_t)((w->changes * 100) / w->pairs) : 0;
+
+    if (samples < 5) {
+        f->stability = 0;
+        f->modulation = 0;
+    } else {
+        f->stability = (range < 20) ? 100 : (range < 40) ? 80 : (range < 60) ? 60 : 40;
+        // FPV имеет характерную глубину модуляции
+        f->modulation = (range > 20 && range < 60) ? 80 :
+                        (range > 10 && range < 80) ? 60 : 40;
+    }
+
+    // FPV сигнал имеет характерную периодичность и частоту изменений
+    f->periodicity = w->extrema >= 10 ? 100 : w->extrema * 10;
+    if (w->pairs < 5) {
+        f->change_score = 0;
+    } else {
+        f->change_score = (f->change_rate > 20 && f->change_rate < 60) ? 80 :
+                          (f->change_rate > 10 && f->change_rate < 80) ? 60 : 40;
+    }
+    f->fpv_score = (uint8_t)((f->periodicity + f->modulation + f->change_score) / 3);
+}
+
+/**
+ * Решение о видеосигнале по RSSI и признакам канала
+ * Комбинированная оценка: уровень 40%, стабильность 30%, характеристики FPV 30%
+ */
+static inline uint8_t rssi_video_detected(uint8_t rssi, const rssi_features_t *f) {
+    uint8_t video_score = (rssi * 40 + f->stability * 30 + f->fpv_score * 30) / 100;
+    return (video_score > 60) ? 1 : 0;
+}
+
+// Суммы окон по матрице отсчетов: строка - окно канала в хронологическом
+// порядке, samples отсчетов (не больше 255), строки через stride байт.
+// Выполняется выбранной реализацией (векторной, если процессор позволяет)
+void rssi_window_sums(const uint8_t *rows, size_t stride, int samples, int count,
+                      rssi_window_sums_t *out);
+
+// Выбор реализации: "auto", "scalar", "sse2", "avx2", "neon"
+// @return 0 при успехе, -1 если реализация недоступна на этом процессоре
+int rssi_kernel_select(const char *name);
+const char* rssi_kernel_name(void);
+
+// Доступные реализации (для бенчмарка), NULL-терминированный список имен
+const char* const* rssi_kernel_list(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RSSI_KERNELS_H
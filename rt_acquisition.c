@@ -0,0 +1,245 @@
+#include "rt_acquisition.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+// Параметры по умолчанию (переопределяются RT_PRIORITY / RT_CPU)
+#define RT_DEFAULT_PRIORITY 80
+#define RT_STACK_PREFAULT   (64 * 1024) // Стек, заранее отображенный в память
+
+// Настройки из конфигурации
+static int config_loaded = 0;
+static int rt_enabled = 0;
+static int rt_priority = RT_DEFAULT_PRIORITY;
+static int rt_cpu = -1;
+
+// Статистика (поля обновляются атомарно, без блокировки в цикле опроса)
+static rt_jitter_stats_t stats;
+
+// 1 в потоках, запущенных rt_thread_create: только их ожидания попадают
+// в гистограмму, ожидания остальных потоков не искажают ее
+static __thread int rt_thread = 0;
+
+// Аргументы запуска потока
+typedef struct {
+    void *(*fn)(void *);
+    void *arg;
+} rt_start_t;
+
+/**
+ * Чтение RT_ACQUISITION, RT_PRIORITY и RT_CPU из конфигурации
+ */
+static void load_config(void) {
+    char value[16];
+
+    if (config_loaded) return;
+    config_loaded = 1;
+
+    if (config_get_value("RT_ACQUISITION", value, sizeof(value)) == 0) {
+        rt_enabled = atoi(value) != 0;
+    }
+    if (config_get_value("RT_PRIORITY", value, sizeof(value)) == 0) {
+        rt_priority = atoi(value);
+    }
+    if (config_get_value("RT_CPU", value, sizeof(value)) == 0) {
+        rt_cpu = atoi(value);
+    }
+
+    int min = sched_get_priority_min(SCHED_FIFO);
+    int max = sched_get_priority_max(SCHED_FIFO);
+    if (rt_priority < min) rt_priority = min;
+    if (rt_priority > max) rt_priority = max;
+
+    // Память процесса блокируется один раз, чтобы опрос не ждал подкачки
+    if (rt_enabled) {
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+            __atomic_store_n(&stats.memory_locked, 1, __ATOMIC_RELAXED);
+        } else {
+            printf("⚠️ mlockall: %s\n", strerror(errno));
+        }
+    }
+}
+
+/**
+ * Запуск пользовательской функции после предварительного
+ * отображения стека (без страничных отказов в цикле опроса)
+ */
+static void* rt_trampoline(void *arg) {
+    rt_start_t start = *(rt_start_t*)arg;
+    free(arg);
+    rt_thread = 1;
+
+    volatile uint8_t prefault[RT_STACK_PREFAULT];
+    memset((void*)prefault, 0, sizeof(prefault));
+
+    return start.fn(start.arg);
+}
+
+/**
+ * Создание потока опроса приемника
+ * @param thread Идентификатор потока
+ * @param fn Функция потока
+ * @param arg Аргумент функции
+ * @param index Номер потока (ядро RT_CPU + index)
+ * @return 0 при успехе, -1 при ошибке
+ */
+int rt_thread_create(pthread_t *thread, void *(*fn)(void *), void *arg, int index) {
+    load_config();
+
+    rt_start_t *start = malloc(sizeof(*start));
+    if (!start) return -1;
+    start->fn = fn;
+    start->arg = arg;
+
+    if (rt_enabled) {
+        pthread_attr_t attr;
+        struct sched_param param;
+
+        pthread_attr_init(&attr);
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = rt_priority;
+        pthread_attr_setschedparam(&attr, &param);
+
+        int cpu = -1;
+        if (rt_cpu >= 0) {
+            long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+            cpu = (int)((rt_cpu + index) % (cpus > 0 ? cpus : 1));
+
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+        }
+
+        int result = pthread_create(thread, &attr, rt_trampoline, start);
+        pthread_attr_destroy(&attr);
+
+        if (result == 0) {
+            __atomic_store_n(&stats.realtime, 1, __ATOMIC_RELAXED);
+            __atomic_store_n(&stats.priority, rt_priority, __ATOMIC_RELAXED);
+            if (index == 0) __atomic_store_n(&stats.cpu, cpu, __ATOMIC_RELAXED);
+            return 0;
+        }
+
+        // Без CAP_SYS_NICE SCHED_FIFO недоступен - работаем обычным потоком
+        printf("⚠️ Поток реального времени недоступен (%s), обычный приоритет\n", strerror(result));
+    }
+
+    if (pthread_create(thread, NULL, rt_trampoline, start) != 0) {
+        free(start);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Номер корзины гистограммы для опоздания
+ */
+static int jitter_bucket(uint64_t late_ns) {
+    uint64_t late_us = late_ns / 1000;
+    int bucket = 0;
+
+    while (bucket < RT_JITTER_BUCKETS - 1 && late_us >= (1ULL << bucket)) {
+        bucket++;
+    }
+    return bucket;
+}
+
+/**
+ * Ожидание абсолютного момента времени
+ * clock_nanosleep с TIMER_ABSTIME не накапливает дрейф между циклами,
+ * а опоздание пробуждения потока опроса попадает в гистограмму.
+ * @param deadline_ns Момент пробуждения по CLOCK_MONOTONIC
+ */
+void rt_sleep_until_ns(uint64_t deadline_ns) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)(deadline_ns / 1000000000ULL);
+    ts.tv_nsec = (long)(deadline_ns % 1000000000ULL);
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+
+    if (!rt_thread) return;
+
+    uint64_t now = get_monotonic_ns();
+    uint64_t late = (now > deadline_ns) ? now - deadline_ns : 0;
+
+    __atomic_fetch_add(&stats.wakeups, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats.late_total_ns, late, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats.histogram[jitter_bucket(late)], 1, __ATOMIC_RELAXED);
+
+    uint64_t max = __atomic_load_n(&stats.late_max_ns, __ATOMIC_RELAXED);
+    while (late > max &&
+           !__atomic_compare_exchange_n(&stats.late_max_ns, &max, late, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+/**
+ * Получение статистики пробуждений
+ * @param out Указатель на структуру статистики
+ */
+void rt_get_jitter_stats(rt_jitter_stats_t *out) {
+    if (!out) return;
+
+    out->realtime = __atomic_load_n(&stats.realtime, __ATOMIC_RELAXED);
+    out->priority = __atomic_load_n(&stats.priority, __ATOMIC_RELAXED);
+    out->cpu = __atomic_load_n(&stats.cpu, __ATOMIC_RELAXED);
+    out->memory_locked = __atomic_load_n(&stats.memory_locked, __ATOMIC_RELAXED);
+    out->wakeups = __atomic_load_n(&stats.wakeups, __ATOMIC_RELAXED);
+    out->late_total_ns = __atomic_load_n(&stats.late_total_ns, __ATOMIC_RELAXED);
+    out->late_max_ns = __atomic_load_n(&stats.late_max_ns, __ATOMIC_RELAXED);
+    for (int i = 0; i < RT_JITTER_BUCKETS; i++) {
+        out->histogram[i] = __atomic_load_n(&stats.histogram[i], __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * Сброс статистики пробуждений (настройки потока сохраняются)
+ */
+void rt_reset_jitter_stats(void) {
+    __atomic_store_n(&stats.wakeups, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&stats.late_total_ns, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&stats.late_max_ns, 0, __ATOMIC_RELAXED);
+    for (int i = 0; i < RT_JITTER_BUCKETS; i++) {
+        __atomic_store_n(&stats.histogram[i], 0, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * Печать гистограммы опоздания пробуждений
+ */
+void rt_print_jitter_stats(void) {
+    rt_jitter_stats_t s;
+    rt_get_jitter_stats(&s);
+
+    if (s.wakeups == 0) return;
+
+    printf("   Поток опроса: %s", s.realtime ? "SCHED_FIFO" : "обычный");
+    if (s.realtime) {
+        printf(" (приоритет %d", s.priority);
+        if (s.cpu >= 0) printf(", ядро %d", s.cpu);
+        printf(")");
+    }
+    printf(", память %s\n", s.memory_locked ? "заблокирована" : "не заблокирована");
+
+    printf("   Опоздание пробуждения: ср. %.1f мкс, макс. %.1f мкс (%llu пробуждений)\n",
+           s.late_total_ns / 1000.0 / s.wakeups, s.late_max_ns / 1000.0,
+           (unsigned long long)s.wakeups);
+
+    for (int i = 0; i < RT_JITTER_BUCKETS; i++) {
+        if (s.histogram[i] == 0) continue;
+        if (i == RT_JITTER_BUCKETS - 1) {
+            printf("     >= %5u мкс: %u\n", 1u << (i - 1), s.histogram[i]);
+        } else {
+            printf("     <  %5u мкс: %u\n", 1u << i, s.histogram[i]);
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef RT_ACQUISITION_H
+#define RT_ACQUISITION_H
+
+#include "fpv_interceptor.h"
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Гистограмма опоздания пробуждения: корзина i - до 2^i мкс
+#define RT_JITTER_BUCKETS 16
+
+typedef struct {
+    int realtime;                          // 1 если поток получил SCHED_FIFO
+    int priority;                          // Приоритет SCHED_FIFO
+    int cpu;                               // Ядро первого потока (-1 без привязки)
+    int memory_locked;                     // 1 если mlockall выполнен
+    uint64_t wakeups;                      // Количество пробуждений
+    uint64_t late_total_ns;                // Суммарное опоздание
+    uint64_t late_max_ns;                  // Максимальное опоздание
+    uint32_t histogram[RT_JITTER_BUCKETS]; // Распределение опозданий
+} rt_jitter_stats_t;
+
+// Поток опроса приемника: SCHED_FIFO, привязка к ядру RT_CPU + index,
+// заблокированная память. Без RT_ACQUISITION=1 или прав - обычный поток.
+int rt_thread_create(pthread_t *thread, void *(*fn)(void *), void *arg, int index);
+
+// Ожидание абсолютного момента CLOCK_MONOTONIC; опоздание учитывается
+// только в потоках rt_thread_create
+void rt_sleep_until_ns(uint64_t deadline_ns);
+
+void rt_get_jitter_stats(rt_jitter_stats_t *out);
+void rt_reset_jitter_stats(void);
+void rt_print_jitter_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RT_ACQUISITION_H
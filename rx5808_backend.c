@@ -0,0 +1,596 @@
+#include "fpv_interceptor.h"
+#include "rx5808_backend.h"
+#include "rt_acquisition.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Аппаратный бэкенд доступен только если rx5808_driver.c слинкован
+#pragma weak rx5808_backend_hw
+
+// Текущее состояние
+static const rx5808_backend_t *backend = NULL;
+static int initialized = 0;
+static int requested_receivers = 0;
+static int receiver_count = 1;
+static uint16_t current_frequency[RX5808_MAX_RECEIVERS];
+
+// Приемник, с которым работает текущий поток
+static __thread int bound_rx = 0;
+
+// Предрасчитанные SPI кадры настройки (частота -> коды регистров)
+#define TUNE_FRAME_COUNT (RX5808_FREQ_MAX - RX5808_FREQ_MIN + 1)
+static uint8_t tune_frames[TUNE_FRAME_COUNT][RX5808_TUNE_FRAME_LEN];
+
+// Теневая копия регистров каждого приемника
+// Бит N в shadow_valid - значение REG N известно
+static uint8_t shadow_regs[RX5808_MAX_RECEIVERS][RX5808_REG_COUNT];
+static uint8_t shadow_valid[RX5808_MAX_RECEIVERS];
+static register_stats_t shadow_stats[RX5808_MAX_RECEIVERS];
+
+/**
+ * Список бэкендов в порядке приоритета по умолчанию
+ */
+static const rx5808_backend_t* backend_at(int index) {
+    switch (index) {
+        case 0: return &rx5808_backend_hw ? &rx5808_backend_hw : NULL;
+        case 1: return &rx5808_backend_spidev;
+        case 2: return &rx5808_backend_stub;
+        case 3: return &rx5808_backend_sim;
+        default: return NULL;
+    }
+}
+
+#define BACKEND_SLOTS 4
+
+/**
+ * Построение таблицы кадров настройки частоты
+ * Для каждого канала заранее формируется полный набор пар
+ * (команда записи | регистр, данные) для REG0..REG7
+ */
+static void build_tune_table(void) {
+    for (int channel = 0; channel < TUNE_FRAME_COUNT; channel++) {
+        uint16_t frequency = RX5808_FREQ_MIN + channel;
+
+        // Конвертация частоты в код RX5808
+        uint32_t freq_code = (frequency - 479) * 2;
+
+        uint8_t regs[RX5808_REG_COUNT] = {0};
+        regs[RX5808_REG_0] = (freq_code >> 8) & 0xFF;
+        regs[RX5808_REG_1] = freq_code & 0xFF;
+
+        for (int reg = 0; reg < RX5808_REG_COUNT; reg++) {
+            tune_frames[channel][reg * 2] = RX5808_CMD_WRITE | reg;
+            tune_frames[channel][reg * 2 + 1] = regs[reg];
+        }
+    }
+}
+
+/**
+ * Кадр настройки частоты (таблица строится в rx5808_init)
+ * @param frequency Частота в МГц (RX5808_FREQ_MIN..RX5808_FREQ_MAX)
+ * @return Кадр длиной RX5808_TUNE_FRAME_LEN
+ */
+const uint8_t* rx5808_tune_frame(uint16_t frequency) {
+    return tune_frames[frequency - RX5808_FREQ_MIN];
+}
+
+/**
+ * Значение уже в регистре по теневой копии (запись пропускается)
+ */
+static int shadow_matches(int rx, uint8_t reg, uint8_t data) {
+    if ((shadow_valid[rx] & (1u << reg)) && shadow_regs[rx][reg] == data) {
+        shadow_stats[rx].writes_elided++;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Запись значения в теневую копию
+ */
+static void shadow_store(int rx, uint8_t reg, uint8_t data) {
+    shadow_regs[rx][reg] = data;
+    shadow_valid[rx] |= 1u << reg;
+}
+
+/**
+ * Сравнение записи с теневой копией и обновление кэша
+ * Кэш обновляется до отправки: при ошибке записи кадра бэкенд сбрасывает
+ * его через rx5808_shadow_invalidate
+ * @return 1 если запись нужно отправить, 0 если значение уже в регистре
+ */
+static int shadow_update(int rx, uint8_t reg, uint8_t data) {
+    if (shadow_matches(rx, reg, data)) return 0;
+
+    shadow_store(rx, reg, data);
+    shadow_stats[rx].writes_issued++;
+    return 1;
+}
+
+/**
+ * Кадр настройки частоты без регистров, значения которых не изменились
+ * Пары (команда | регистр, данные) берутся из предрасчитанной таблицы
+ * @param rx Номер приемника
+ * @param frequency Частота в МГц
+ * @param frame Буфер длиной RX5808_TUNE_FRAME_LEN
+ * @return Длина кадра в байтах (0 если все регистры уже совпадают)
+ */
+int rx5808_shadow_tune_frame(int rx, uint16_t frequency, uint8_t *frame) {
+    const uint8_t *full = tune_frames[frequency - RX5808_FREQ_MIN];
+    int len = 0;
+
+    for (int reg = 0; reg < RX5808_REG_COUNT; reg++) {
+        if (shadow_update(rx, reg, full[reg * 2 + 1])) {
+            frame[len++] = full[reg * 2];
+            frame[len++] = full[reg * 2 + 1];
+        }
+    }
+    return len;
+}
+
+/**
+ * Сброс теневой копии (после сброса приемника или ошибки записи)
+ * @param rx Номер приемника
+ */
+void rx5808_shadow_invalidate(int rx) {
+    if (rx >= 0 && rx < RX5808_MAX_RECEIVERS) {
+        shadow_valid[rx] = 0;
+    }
+}
+
+/**
+ * Статистика теневого кэша регистров по всем приемникам
+ * @param out Указатель на структуру статистики
+ */
+void rx5808_get_register_stats(register_stats_t *out) {
+    if (!out) return;
+
+    memset(out, 0, sizeof(*out));
+    for (int rx = 0; rx < RX5808_MAX_RECEIVERS; rx++) {
+        out->writes_issued += shadow_stats[rx].writes_issued;
+        out->writes_elided += shadow_stats[rx].writes_elided;
+        out->reads += shadow_stats[rx].reads;
+    }
+
+    // Бэкенд без шины (stub, sim) или без счетчика дает только оценку
+    const rx5808_backend_t *b = rx5808_get_backend();
+    if (b && b->bus_bytes) {
+        out->bus_bytes = b->bus_bytes();
+        out->bus_bytes_measured = 1;
+    } else {
+        out->bus_bytes = 2 * (out->writes_issued + out->reads);
+    }
+}
+
+/**
+ * Выбор бэкенда по имени
+ * @param name Имя бэкенда (hw, stub, sim)
+ * @return 0 при успехе, -1 если бэкенд недоступен
+ */
+int rx5808_select_backend(const char *name) {
+    if (!name) return -1;
+
+    if (initialized) {
+        printf("⚠️ Бэкенд нельзя сменить после инициализации RX5808\n");
+        return -1;
+    }
+
+    for (int i = 0; i < BACKEND_SLOTS; i++) {
+        const rx5808_backend_t *candidate = backend_at(i);
+        if (candidate && strcmp(candidate->name, name) == 0) {
+            backend = candidate;
+            printf("📡 Бэкенд приемника: %s (%s)\n", backend->name, backend->description);
+            return 0;
+        }
+    }
+
+    printf("❌ Бэкенд приемника '%s' недоступен\n", name);
+    rx5808_list_backends();
+    return -1;
+}
+
+/**
+ * Запрос количества приемников (до rx5808_init)
+ * @param receivers Количество приемников
+ * @return 0 при успехе, -1 при ошибке
+ */
+int rx5808_set_receiver_count(int receivers) {
+    if (initialized || receivers < 1 || receivers > RX5808_MAX_RECEIVERS) {
+        return -1;
+    }
+    requested_receivers = receivers;
+    return 0;
+}
+
+/**
+ * Выбор бэкенда и числа приемников из командной строки или конфигурации
+ * Поддерживаются --backend=NAME, --backend NAME и --receivers=N,
+ * распознанные опции удаляются из argv. Без опций используются
+ * RECEIVER_BACKEND и RECEIVERS из конфигурационного файла.
+ * @return 0 при успехе, -1 при ошибке
+ */
+int rx5808_select_backend_from_args(int *argc, char **argv) {
+    const char *name = NULL;
+    const char *receivers = NULL;
+
+    for (int i = 1; argc && argv && i < *argc; ) {
+        int consumed = 0;
+
+        if (strncmp(argv[i], "--backend=", 10) == 0) {
+            name = argv[i] + 10;
+            consumed = 1;
+        } else if (strcmp(argv[i], "--backend") == 0 && i + 1 < *argc) {
+            name = argv[i + 1];
+            consumed = 2;
+        } else if (strncmp(argv[i], "--receivers=", 12) == 0) {
+            receivers = argv[i] + 12;
+            consumed = 1;
+        }
+
+        if (!consumed) {
+            i++;
+            continue;
+        }
+
+        for (int j = i; j + consumed <= *argc; j++) {
+            argv[j] = argv[j + consumed];
+        }
+        *argc -= consumed;
+    }
+
+    char config_receivers[16];
+    if (!receivers && config_get_value("RECEIVERS", config_receivers, sizeof(config_receivers)) == 0) {
+        receivers = config_receivers;
+    }
+    if (receivers && rx5808_set_receiver_count(atoi(receivers)) != 0) {
+        printf("❌ Неверное количество приемников: %s (1-%d)\n", receivers, RX5808_MAX_RECEIVERS);
+        return -1;
+    }
+
+    char config_value[32];
+    if (!name && config_get_value("RECEIVER_BACKEND", config_value, sizeof(config_value)) == 0) {
+        name = config_value;
+    }
+
+    if (!name) return 0; // Бэкенд по умолчанию
+    return rx5808_select_backend(name);
+}
+
+/**
+ * Текущий бэкенд (по умолчанию аппаратный, если он слинкован)
+ */
+const rx5808_backend_t* rx5808_get_backend(void) {
+    if (!backend) {
+        backend = backend_at(0) ? backend_at(0) : &rx5808_backend_stub;
+    }
+    return backend;
+}
+
+/**
+ * Печать списка доступных бэкендов
+ */
+void rx5808_list_backends(void) {
+    printf("   Доступные бэкенды:\n");
+    for (int i = 0; i < BACKEND_SLOTS; i++) {
+        const rx5808_backend_t *candidate = backend_at(i);
+        if (candidate) {
+            printf("     %-6s - %s\n", candidate->name, candidate->description);
+        }
+    }
+}
+
+/**
+ * Инициализация RX5808
+ * @return 0 при успехе, -1 при ошибке
+ */
+int rx5808_init(void) {
+    if (initialized) {
+        printf("⚠️ RX5808 уже инициализирован\n");
+        return 0;
+    }
+
+    const rx5808_backend_t *b = rx5808_get_backend();
+    int wanted = requested_receivers > 0 ? requested_receivers : 1;
+    if (wanted > b->max_receivers) {
+        printf("⚠️ Бэкенд %s поддерживает до %d приемников\n", b->name, b->max_receivers);
+        wanted = b->max_receivers;
+    }
+
+    build_tune_table();
+    memset(shadow_valid, 0, sizeof(shadow_valid));
+    memset(shadow_stats, 0, sizeof(shadow_stats));
+
+    int count = b->init(wanted);
+    if (count <= 0) {
+        return -1;
+    }
+
+    rx5808_settle_reset();
+    memset(current_frequency, 0, sizeof(current_frequency));
+    receiver_count = count;
+    initialized = 1;
+    return 0;
+}
+
+/**
+ * Количество активных приемников
+ */
+int rx5808_get_receiver_count(void) {
+    return initialized ? receiver_count : 0;
+}
+
+/**
+ * Привязка текущего потока к приемнику
+ * Все функции rx5808_* в этом потоке будут работать с ним
+ * @param rx Номер приемника
+ */
+void rx5808_bind_receiver(int rx) {
+    if (rx >= 0 && rx < RX5808_MAX_RECEIVERS) {
+        bound_rx = rx;
+    }
+}
+
+/**
+ * Приемник, привязанный к текущему потоку
+ */
+int rx5808_current_receiver(void) {
+    return bound_rx;
+}
+
+/**
+ * Сброс RX5808
+ * @return 0 при успехе, -1 при ошибке
+ */
+int rx5808_reset(void) {
+    current_frequency[bound_rx] = 0; // После сброса предыдущая частота неизвестна
+    rx5808_shadow_invalidate(bound_rx); // И содержимое регистров тоже
+    return rx5808_get_backend()->reset(bound_rx);
+}
+
+/**
+ * Запись регистра RX5808
+ */
+void rx5808_write_register(uint8_t reg, uint8_t data) {
+    int cached = reg < RX5808_REG_COUNT;
+
+    // Запись значения, которое уже есть в регистре, пропускается
+    if (cached && shadow_matches(bound_rx, reg, data)) {
+        return;
+    }
+
+    int result = rx5808_get_backend()->write_register(bound_rx, reg, data);
+    if (!cached) return;
+
+    // Кэш обновляется только после записи, дошедшей до приемника
+    shadow_stats[bound_rx].writes_issued++;
+    if (result == 0) {
+        shadow_store(bound_rx, reg, data);
+    } else {
+        rx5808_shadow_invalidate(bound_rx); // Состояние регистров неизвестно
+    }
+}
+
+/**
+ * Чтение регистра RX5808
+ */
+uint8_t rx5808_read_register(uint8_t reg) {
+    shadow_stats[bound_rx].reads++;
+    return rx5808_get_backend()->read_register(bound_rx, reg);
+}
+
+/**
+ * Установка частоты RX5808
+ * @param frequency Частота в МГц
+ * @return 0 при успехе, -1 при ошибке
+ */
+int rx5808_set_frequency(uint16_t frequency) {
+    if (!initialized) {
+        printf("❌ RX5808 не инициализирован\n");
+        return -1;
+    }
+
+    if (frequency < RX5808_FREQ_MIN || frequency > RX5808_FREQ_MAX) {
+        printf("❌ Частота %d МГц вне диапазона\n", frequency);
+        return -1;
+    }
+
+    if (backend->tune(bound_rx, frequency) != 0) {
+        return -1;
+    }
+
+    // Адаптивное ожидание стабилизации PLL
+    if (backend->has_pll) {
+        rx5808_settle_wait(current_frequency[bound_rx], frequency);
+    }
+    current_frequency[bound_rx] = frequency;
+
+    return 0;
+}
+
+/**
+ * Чтение RSSI
+ * @return Значение RSSI (0-100)
+ */
+uint8_t rx5808_read_rssi(void) {
+    if (!initialized) return 0;
+    shadow_stats[bound_rx].reads++;
+    return backend->read_rssi(bound_rx);
+}
+
+/**
+ * Пакетное чтение RSSI без пауз между отсчетами
+ * @param buf Буфер для отсчетов
+ * @param count Количество отсчетов
+ * @return Количество прочитанных отсчетов
+ */
+int rx5808_read_rssi_burst(uint8_t *buf, int count) {
+    if (!initialized || !buf || count <= 0) return 0;
+
+    if (backend->read_rssi_burst) {
+        int read = backend->read_rssi_burst(bound_rx, buf, count);
+        shadow_stats[bound_rx].reads += read;
+        return read;
+    }
+
+    for (int i = 0; i < count; i++) {
+        buf[i] = backend->read_rssi(bound_rx);
+    }
+    shadow_stats[bound_rx].reads += count;
+    return count;
+}
+
+/**
+ * Пакетное чтение RSSI с отметками времени
+ * Отсчеты снимаются подряд на скорости шины. Если бэкенд читает пакет
+ * целиком, время каждого отсчета интерполируется по длительности пакета.
+ * @param buf Буфер для отсчетов
+ * @param timestamps_ns Время каждого отсчета по rx5808_now_ns (может быть NULL)
+ * @param count Количество отсчетов
+ * @return Количество прочитанных отсчетов
+ */
+int rx5808_read_rssi_burst_ts(uint8_t *buf, uint64_t *timestamps_ns, int count) {
+    if (!initialized || !buf || count <= 0) return 0;
+    if (!timestamps_ns) return rx5808_read_rssi_burst(buf, count);
+
+    if (!backend->read_rssi_burst) {
+        for (int i = 0; i < count; i++) {
+            buf[i] = backend->read_rssi(bound_rx);
+            timestamps_ns[i] = rx5808_now_ns();
+        }
+        shadow_stats[bound_rx].reads += count;
+        return count;
+    }
+
+    uint64_t start = rx5808_now_ns();
+    int read = backend->read_rssi_burst(bound_rx, buf, count);
+    shadow_stats[bound_rx].reads += read;
+    uint64_t span = rx5808_now_ns() - start;
+
+    for (int i = 0; i < read; i++) {
+        timestamps_ns[i] = start + span * (uint64_t)(i + 1) / (uint64_t)read;
+    }
+    return read;
+}
+
+/**
+ * Чтение усредненного RSSI
+ * @param samples Количество образцов
+ * @return Усредненное значение RSSI
+ */
+uint8_t rx5808_read_rssi_averaged(int samples) {
+    if (!initialized || samples <= 0) return 0;
+
+    uint32_t sum = 0;
+    for (int i = 0; i < samples; i++) {
+        sum += backend->read_rssi(bound_rx);
+        rx5808_delay_us(1000); // 1 мс между измерениями
+    }
+    shadow_stats[bound_rx].reads += samples;
+
+    return sum / samples;
+}
+
+/**
+ * Получение информации о RX5808
+ */
+void rx5808_get_info(void) {
+    const rx5808_backend_t *b = rx5808_get_backend();
+
+    printf("📊 Информация о RX5808:\n");
+    printf("   Модель: RX5808 5.8GHz Receiver\n");
+    printf("   Бэкенд: %s (%s)\n", b->name, b->description);
+    printf("   Диапазон: %d-%d МГц\n", RX5808_FREQ_MIN, RX5808_FREQ_MAX);
+    printf("   Статус: %s\n", initialized ? "Активен" : "Не инициализирован");
+    printf("   Приемников: %d\n", rx5808_get_receiver_count());
+
+    register_stats_t regs;
+    rx5808_get_register_stats(&regs);
+    uint64_t writes = regs.writes_issued + regs.writes_elided;
+    if (writes > 0) {
+        printf("   Записи регистров: отправлено %llu, пропущено %llu (%.0f%%)\n",
+               (unsigned long long)regs.writes_issued, (unsigned long long)regs.writes_elided,
+               100.0 * regs.writes_elided / writes);
+    }
+
+    if (b->info) {
+        b->info();
+    }
+}
+
+/**
+ * Текущее время по часам бэкенда
+ * Симулятор работает в виртуальном времени, остальные - в CLOCK_MONOTONIC
+ * @return Время в наносекундах
+ */
+uint64_t rx5808_now_ns(void) {
+    const rx5808_backend_t *b = rx5808_get_backend();
+    return b->now_ns ? b->now_ns(bound_rx) : get_monotonic_ns();
+}
+
+/**
+ * Ожидание по часам бэкенда
+ * @param us Время ожидания в микросекундах
+ */
+void rx5808_delay_us(uint32_t us) {
+    const rx5808_backend_t *b = rx5808_get_backend();
+    if (b->delay_us) {
+        b->delay_us(bound_rx, us);
+    } else if (us > 0) {
+        rt_sleep_until_ns(get_monotonic_ns() + (uint64_t)us * 1000ULL);
+    }
+}
+
+/**
+ * Ожидание абсолютного момента по часам бэкенда
+ * Периодические циклы опроса считают следующий момент от предыдущего,
+ * поэтому задержки обработки не накапливаются в периоде.
+ * @param deadline_ns Момент по rx5808_now_ns
+ */
+void rx5808_sleep_until_ns(uint64_t deadline_ns) {
+    const rx5808_backend_t *b = rx5808_get_backend();
+    if (b->delay_us && b->now_ns) {
+        uint64_t now = b->now_ns(bound_rx);
+        if (deadline_ns > now) {
+            b->delay_us(bound_rx, (uint32_t)((deadline_ns - now) / 1000));
+        }
+    } else {
+        rt_sleep_until_ns(deadline_ns);
+    }
+}
+
+/**
+ * Уведомление бэкенда об обнаружении сигнала
+ * @param frequency Частота обнаружения
+ */
+void rx5808_note_detection(uint16_t frequency) {
+    rx5808_note_detection_at(bound_rx, frequency, rx5808_now_ns());
+}
+
+/**
+ * Уведомление об обнаружении по отсчету, измеренному ранее
+ * Используется потоком анализа, который отстает от приемника
+ * @param rx Приемник, измеривший отсчет
+ * @param frequency Частота обнаружения
+ * @param timestamp_ns Время отсчета по часам приемника
+ */
+void rx5808_note_detection_at(int rx, uint16_t frequency, uint64_t timestamp_ns) {
+    const rx5808_backend_t *b = rx5808_get_backend();
+    if (initialized && b->note_detection && rx >= 0 && rx < RX5808_MAX_RECEIVERS) {
+        b->note_detection(rx, frequency, timestamp_ns);
+    }
+}
+
+/**
+ * Очистка RX5808
+ */
+void rx5808_cleanup(void) {
+    if (!backend) return;
+
+    backend->cleanup();
+    memset(shadow_valid, 0, sizeof(shadow_valid));
+    initialized = 0;
+    receiver_count = 1;
+    memset(current_frequency, 0, sizeof(current_frequency));
+}
@@ -0,0 +1,80 @@
+#ifndef RX5808_BACKEND_H
+#define RX5808_BACKEND_H
+
+#include "fpv_interceptor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// RX5808 регистры
+#define RX5808_REG_0 0x00
+#define RX5808_REG_1 0x01
+#define RX5808_REG_2 0x02
+#define RX5808_REG_3 0x03
+#define RX5808_REG_4 0x04
+#define RX5808_REG_5 0x05
+#define RX5808_REG_6 0x06
+#define RX5808_REG_7 0x07
+#define RX5808_REG_RSSI RX5808_REG_6
+
+// RX5808 команды
+#define RX5808_CMD_READ  0x00
+#define RX5808_CMD_WRITE 0x80
+
+// Пакетная настройка частоты: все 8 регистров одной SPI транзакцией
+#define RX5808_REG_COUNT 8
+#define RX5808_TUNE_FRAME_LEN (RX5808_REG_COUNT * 2)
+
+// Интерфейс бэкенда приемника RX5808
+// Публичные функции rx5808_* перенаправляются в выбранный бэкенд
+typedef struct {
+    const char *name;         // Имя для --backend / RECEIVER_BACKEND
+    const char *description;  // Описание для справки
+    int has_pll;              // 1 если после перестройки нужна стабилизация PLL
+    int max_receivers;        // Максимум независимых приемников
+
+    // Операции получают номер приемника rx (0..receivers-1)
+    int (*init)(int receivers);                      // Возвращает число приемников или -1
+    int (*reset)(int rx);
+    int (*tune)(int rx, uint16_t frequency);         // Запись частоты без ожидания
+    uint8_t (*read_rssi)(int rx);
+    int (*read_rssi_burst)(int rx, uint8_t *buf, int count); // Может быть NULL
+    int (*write_register)(int rx, uint8_t reg, uint8_t data); // 0 при успехе, -1 при ошибке
+    uint8_t (*read_register)(int rx, uint8_t reg);
+    void (*info)(void);                              // Может быть NULL
+    void (*cleanup)(void);
+
+    // Необязательные операции (NULL - реальное время, без учета обнаружений)
+    uint64_t (*now_ns)(int rx);                      // Часы бэкенда
+    void (*delay_us)(int rx, uint32_t us);           // Ожидание по часам бэкенда
+    void (*note_detection)(int rx, uint16_t frequency, uint64_t timestamp_ns); // Учет обнаружения для метрик
+    uint64_t (*bus_bytes)(void);                     // Байт, переданных по SPI (NULL - только оценка)
+} rx5808_backend_t;
+
+// Доступные бэкенды
+extern const rx5808_backend_t rx5808_backend_hw;   // pigpio (только при линковке rx5808_driver.c)
+extern const rx5808_backend_t rx5808_backend_spidev; // Linux spidev + GPIO chardev
+extern const rx5808_backend_t rx5808_backend_stub; // Заглушка со случайным RSSI
+extern const rx5808_backend_t rx5808_backend_sim;  // Детерминированный симулятор
+
+// Выбор бэкенда
+int rx5808_select_backend(const char *name);
+int rx5808_set_receiver_count(int receivers);
+int rx5808_select_backend_from_args(int *argc, char **argv);
+const rx5808_backend_t* rx5808_get_backend(void);
+void rx5808_list_backends(void);
+
+// Предрасчитанный SPI кадр настройки частоты для аппаратных бэкендов
+const uint8_t* rx5808_tune_frame(uint16_t frequency);
+
+// Теневой кэш регистров: кадр настройки только из изменившихся регистров
+// frame - буфер RX5808_TUNE_FRAME_LEN, возвращает длину (0 - запись не нужна)
+int rx5808_shadow_tune_frame(int rx, uint16_t frequency, uint8_t *frame);
+void rx5808_shadow_invalidate(int rx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RX5808_BACKEND_H
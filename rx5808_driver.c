@@ -1,41 +1,69 @@
 #include "fpv_interceptor.h"
+#include "rx5808_backend.h"
 #include <pigpio.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <time.h>
+#include <pthread.h>
 
 // Глобальные переменные
 static int spi_fd = -1;
 static int initialized = 0;
 
-// RX5808 регистры
-#define RX5808_REG_0 0x00
-#define RX5808_REG_1 0x01
-#define RX5808_REG_2 0x02
-#define RX5808_REG_3 0x03
-#define RX5808_REG_4 0x04
-#define RX5808_REG_5 0x05
-#define RX5808_REG_6 0x06
-#define RX5808_REG_7 0x07
+// Приемники на общей шине SPI, у каждого свой CS
+static int cs_pins[RX5808_MAX_RECEIVERS] = {CS_PIN};
+static int receiver_count = 1;
+static pthread_mutex_t bus_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t byte_count = 0; // Байт, переданных spiXfer
 
-// RX5808 команды
-#define RX5808_CMD_READ  0x00
-#define RX5808_CMD_WRITE 0x80
+static int rx5808_write_frame(int rx, const uint8_t *frame, int len);
+static int hw_reset(int rx);
+static int hw_write_register(int rx, uint8_t reg, uint8_t data);
+static uint8_t hw_read_register(int rx, uint8_t reg);
 
 /**
- * Инициализация RX5808
- * @return 0 при успехе, -1 при ошибке
+ * Чтение пинов CS дополнительных приемников из CS_PINS конфигурации
+ * Формат: CS_PINS=8,7,...
+ */
+static void load_cs_pins(int receivers) {
+    char value[64];
+    int count = 0;
+    
+    if (config_get_value("CS_PINS", value, sizeof(value)) == 0) {
+        char *cursor = value;
+        while (*cursor && count < RX5808_MAX_RECEIVERS) {
+            char *end;
+            long pin = strtol(cursor, &end, 10);
+            if (end == cursor) break;
+            cs_pins[count++] = (int)pin;
+            cursor = (*end == ',') ? end + 1 : end;
+        }
+    }
+    
+    if (count == 0) {
+        cs_pins[count++] = CS_PIN;
+    }
+    
+    receiver_count = (receivers < count) ? receivers : count;
+}
+
+/**
+ * Инициализация RX5808 (pigpio)
+ * @param receivers Запрошенное количество приемников
+ * @return Количество инициализированных приемников, -1 при ошибке
  */
-int rx5808_init(void) {
+static int hw_init(int receivers) {
     printf("📡 Инициализация RX5808...\n");
     
     if (initialized) {
         printf("⚠️ RX5808 уже инициализирован\n");
-        return 0;
+        return receiver_count;
     }
     
+    load_cs_pins(receivers);
+    
     // Инициализация pigpio
     if (gpioInitialise() < 0) {
         printf("❌ Ошибка инициализации pigpio\n");
@@ -43,14 +71,18 @@ int rx5808_init(void) {
     }
     
     // Настройка GPIO пинов
-    gpioSetMode(CS_PIN, PI_OUTPUT);
+    for (int rx = 0; rx < receiver_count; rx++) {
+        gpioSetMode(cs_pins[rx], PI_OUTPUT);
+    }
     gpioSetMode(MOSI_PIN, PI_OUTPUT);
     gpioSetMode(MISO_PIN, PI_INPUT);
     gpioSetMode(SCK_PIN, PI_OUTPUT);
     gpioSetMode(RSSI_PIN, PI_INPUT);
     
     // Установка начальных состояний
-    gpioWrite(CS_PIN, 1);  // CS высокий
+    for (int rx = 0; rx < receiver_count; rx++) {
+        gpioWrite(cs_pins[rx], 1);  // CS высокий
+    }
     gpioWrite(MOSI_PIN, 0);
     gpioWrite(SCK_PIN, 0);
     
@@ -62,36 +94,42 @@ int rx5808_init(void) {
         return -1;
     }
     
-    // Сброс RX5808
-    if (rx5808_reset() != 0) {
-        printf("❌ Ошибка сброса RX5808\n");
-        spiClose(spi_fd);
-        gpioTerminate();
-        return -1;
+    // Сброс всех RX5808
+    for (int rx = 0; rx < receiver_count; rx++) {
+        if (hw_reset(rx) != 0) {
+            printf("❌ Ошибка сброса RX5808 #%d\n", rx);
+            spiClose(spi_fd);
+            gpioTerminate();
+            return -1;
+        }
     }
     
     initialized = 1;
-    printf("✅ RX5808 инициализирован\n");
-    return 0;
+    printf("✅ RX5808 инициализирован (приемников: %d)\n", receiver_count);
+    return receiver_count;
 }
 
 /**
  * Сброс RX5808
+ * @param rx Номер приемника
  * @return 0 при успехе, -1 при ошибке
  */
-int rx5808_reset(void) {
-    printf("🔄 Сброс RX5808...\n");
+static int hw_reset(int rx) {
+    printf("🔄 Сброс RX5808 #%d...\n", rx);
     
     // CS низкий
-    gpioWrite(CS_PIN, 0);
+    gpioWrite(cs_pins[rx], 0);
     usleep(1000); // 1 мс
     
     // CS высокий
-    gpioWrite(CS_PIN, 1);
+    gpioWrite(cs_pins[rx], 1);
     usleep(10000); // 10 мс
     
     // Запись регистра 0x00 для сброса
-    rx5808_write_register(RX5808_REG_0, 0x00);
+    if (hw_write_register(rx, RX5808_REG_0, 0x00) != 0) {
+        printf("❌ Ошибка записи регистра RX5808 #%d\n", rx);
+        return -1;
+    }
     usleep(10000); // 10 мс
     
     printf("✅ RX5808 сброшен\n");
@@ -100,29 +138,50 @@ int rx5808_reset(void) {
 
 /**
  * Запись регистра RX5808
+ * @param rx Номер приемника
  * @param reg Номер регистра
  * @param data Данные для записи
+ * @return 0 при успехе, -1 при ошибке (теневой кэш ведет rx5808_write_register)
  */
-void rx5808_write_register(uint8_t reg, uint8_t data) {
-    if (!initialized) return;
-    
+static int hw_write_register(int rx, uint8_t reg, uint8_t data) {
     uint8_t tx_data[2];
     tx_data[0] = RX5808_CMD_WRITE | reg;
     tx_data[1] = data;
     
-    gpioWrite(CS_PIN, 0);
-    spiXfer(spi_fd, (char*)tx_data, NULL, 2);
-    gpioWrite(CS_PIN, 1);
+    return rx5808_write_frame(rx, tx_data, 2);
+}
+
+/**
+ * Запись кадра из нескольких регистров одной SPI транзакцией
+ * Шина общая для всех приемников, поэтому доступ сериализуется
+ * @param rx Номер приемника
+ * @param frame Пары (команда | регистр, данные)
+ * @param len Длина кадра в байтах
+ * @return 0 при успехе, -1 при ошибке
+ */
+static int rx5808_write_frame(int rx, const uint8_t *frame, int len) {
+    if (spi_fd < 0) return -1;
+    
+    pthread_mutex_lock(&bus_mutex);
+    gpioWrite(cs_pins[rx], 0);
+    int sent = spiXfer(spi_fd, (char*)frame, NULL, len);
+    gpioWrite(cs_pins[rx], 1);
+    if (sent > 0) byte_count += sent;
+    pthread_mutex_unlock(&bus_mutex);
     
     usleep(10);
+    
+    // spiXfer возвращает число переданных байт или отрицательный код ошибки
+    return sent == len ? 0 : -1;
 }
 
 /**
  * Чтение регистра RX5808
+ * @param rx Номер приемника
  * @param reg Номер регистра
  * @return Значение регистра
  */
-uint8_t rx5808_read_register(uint8_t reg) {
+static uint8_t hw_read_register(int rx, uint8_t reg) {
     if (!initialized) return 0;
     
     uint8_t tx_data[2];
@@ -131,9 +190,12 @@ uint8_t rx5808_read_register(uint8_t reg) {
     tx_data[0] = RX5808_CMD_READ | reg;
     tx_data[1] = 0x00;
     
-    gpioWrite(CS_PIN, 0);
-    spiXfer(spi_fd, (char*)tx_data, (char*)rx_data, 2);
-    gpioWrite(CS_PIN, 1);
+    pthread_mutex_lock(&bus_mutex);
+    gpioWrite(cs_pins[rx], 0);
+    int received = spiXfer(spi_fd, (char*)tx_data, (char*)rx_data, 2);
+    gpioWrite(cs_pins[rx], 1);
+    if (received > 0) byte_count += received;
+    pthread_mutex_unlock(&bus_mutex);
     
     usleep(10);
     
@@ -142,52 +204,38 @@ uint8_t rx5808_read_register(uint8_t reg) {
 
 /**
  * Установка частоты RX5808
+ * Проверка диапазона и ожидание стабилизации выполняются в rx5808_backend.c
+ * @param rx Номер приемника
  * @param frequency Частота в МГц
  * @return 0 при успехе, -1 при ошибке
  */
-int rx5808_set_frequency(uint16_t frequency) {
-    if (!initialized) {
-        printf("❌ RX5808 не инициализирован\n");
-        return -1;
-    }
-    
-    if (frequency < FREQ_MIN || frequency > FREQ_MAX) {
-        printf("❌ Частота %d МГц вне диапазона\n", frequency);
-        return -1;
-    }
+static int hw_tune(int rx, uint16_t frequency) {
+    if (!initialized) return -1;
     
     // Убираем вывод для GUI режима (слишком много сообщений)
     // printf("📡 Установка частоты: %d МГц\n", frequency);
     
-    // Конвертация частоты в код RX5808
-    uint32_t freq_code = (frequency - 479) * 2;
-    
-    // Запись в регистры RX5808
-    rx5808_write_register(RX5808_REG_0, (freq_code >> 8) & 0xFF);
-    rx5808_write_register(RX5808_REG_1, freq_code & 0xFF);
-    rx5808_write_register(RX5808_REG_2, 0x00);
-    rx5808_write_register(RX5808_REG_3, 0x00);
-    rx5808_write_register(RX5808_REG_4, 0x00);
-    rx5808_write_register(RX5808_REG_5, 0x00);
-    rx5808_write_register(RX5808_REG_6, 0x00);
-    rx5808_write_register(RX5808_REG_7, 0x00);
-    
-    // Ожидание стабилизации
-    usleep(50000); // 50 мс
+    // Запись изменившихся регистров RX5808 одной транзакцией
+    uint8_t frame[RX5808_TUNE_FRAME_LEN];
+    int len = rx5808_shadow_tune_frame(rx, frequency, frame);
+    if (len > 0 && rx5808_write_frame(rx, frame, len) != 0) {
+        rx5808_shadow_invalidate(rx); // Состояние регистров неизвестно
+        return -1;
+    }
     
-    printf("✅ Частота установлена: %d МГц\n", frequency);
     return 0;
 }
 
 /**
  * Чтение RSSI с RX5808
+ * @param rx Номер приемника
  * @return Значение RSSI (0-100)
  */
-uint8_t rx5808_read_rssi(void) {
+static uint8_t hw_read_rssi(int rx) {
     if (!initialized) return 0;
     
     // Чтение RSSI через SPI (регистр 0x06)
-    uint8_t rssi_reg = rx5808_read_register(0x06);
+    uint8_t rssi_reg = hw_read_register(rx, RX5808_REG_RSSI);
     
     // RSSI находится в младших 8 битах
     uint8_t rssi_raw = rssi_reg & 0xFF;
@@ -195,67 +243,39 @@ uint8_t rx5808_read_rssi(void) {
     // Конвертация в проценты (0-100)
     uint8_t rssi_percent = (rssi_raw * 100) / 255;
     
-    // Добавляем небольшую случайность для демонстрации (удалить в продакшене)
-    static int demo_counter = 0;
-    demo_counter++;
-    if (demo_counter % 10 == 0) {
-        // Имитация обнаружения сигнала каждые 10 циклов
-        rssi_percent = 60 + (demo_counter % 40); // 60-99%
-    } else {
-        // Обычный шум
-        rssi_percent = 10 + (demo_counter % 20); // 10-29%
-    }
-    
     return rssi_percent;
 }
 
 /**
- * Чтение усредненного RSSI
- * @param samples Количество образцов
- * @return Усредненное значение RSSI
+ * Аппаратная информация о RX5808
  */
-uint8_t rx5808_read_rssi_averaged(int samples) {
-    if (!initialized || samples <= 0) return 0;
-    
-    uint32_t sum = 0;
-    for (int i = 0; i < samples; i++) {
-        sum += rx5808_read_rssi();
-        usleep(1000); // 1 мс между измерениями
-    }
-    
-    return sum / samples;
-}
-
-/**
- * Получение информации о RX5808
- */
-void rx5808_get_info(void) {
-    printf("📊 Информация о RX5808:\n");
-    printf("   Модель: RX5808 5.8GHz Receiver\n");
-    printf("   Диапазон: %d-%d МГц\n", FREQ_MIN, FREQ_MAX);
+static void hw_info(void) {
     printf("   SPI: /dev/spi0.0 (fd: %d)\n", spi_fd);
-    printf("   GPIO: CS=%d, MOSI=%d, MISO=%d, SCK=%d, RSSI=%d\n", 
-           CS_PIN, MOSI_PIN, MISO_PIN, SCK_PIN, RSSI_PIN);
-    printf("   Статус: %s\n", initialized ? "Активен" : "Не инициализирован");
+    printf("   GPIO: MOSI=%d, MISO=%d, SCK=%d, RSSI=%d\n", 
+           MOSI_PIN, MISO_PIN, SCK_PIN, RSSI_PIN);
     
-    if (initialized) {
-        // Чтение регистров
-        printf("   Регистры:\n");
-        for (int i = 0; i < 8; i++) {
-            uint8_t value = rx5808_read_register(i);
-            printf("     REG%d: 0x%02X\n", i, value);
-        }
+    for (int rx = 0; rx < receiver_count; rx++) {
+        printf("   Приемник #%d: CS=%d\n", rx, cs_pins[rx]);
         
-        // Текущий RSSI
-        uint8_t rssi = rx5808_read_rssi();
-        printf("   Текущий RSSI: %d%%\n", rssi);
+        if (initialized) {
+            // Чтение регистров
+            printf("   Регистры:\n");
+            for (int i = 0; i < 8; i++) {
+                uint8_t value = hw_read_register(rx, i);
+                printf("     REG%d: 0x%02X\n", i, value);
+            }
+            
+            // Текущий RSSI
+            uint8_t rssi = hw_read_rssi(rx);
+            printf("   Текущий RSSI: %d%%\n", rssi);
+        }
     }
 }
 
 /**
  * Очистка RX5808
  */
-void rx5808_cleanup(void) {
+static void hw_cleanup(void) {
     printf("🧹 Очистка RX5808...\n");
     
     if (spi_fd >= 0) {
@@ -266,7 +286,36 @@ void rx5808_cleanup(void) {
     if (initialized) {
         gpioTerminate();
         initialized = 0;
+        byte_count = 0;
     }
     
     printf("✅ RX5808 очищен\n");
 }
+
+/**
+ * Байт, переданных по шине с момента инициализации
+ */
+static uint64_t hw_bus_bytes(void) {
+    pthread_mutex_lock(&bus_mutex);
+    uint64_t bytes = byte_count;
+    pthread_mutex_unlock(&bus_mutex);
+    return bytes;
+}
+
+// Аппаратный бэкенд (pigpio)
+const rx5808_backend_t rx5808_backend_hw = {
+    .name = "hw",
+    .description = "RX5808 через pigpio SPI",
+    .has_pll = 1,
+    .max_receivers = RX5808_MAX_RECEIVERS,
+    .init = hw_init,
+    .reset = hw_reset,
+    .tune = hw_tune,
+    .read_rssi = hw_read_rssi,
+    .read_rssi_burst = NULL,
+    .write_register = hw_write_register,
+    .read_register = hw_read_register,
+    .info = hw_info,
+    .cleanup = hw_cleanup,
+    .bus_bytes = hw_bus_bytes,
+};
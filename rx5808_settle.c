@@ -0,0 +1,169 @@
+#include "fpv_interceptor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+// Параметры детектора стабилизации PLL
+#define SETTLE_MAX_US      50000 // Максимальное ожидание (прежняя фиксированная пауза)
+#define SETTLE_POLL_US     500   // Интервал опроса RSSI
+#define SETTLE_WINDOW      4     // Количество последних отсчетов для проверки сходимости
+#define SETTLE_TOLERANCE   2     // Допустимый разброс RSSI в окне (%)
+
+// Верхние границы групп шага перестройки (МГц)
+static const uint16_t step_bucket_limit[SETTLE_STEP_BUCKETS] = {0, 5, 20, 75, 0xFFFF};
+
+// Состояние калибровки и статистика
+static uint32_t learned_lock_us[SETTLE_STEP_BUCKETS];
+static uint32_t bucket_samples[SETTLE_STEP_BUCKETS];
+static settle_stats_t stats;
+static pthread_mutex_t settle_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Определение группы по величине шага перестройки
+ * @param step_mhz Шаг в МГц
+ * @return Индекс группы
+ */
+static int step_bucket(uint16_t step_mhz) {
+    for (int i = 0; i < SETTLE_STEP_BUCKETS; i++) {
+        if (step_mhz <= step_bucket_limit[i]) {
+            return i;
+        }
+    }
+    return SETTLE_STEP_BUCKETS - 1;
+}
+
+/**
+ * Обновление калибровки времени захвата PLL
+ * Экспоненциальное среднее (1/8) после первых измерений
+ */
+static void update_calibration(int bucket, uint32_t settle_us) {
+    if (bucket_samples[bucket] < 8) {
+        bucket_samples[bucket]++;
+        learned_lock_us[bucket] += ((int32_t)settle_us - (int32_t)learned_lock_us[bucket]) /
+                                   (int32_t)bucket_samples[bucket];
+    } else {
+        learned_lock_us[bucket] += ((int32_t)settle_us - (int32_t)learned_lock_us[bucket]) / 8;
+    }
+}
+
+/**
+ * Сброс калибровки и статистики стабилизации
+ */
+void rx5808_settle_reset(void) {
+    memset(learned_lock_us, 0, sizeof(learned_lock_us));
+    memset(bucket_samples, 0, sizeof(bucket_samples));
+    memset(&stats, 0, sizeof(stats));
+}
+
+/**
+ * Ожидание стабилизации после перестройки частоты
+ * Опрашивает RSSI сразу после настройки и считает канал готовым,
+ * когда последние SETTLE_WINDOW отсчетов сошлись в пределах допуска.
+ * Первый опрос откладывается на половину изученного времени захвата.
+ * @param prev_freq Предыдущая частота (0 если неизвестна)
+ * @param frequency Новая частота
+ * @return Фактическое время ожидания в микросекундах
+ */
+uint32_t rx5808_settle_wait(uint16_t prev_freq, uint16_t frequency) {
+    uint16_t step = (prev_freq == 0) ? 0xFFFF :
+                    (frequency > prev_freq ? frequency - prev_freq : prev_freq - frequency);
+    int bucket = step_bucket(step);
+
+    uint64_t start = rx5808_now_ns();
+
+    // Пропуск заведомо нестабильного участка
+    pthread_mutex_lock(&settle_mutex);
+    uint32_t skip_us = learned_lock_us[bucket] / 2;
+    pthread_mutex_unlock(&settle_mutex);
+    if (skip_us > 0) {
+        rx5808_delay_us(skip_us);
+    }
+
+    uint8_t window[SETTLE_WINDOW];
+    int count = 0;
+    int settled = 0;
+    uint32_t elapsed_us = skip_us;
+
+    while (elapsed_us < SETTLE_MAX_US) {
+        window[count % SETTLE_WINDOW] = rx5808_read_rssi();
+        count++;
+
+        if (count >= SETTLE_WINDOW) {
+            uint8_t min_rssi = 255;
+            uint8_t max_rssi = 0;
+            for (int i = 0; i < SETTLE_WINDOW; i++) {
+                if (window[i] < min_rssi) min_rssi = window[i];
+                if (window[i] > max_rssi) max_rssi = window[i];
+            }
+            if (max_rssi - min_rssi <= SETTLE_TOLERANCE) {
+                settled = 1;
+                elapsed_us = (uint32_t)((rx5808_now_ns() - start) / 1000);
+                break;
+            }
+        }
+
+        rx5808_delay_us(SETTLE_POLL_US);
+        elapsed_us = (uint32_t)((rx5808_now_ns() - start) / 1000);
+    }
+
+    pthread_mutex_lock(&settle_mutex);
+    if (settled) {
+        update_calibration(bucket, elapsed_us);
+    } else {
+        stats.timeouts++;
+    }
+
+    stats.tunes++;
+    stats.settle_us_total += elapsed_us;
+    pthread_mutex_unlock(&settle_mutex);
+    return elapsed_us;
+}
+
+/**
+ * Калибровка времени захвата PLL для всех групп шага
+ * Выполняет серию перестроек с шагами разной величины
+ * @param passes Количество проходов
+ */
+void rx5808_settle_calibrate(int passes) {
+    static const uint16_t steps[SETTLE_STEP_BUCKETS] = {0, 3, 12, 50, 200};
+
+    // Калибровка у нижней границы плана сканирования
+    uint16_t low = scan_plan_get()->freq_min;
+
+    printf("⏱️ Калибровка времени стабилизации RX5808...\n");
+
+    for (int pass = 0; pass < passes; pass++) {
+        for (int i = 0; i < SETTLE_STEP_BUCKETS; i++) {
+            uint16_t base = low + (pass * 7) % 20;
+            uint16_t target = base + steps[i];
+            if (base > RX5808_FREQ_MAX) base = RX5808_FREQ_MAX;
+            if (target > RX5808_FREQ_MAX) target = RX5808_FREQ_MAX;
+
+            rx5808_set_frequency(base);
+            rx5808_set_frequency(target);
+        }
+    }
+
+    for (int i = 0; i < SETTLE_STEP_BUCKETS; i++) {
+        printf("   Шаг <= %5u МГц: %u мкс\n", step_bucket_limit[i], learned_lock_us[i]);
+    }
+}
+
+/**
+ * Получение статистики стабилизации
+ * @param out Указатель на структуру статистики
+ */
+void rx5808_get_settle_stats(settle_stats_t *out) {
+    if (!out) return;
+
+    pthread_mutex_lock(&settle_mutex);
+    *out = stats;
+    memcpy(out->lock_us, learned_lock_us, sizeof(out->lock_us));
+    pthread_mutex_unlock(&settle_mutex);
+
+    // По снимку: глобальные счетчики меняет поток опроса
+    uint64_t baseline_us = (uint64_t)out->tunes * SETTLE_MAX_US;
+    out->saved_ms_total = (baseline_us > out->settle_us_total) ?
+                          (uint32_t)((baseline_us - out->settle_us_total) / 1000) : 0;
+}
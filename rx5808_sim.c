@@ -0,0 +1,432 @@
+#include "fpv_interceptor.h"
+#include "rx5808_backend.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+// Параметры симуляции по умолчанию
+#define SIM_DEFAULT_SEED     1
+#define SIM_NOISE_FLOOR      15    // Уровень шума (%)
+#define SIM_NOISE_SPREAD     2     // Разброс шума (%)
+#define SIM_MAX_TRANSMITTERS 16
+#define SIM_MAX_HOPS         8
+
+// Временная модель приемника (виртуальное время, мкс)
+#define SIM_TUNE_US          40    // Передача кадра настройки
+#define SIM_READ_US          20    // Одно чтение RSSI
+#define SIM_REGISTER_US      20    // Запись или чтение одного регистра
+#define SIM_LOCK_BASE_US     2000  // Захват PLL при нулевом шаге
+#define SIM_LOCK_PER_MHZ_US  40    // Добавка за каждый МГц шага
+#define SIM_LOCK_MAX_US      30000
+
+// Синтетический передатчик
+typedef struct {
+    uint16_t frequency;             // Центральная частота (МГц)
+    uint8_t bandwidth;              // Полуширина по уровню шума (МГц)
+    uint8_t power;                  // Уровень RSSI в центре (%)
+    uint64_t start_us;              // Первое включение
+    uint64_t on_us;                 // Длительность включения (0 - постоянно)
+    uint64_t period_us;             // Период повторения (0 - однократно)
+    uint16_t hops[SIM_MAX_HOPS];    // Частоты перескоков (пусто - без перескоков)
+    int hop_count;
+    uint64_t hop_dwell_us;          // Время на каждой частоте перескока
+
+    // Метрики перехвата
+    uint32_t detected_activations;  // Включения, в которых был обнаружен сигнал
+    int64_t last_detected_activation;
+    uint64_t latency_sum_us;
+    uint64_t latency_max_us;
+} sim_transmitter_t;
+
+// Сценарий по умолчанию: два постоянных, импульсный и прыгающий передатчики
+static const sim_transmitter_t default_scenario[] = {
+    {5740, 8, 75, 0,       0,       0,       {0}, 0, 0, 0, -1, 0, 0},
+    {5800, 8, 90, 500000,  0,       0,       {0}, 0, 0, 0, -1, 0, 0},
+    {5880, 6, 60, 1000000, 2000000, 5000000, {0}, 0, 0, 0, -1, 0, 0},
+    {5917, 6, 70, 0,       0,       0,       {5865, 5917, 5945, 5769}, 4, 3000000, 0, -1, 0, 0},
+};
+
+// Состояние симулированного приемника
+// У каждого приемника свои виртуальные часы и генератор шума,
+// поэтому результат не зависит от чередования потоков
+typedef struct {
+    uint32_t rng_state;
+    uint64_t now_us;
+    uint64_t lock_until_us;
+    uint16_t tuned_frequency;
+    uint8_t registers[8];
+} sim_receiver_t;
+
+// Состояние симулятора
+static sim_transmitter_t transmitters[SIM_MAX_TRANSMITTERS];
+static int transmitter_count = 0;
+static int noise_floor = SIM_NOISE_FLOOR;
+static int noise_spread = SIM_NOISE_SPREAD;
+static uint32_t seed = SIM_DEFAULT_SEED;
+static sim_receiver_t receivers[RX5808_MAX_RECEIVERS];
+static int receiver_count = 1;
+static pthread_mutex_t metrics_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Детерминированный генератор xorshift32
+ */
+static uint32_t sim_random(sim_receiver_t *r) {
+    uint32_t x = r->rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    r->rng_state = x;
+    return x;
+}
+
+/**
+ * Номер текущего включения передатчика
+ * @return Номер включения или -1 если передатчик выключен
+ */
+static int64_t activation_at(const sim_transmitter_t *tx, uint64_t t) {
+    if (t < tx->start_us) return -1;
+
+    uint64_t since = t - tx->start_us;
+    int64_t index = 0;
+
+    if (tx->period_us > 0) {
+        index = (int64_t)(since / tx->period_us);
+        since %= tx->period_us;
+    }
+
+    if (tx->on_us > 0 && since >= tx->on_us) return -1;
+    if (tx->on_us > 0 && tx->period_us == 0 && index > 0) return -1;
+
+    return index;
+}
+
+/**
+ * Начало включения передатчика с заданным номером
+ */
+static uint64_t activation_start(const sim_transmitter_t *tx, int64_t index) {
+    return tx->start_us + (uint64_t)index * tx->period_us;
+}
+
+/**
+ * Текущая частота передатчика с учетом перескоков
+ */
+static uint16_t transmitter_frequency(const sim_transmitter_t *tx, uint64_t t) {
+    if (tx->hop_count <= 0 || tx->hop_dwell_us == 0 || t < tx->start_us) {
+        return tx->frequency;
+    }
+    uint64_t slot = (t - tx->start_us) / tx->hop_dwell_us;
+    return tx->hops[slot % (uint64_t)tx->hop_count];
+}
+
+/**
+ * Загрузка сценария из файла
+ * Формат строк:
+ *   NOISE <уровень> <разброс>
+ *   TX <МГц> <полуширина> <мощность> <старт_мс> <вкл_мс> <период_мс> [<перескок_мс> <МГц>...]
+ * @return 0 при успехе, -1 при ошибке
+ */
+static int load_scenario(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        printf("❌ Не удалось открыть сценарий симулятора: %s\n", path);
+        return -1;
+    }
+
+    char line[256];
+    transmitter_count = 0;
+
+    while (fgets(line, sizeof(line), file)) {
+        int a, b;
+        if (sscanf(line, "NOISE %d %d", &a, &b) == 2) {
+            // Уровень и разброс в процентах RSSI; разброс задает делитель шума
+            if (a < 0 || a > 100) {
+                printf("⚠️ NOISE: уровень %d вне пределов 0-100, используется %d\n", a, noise_floor);
+            } else {
+                noise_floor = a;
+            }
+            if (b < 0 || b > 100) {
+                printf("⚠️ NOISE: разброс %d вне пределов 0-100, используется %d\n", b, noise_spread);
+            } else {
+                noise_spread = b;
+            }
+            continue;
+        }
+
+        unsigned freq, bw, power;
+        unsigned long start_ms, on_ms, period_ms, hop_ms;
+        int consumed = 0;
+        if (sscanf(line, "TX %u %u %u %lu %lu %lu%n",
+                   &freq, &bw, &power, &start_ms, &on_ms, &period_ms, &consumed) != 6 ||
+            transmitter_count >= SIM_MAX_TRANSMITTERS) {
+            continue;
+        }
+
+        sim_transmitter_t *tx = &transmitters[transmitter_count++];
+        memset(tx, 0, sizeof(*tx));
+        tx->frequency = (uint16_t)freq;
+        tx->bandwidth = (uint8_t)(bw ? bw : 1);
+        tx->power = (uint8_t)power;
+        tx->start_us = (uint64_t)start_ms * 1000;
+        tx->on_us = (uint64_t)on_ms * 1000;
+        tx->period_us = (uint64_t)period_ms * 1000;
+        tx->last_detected_activation = -1;
+
+        // Необязательный список перескоков
+        char *rest = line + consumed;
+        int n = 0;
+        if (sscanf(rest, "%lu%n", &hop_ms, &n) == 1) {
+            tx->hop_dwell_us = (uint64_t)hop_ms * 1000;
+            rest += n;
+            unsigned hop;
+            while (tx->hop_count < SIM_MAX_HOPS && sscanf(rest, "%u%n", &hop, &n) == 1) {
+                tx->hops[tx->hop_count++] = (uint16_t)hop;
+                rest += n;
+            }
+        }
+    }
+
+    fclose(file);
+    return 0;
+}
+
+/**
+ * Инициализация симулятора
+ * Зерно берется из SIM_SEED, сценарий из SIM_SCENARIO конфигурации
+ * @param count Количество приемников
+ */
+static int sim_init(int count) {
+    char value[128];
+
+    seed = SIM_DEFAULT_SEED;
+    if (config_get_value("SIM_SEED", value, sizeof(value)) == 0) {
+        seed = (uint32_t)strtoul(value, NULL, 10);
+    }
+    if (seed == 0) seed = SIM_DEFAULT_SEED;
+
+    noise_floor = SIM_NOISE_FLOOR;
+    noise_spread = SIM_NOISE_SPREAD;
+
+    if (config_get_value("SIM_SCENARIO", value, sizeof(value)) == 0) {
+        if (load_scenario(value) != 0) {
+            return -1;
+        }
+    } else {
+        transmitter_count = (int)(sizeof(default_scenario) / sizeof(default_scenario[0]));
+        memcpy(transmitters, default_scenario, sizeof(default_scenario));
+    }
+
+    receiver_count = count;
+    memset(receivers, 0, sizeof(receivers));
+    for (int rx = 0; rx < receiver_count; rx++) {
+        receivers[rx].rng_state = seed + (uint32_t)rx * 0x9E3779B9u;
+        if (receivers[rx].rng_state == 0) receivers[rx].rng_state = SIM_DEFAULT_SEED;
+        receivers[rx].tuned_frequency = scan_plan_get()->freq_min;
+    }
+
+    printf("📡 RX5808 инициализирован (симулятор, seed=%u, передатчиков: %d, приемников: %d)\n",
+           seed, transmitter_count, receiver_count);
+    return receiver_count;
+}
+
+/**
+ * Сброс симулированного приемника
+ */
+static int sim_reset(int rx) {
+    sim_receiver_t *r = &receivers[rx];
+    memset(r->registers, 0, sizeof(r->registers));
+    r->lock_until_us = r->now_us + SIM_LOCK_MAX_US;
+    return 0;
+}
+
+/**
+ * Перестройка симулированного приемника
+ * Время захвата PLL растет с величиной шага
+ */
+static int sim_tune(int rx, uint16_t frequency) {
+    sim_receiver_t *r = &receivers[rx];
+    int step = abs((int)frequency - (int)r->tuned_frequency);
+    uint64_t lock_us = SIM_LOCK_BASE_US + (uint64_t)step * SIM_LOCK_PER_MHZ_US;
+    if (lock_us > SIM_LOCK_MAX_US) lock_us = SIM_LOCK_MAX_US;
+
+    r->now_us += SIM_TUNE_US;
+    r->lock_until_us = r->now_us + lock_us;
+    r->tuned_frequency = frequency;
+
+    uint32_t freq_code = (frequency - 479) * 2;
+    r->registers[0] = (freq_code >> 8) & 0xFF;
+    r->registers[1] = freq_code & 0xFF;
+    return 0;
+}
+
+/**
+ * Чтение RSSI симулятора: шум плюс вклад активных передатчиков
+ * До захвата PLL возвращается случайный уровень
+ */
+static uint8_t sim_read_rssi(int rx) {
+    sim_receiver_t *r = &receivers[rx];
+    r->now_us += SIM_READ_US;
+
+    if (r->now_us < r->lock_until_us) {
+        return (uint8_t)(sim_random(r) % 100);
+    }
+
+    int level = noise_floor - noise_spread / 2 + (int)(sim_random(r) % (uint32_t)(noise_spread + 1));
+
+    for (int i = 0; i < transmitter_count; i++) {
+        const sim_transmitter_t *tx = &transmitters[i];
+        if (activation_at(tx, r->now_us) < 0) continue;
+
+        int offset = abs((int)r->tuned_frequency - (int)transmitter_frequency(tx, r->now_us));
+        if (offset < tx->bandwidth) {
+            // Линейный спад уровня от центра к краю полосы
+            int contribution = tx->power * (tx->bandwidth - offset) / tx->bandwidth;
+            if (contribution > level) {
+                level = contribution;
+            }
+        }
+    }
+
+    if (level < 0) level = 0;
+    return (level > 100) ? 100 : (uint8_t)level;
+}
+
+/**
+ * Запись регистра симулятора
+ */
+static int sim_write_register(int rx, uint8_t reg, uint8_t data) {
+    receivers[rx].now_us += SIM_REGISTER_US;
+    receivers[rx].registers[reg & 0x07] = data;
+    return 0;
+}
+
+/**
+ * Чтение регистра симулятора
+ */
+static uint8_t sim_read_register(int rx, uint8_t reg) {
+    receivers[rx].now_us += SIM_REGISTER_US;
+    return receivers[rx].registers[reg & 0x07];
+}
+
+/**
+ * Виртуальное время приемника
+ */
+static uint64_t sim_now_ns(int rx) {
+    return receivers[rx].now_us * 1000;
+}
+
+/**
+ * Ожидание в виртуальном времени (без реальной задержки)
+ */
+static void sim_delay_us(int rx, uint32_t us) {
+    receivers[rx].now_us += us;
+}
+
+/**
+ * Наибольшее виртуальное время среди приемников
+ */
+static uint64_t sim_elapsed_us(void) {
+    uint64_t elapsed = 0;
+    for (int rx = 0; rx < receiver_count; rx++) {
+        if (receivers[rx].now_us > elapsed) {
+            elapsed = receivers[rx].now_us;
+        }
+    }
+    return elapsed;
+}
+
+/**
+ * Учет обнаружения: сопоставление с активным передатчиком
+ * Задержка считается от начала текущего включения передатчика
+ */
+static void sim_note_detection(int rx, uint16_t frequency, uint64_t timestamp_ns) {
+    (void)rx;
+    uint64_t now_us = timestamp_ns / 1000;
+
+    pthread_mutex_lock(&metrics_mutex);
+    for (int i = 0; i < transmitter_count; i++) {
+        sim_transmitter_t *tx = &transmitters[i];
+        int64_t activation = activation_at(tx, now_us);
+        if (activation < 0 || activation == tx->last_detected_activation) continue;
+
+        int offset = abs((int)frequency - (int)transmitter_frequency(tx, now_us));
+        if (offset >= tx->bandwidth) continue;
+
+        uint64_t latency = now_us - activation_start(tx, activation);
+        tx->last_detected_activation = activation;
+        tx->detected_activations++;
+        tx->latency_sum_us += latency;
+        if (latency > tx->latency_max_us) {
+            tx->latency_max_us = latency;
+        }
+    }
+    pthread_mutex_unlock(&metrics_mutex);
+}
+
+/**
+ * Количество включений передатчика, начавшихся к текущему моменту
+ */
+static uint32_t activations_started(const sim_transmitter_t *tx, uint64_t now_us) {
+    if (now_us < tx->start_us) return 0;
+    if (tx->period_us == 0) return 1;
+    return (uint32_t)((now_us - tx->start_us) / tx->period_us) + 1;
+}
+
+/**
+ * Информация о симуляторе и отчет о перехвате
+ */
+static void sim_info(void) {
+    uint64_t now_us = sim_elapsed_us();
+
+    printf("   Виртуальное время: %.3f с, шум: %d±%d%%\n",
+           now_us / 1e6, noise_floor, noise_spread / 2);
+    for (int rx = 0; rx < receiver_count; rx++) {
+        printf("   Приемник #%d: %d МГц\n", rx, receivers[rx].tuned_frequency);
+    }
+    printf("   Передатчики (вероятность перехвата / задержка обнаружения):\n");
+
+    for (int i = 0; i < transmitter_count; i++) {
+        const sim_transmitter_t *tx = &transmitters[i];
+        uint32_t started = activations_started(tx, now_us);
+
+        printf("     %d МГц%s, %d%%: обнаружено %u/%u",
+               tx->frequency, tx->hop_count > 0 ? " (перескоки)" : "", tx->power,
+               tx->detected_activations, started);
+        if (started > 0) {
+            printf(" (POI %u%%)", tx->detected_activations * 100 / started);
+        }
+        if (tx->detected_activations > 0) {
+            printf(", задержка ср. %llu мс, макс. %llu мс",
+                   (unsigned long long)(tx->latency_sum_us / tx->detected_activations / 1000),
+                   (unsigned long long)(tx->latency_max_us / 1000));
+        }
+        printf("\n");
+    }
+}
+
+/**
+ * Очистка симулятора
+ */
+static void sim_cleanup(void) {
+    printf("🧹 Очистка RX5808 (симулятор)\n");
+}
+
+// Детерминированный симулятор РЧ обстановки в виртуальном времени
+const rx5808_backend_t rx5808_backend_sim = {
+    .name = "sim",
+    .description = "детерминированный симулятор РЧ обстановки",
+    .has_pll = 1,
+    .max_receivers = RX5808_MAX_RECEIVERS,
+    .init = sim_init,
+    .reset = sim_reset,
+    .tune = sim_tune,
+    .read_rssi = sim_read_rssi,
+    .read_rssi_burst = NULL,
+    .write_register = sim_write_register,
+    .read_register = sim_read_register,
+    .info = sim_info,
+    .cleanup = sim_cleanup,
+    .now_ns = sim_now_ns,
+    .delay_us = sim_delay_us,
+    .note_detection = sim_note_detection,
+};
@@ -0,0 +1,447 @@
+#include "fpv_interceptor.h"
+#include "rx5808_backend.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+#include <linux/gpio.h>
+
+// Параметры шины по умолчанию (переопределяются SPI_DEVICE / GPIO_CHIP)
+#define SPIDEV_DEFAULT_DEVICE "/dev/spidev0.0"
+#define SPIDEV_SPEED_HZ       1000000 // 1 МГц, как у pigpio бэкенда
+#define SPIDEV_MAX_BATCH      32      // Передач в одном SPI_IOC_MESSAGE
+
+// Состояние шины
+static int spi_fd = -1;
+static int gpio_cs = 0;  // 1 - CS через GPIO chardev, 0 - аппаратный CS spidev
+static int initialized = 0;
+static int receiver_count = 1;
+static char spi_device[64] = SPIDEV_DEFAULT_DEVICE;
+static char gpio_chip[64] = "";
+static pthread_mutex_t bus_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Линии CS приемников (дескрипторы из GPIO_GET_LINEHANDLE_IOCTL)
+static int cs_pins[RX5808_MAX_RECEIVERS] = {CS_PIN};
+// (заполняются -1 при инициализации); открыто cs_count первых линий
+static int cs_fds[RX5808_MAX_RECEIVERS];
+static int cs_count = 0;
+
+// Статистика системных вызовов
+static uint64_t ioctl_count = 0;
+static uint64_t transfer_count = 0;
+static uint64_t byte_count = 0;
+static uint64_t init_us = 0;
+
+static int spidev_write_register(int rx, uint8_t reg, uint8_t data);
+
+/**
+ * Чтение пинов CS из CS_PINS конфигурации
+ * Формат: CS_PINS=8,7,...
+ * @return Количество пинов
+ */
+static int load_cs_pins(void) {
+    char value[64];
+    int count = 0;
+
+    if (config_get_value("CS_PINS", value, sizeof(value)) == 0) {
+        char *cursor = value;
+        while (*cursor && count < RX5808_MAX_RECEIVERS) {
+            char *end;
+            long pin = strtol(cursor, &end, 10);
+            if (end == cursor) break;
+            cs_pins[count++] = (int)pin;
+            cursor = (*end == ',') ? end + 1 : end;
+        }
+    }
+
+    if (count == 0) {
+        cs_pins[count++] = CS_PIN;
+    }
+    return count;
+}
+
+/**
+ * Установка уровня линии CS через GPIO chardev
+ * @return 0 при успехе, -1 при ошибке
+ */
+static int set_cs(int rx, int level) {
+    struct gpiohandle_data data;
+    memset(&data, 0, sizeof(data));
+    data.values[0] = level;
+    return ioctl(cs_fds[rx], GPIOHANDLE_SET_LINE_VALUES_IOCTL, &data) < 0 ? -1 : 0;
+}
+
+/**
+ * Запрос линий CS у GPIO контроллера (выход, начальный уровень высокий)
+ * @return 0 при успехе, -1 при ошибке
+ */
+static int open_cs_lines(int receivers) {
+    int chip_fd = open(gpio_chip, O_RDWR | O_CLOEXEC);
+    if (chip_fd < 0) {
+        printf("❌ Ошибка открытия %s\n", gpio_chip);
+        return -1;
+    }
+
+    for (int rx = 0; rx < receivers; rx++) {
+        struct gpiohandle_request request;
+        memset(&request, 0, sizeof(request));
+        request.lineoffsets[0] = cs_pins[rx];
+        request.lines = 1;
+        request.flags = GPIOHANDLE_REQUEST_OUTPUT;
+        request.default_values[0] = 1;  // CS высокий
+        snprintf(request.consumer_label, sizeof(request.consumer_label), "rx5808-cs%d", rx);
+
+        if (ioctl(chip_fd, GPIO_GET_LINEHANDLE_IOCTL, &request) < 0) {
+            printf("❌ Ошибка запроса GPIO%d для CS приемника #%d\n", cs_pins[rx], rx);
+            close(chip_fd);
+            return -1;
+        }
+        cs_fds[rx] = request.fd;
+        cs_count = rx + 1;
+    }
+
+    // Дескрипторы линий остаются действительными после закрытия контроллера
+    close(chip_fd);
+    return 0;
+}
+
+/**
+ * Закрытие линий CS
+ */
+static void close_cs_lines(void) {
+    for (int rx = 0; rx < cs_count; rx++) {
+        if (cs_fds[rx] >= 0) {
+            close(cs_fds[rx]);
+            cs_fds[rx] = -1;
+        }
+    }
+    cs_count = 0;
+}
+
+/**
+ * Выполнение набора передач одним системным вызовом
+ * При аппаратном CS окна передач задает cs_change вызывающего; при GPIO CS
+ * линия опускается до ioctl и поднимается после него, и все передачи идут
+ * в одном окне CS
+ * @param rx Номер приемника
+ * @param xfers Передачи
+ * @param count Количество передач (не больше SPIDEV_MAX_BATCH)
+ * @return 0 при успехе, -1 при ошибке
+ */
+static int spidev_message(int rx, struct spi_ioc_transfer *xfers, int count) {
+    if (spi_fd < 0 || count <= 0) return -1;
+
+    uint32_t bytes = 0;
+    for (int i = 0; i < count; i++) {
+        xfers[i].speed_hz = SPIDEV_SPEED_HZ;
+        xfers[i].bits_per_word = 8;
+        bytes += xfers[i].len;
+    }
+
+    pthread_mutex_lock(&bus_mutex);
+    int result = -1;
+    if (!gpio_cs || set_cs(rx, 0) == 0) {
+        result = ioctl(spi_fd, SPI_IOC_MESSAGE(count), xfers);
+    }
+
+    // Учитываются только передачи, выполненные ядром
+    if (result >= 0) {
+        ioctl_count++;
+        transfer_count += count;
+        byte_count += bytes;
+    }
+
+    // CS поднимается в любом случае; ошибка подъема - ошибка передачи
+    if (gpio_cs && set_cs(rx, 1) != 0) result = -1;
+    pthread_mutex_unlock(&bus_mutex);
+
+    return (result < 0) ? -1 : 0;
+}
+
+/**
+ * Инициализация RX5808 (spidev)
+ * Без GPIO_CHIP используется аппаратный CS устройства spidev
+ * и поддерживается один приемник.
+ * @param receivers Запрошенное количество приемников
+ * @return Количество инициализированных приемников, -1 при ошибке
+ */
+static int spidev_init(int receivers) {
+    printf("📡 Инициализация RX5808 (spidev)...\n");
+
+    if (initialized) {
+        printf("⚠️ RX5808 уже инициализирован\n");
+        return receiver_count;
+    }
+
+    uint64_t start = get_monotonic_ns();
+
+    // Все линии закрыты при любом RX5808_MAX_RECEIVERS
+    for (int rx = 0; rx < RX5808_MAX_RECEIVERS; rx++) {
+        cs_fds[rx] = -1;
+    }
+    cs_count = 0;
+
+    config_get_value("SPI_DEVICE", spi_device, sizeof(spi_device));
+    gpio_cs = (config_get_value("GPIO_CHIP", gpio_chip, sizeof(gpio_chip)) == 0);
+
+    int pins = load_cs_pins();
+    receiver_count = gpio_cs ? (receivers < pins ? receivers : pins) : 1;
+    if (!gpio_cs && receivers > 1) {
+        printf("⚠️ Без GPIO_CHIP доступен только аппаратный CS (1 приемник)\n");
+    }
+
+    spi_fd = open(spi_device, O_RDWR | O_CLOEXEC);
+    if (spi_fd < 0) {
+        printf("❌ Ошибка открытия %s\n", spi_device);
+        return -1;
+    }
+
+    // Режим 0, 8 бит; при GPIO CS аппаратный CS отключается
+    uint32_t mode = SPI_MODE_0 | (gpio_cs ? SPI_NO_CS : 0);
+    uint8_t bits = 8;
+    uint32_t speed = SPIDEV_SPEED_HZ;
+    if (ioctl(spi_fd, SPI_IOC_WR_MODE32, &mode) < 0 ||
+        ioctl(spi_fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0 ||
+        ioctl(spi_fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) < 0) {
+        printf("❌ Ошибка настройки %s\n", spi_device);
+        close(spi_fd);
+        spi_fd = -1;
+        return -1;
+    }
+
+    if (gpio_cs && open_cs_lines(receiver_count) != 0) {
+        close_cs_lines();
+        close(spi_fd);
+        spi_fd = -1;
+        return -1;
+    }
+
+    initialized = 1;
+    init_us = (get_monotonic_ns() - start) / 1000;
+
+    // Сброс всех RX5808
+    for (int rx = 0; rx < receiver_count; rx++) {
+        spidev_write_register(rx, RX5808_REG_0, 0x00);
+    }
+    usleep(10000); // 10 мс
+
+    printf("✅ RX5808 инициализирован (spidev, приемников: %d, %llu мкс)\n",
+           receiver_count, (unsigned long long)init_us);
+    return receiver_count;
+}
+
+/**
+ * Сброс RX5808
+ * @param rx Номер приемника
+ * @return 0 при успехе, -1 при ошибке
+ */
+static int spidev_reset(int rx) {
+    printf("🔄 Сброс RX5808 #%d...\n", rx);
+
+    if (gpio_cs) {
+        pthread_mutex_lock(&bus_mutex);
+        int low = set_cs(rx, 0);
+        usleep(1000); // 1 мс
+        int high = set_cs(rx, 1);
+        pthread_mutex_unlock(&bus_mutex);
+        if (low != 0 || high != 0) {
+            printf("❌ Ошибка управления CS приемника #%d\n", rx);
+            return -1;
+        }
+        usleep(10000); // 10 мс
+    }
+
+    if (spidev_write_register(rx, RX5808_REG_0, 0x00) != 0) {
+        printf("❌ Ошибка записи регистра RX5808 #%d\n", rx);
+        return -1;
+    }
+    usleep(10000); // 10 мс
+
+    printf("✅ RX5808 сброшен\n");
+    return 0;
+}
+
+/**
+ * Запись регистра RX5808
+ * @return 0 при успехе, -1 при ошибке (теневой кэш ведет rx5808_write_register)
+ */
+static int spidev_write_register(int rx, uint8_t reg, uint8_t data) {
+    uint8_t tx_data[2] = {RX5808_CMD_WRITE | reg, data};
+    struct spi_ioc_transfer xfer;
+
+    memset(&xfer, 0, sizeof(xfer));
+    xfer.tx_buf = (unsigned long)tx_data;
+    xfer.len = sizeof(tx_data);
+
+    return spidev_message(rx, &xfer, 1);
+}
+
+/**
+ * Чтение регистра RX5808
+ */
+static uint8_t spidev_read_register(int rx, uint8_t reg) {
+    if (!initialized) return 0;
+
+    uint8_t tx_data[2] = {RX5808_CMD_READ | reg, 0x00};
+    uint8_t rx_data[2] = {0};
+    struct spi_ioc_transfer xfer;
+
+    memset(&xfer, 0, sizeof(xfer));
+    xfer.tx_buf = (unsigned long)tx_data;
+    xfer.rx_buf = (unsigned long)rx_data;
+    xfer.len = sizeof(tx_data);
+
+    if (spidev_message(rx, &xfer, 1) != 0) {
+        return 0;
+    }
+    return rx_data[1];
+}
+
+/**
+ * Установка частоты: изменившиеся регистры одним ioctl
+ */
+static int spidev_tune(int rx, uint16_t frequency) {
+    if (!initialized) return -1;
+
+    uint8_t frame[RX5808_TUNE_FRAME_LEN];
+    int len = rx5808_shadow_tune_frame(rx, frequency, frame);
+    if (len == 0) return 0;
+
+    struct spi_ioc_transfer xfer;
+    memset(&xfer, 0, sizeof(xfer));
+    xfer.tx_buf = (unsigned long)frame;
+    xfer.len = len;
+
+    if (spidev_message(rx, &xfer, 1) != 0) {
+        rx5808_shadow_invalidate(rx); // Состояние регистров неизвестно
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Конвертация сырого значения регистра RSSI в проценты
+ */
+static uint8_t rssi_percent(uint8_t raw) {
+    return (raw * 100) / 255;
+}
+
+/**
+ * Чтение RSSI
+ */
+static uint8_t spidev_read_rssi(int rx) {
+    return rssi_percent(spidev_read_register(rx, RX5808_REG_RSSI));
+}
+
+/**
+ * Пакетное чтение RSSI: до SPIDEV_MAX_BATCH чтений на один ioctl
+ * RX5808 защелкивает команду по фронту CS, поэтому каждое чтение идет в
+ * своем окне CS. Аппаратный CS поднимается между передачами (cs_change),
+ * кроме последней: cs_change на последней передаче оставил бы CS опущенным
+ * после сообщения. GPIO CS внутри сообщения переключить нельзя, и с ним
+ * каждое чтение - отдельный ioctl.
+ * @return Количество прочитанных отсчетов
+ */
+static int spidev_read_rssi_burst(int rx, uint8_t *buf, int count) {
+    if (!initialized) return 0;
+
+    static const uint8_t tx_data[2] = {RX5808_CMD_READ | RX5808_REG_RSSI, 0x00};
+    struct spi_ioc_transfer xfers[SPIDEV_MAX_BATCH];
+    uint8_t rx_data[SPIDEV_MAX_BATCH][2];
+    int max_batch = gpio_cs ? 1 : SPIDEV_MAX_BATCH;
+    int done = 0;
+
+    while (done < count) {
+        int batch = count - done;
+        if (batch > max_batch) batch = max_batch;
+
+        memset(xfers, 0, sizeof(xfers[0]) * batch);
+        for (int i = 0; i < batch; i++) {
+            xfers[i].tx_buf = (unsigned long)tx_data;
+            xfers[i].rx_buf = (unsigned long)rx_data[i];
+            xfers[i].len = sizeof(tx_data);
+            xfers[i].cs_change = i < batch - 1; // CS поднимается между чтениями
+        }
+
+        if (spidev_message(rx, xfers, batch) != 0) {
+            break;
+        }
+
+        for (int i = 0; i < batch; i++) {
+            buf[done + i] = rssi_percent(rx_data[i][1]);
+        }
+        done += batch;
+    }
+
+    return done;
+}
+
+/**
+ * Информация о шине spidev
+ */
+static void spidev_info(void) {
+    printf("   SPI: %s (fd: %d, %d Гц)\n", spi_device, spi_fd, SPIDEV_SPEED_HZ);
+    printf("   CS: %s\n", gpio_cs ? gpio_chip : "аппаратный CS spidev");
+    for (int rx = 0; rx < receiver_count; rx++) {
+        if (gpio_cs) {
+            printf("   Приемник #%d: CS=GPIO%d\n", rx, cs_pins[rx]);
+        }
+    }
+    printf("   Инициализация: %llu мкс\n", (unsigned long long)init_us);
+
+    pthread_mutex_lock(&bus_mutex);
+    printf("   ioctl: %llu, передач: %llu (%.1f на вызов), байт: %llu\n",
+           (unsigned long long)ioctl_count, (unsigned long long)transfer_count,
+           ioctl_count ? (double)transfer_count / ioctl_count : 0.0,
+           (unsigned long long)byte_count);
+    pthread_mutex_unlock(&bus_mutex);
+}
+
+/**
+ * Очистка RX5808 (spidev)
+ */
+static void spidev_cleanup(void) {
+    printf("🧹 Очистка RX5808 (spidev)...\n");
+
+    close_cs_lines();
+    if (spi_fd >= 0) {
+        close(spi_fd);
+        spi_fd = -1;
+    }
+
+    initialized = 0;
+    ioctl_count = transfer_count = byte_count = 0;
+    printf("✅ RX5808 очищен\n");
+}
+
+/**
+ * Байт, переданных по шине с момента инициализации
+ */
+static uint64_t spidev_bus_bytes(void) {
+    pthread_mutex_lock(&bus_mutex);
+    uint64_t bytes = byte_count;
+    pthread_mutex_unlock(&bus_mutex);
+    return bytes;
+}
+
+// Бэкенд Linux spidev (без pigpio и root)
+const rx5808_backend_t rx5808_backend_spidev = {
+    .name = "spidev",
+    .description = "RX5808 через /dev/spidev и GPIO chardev",
+    .has_pll = 1,
+    .max_receivers = RX5808_MAX_RECEIVERS,
+    .init = spidev_init,
+    .reset = spidev_reset,
+    .tune = spidev_tune,
+    .read_rssi = spidev_read_rssi,
+    .read_rssi_burst = spidev_read_rssi_burst,
+    .write_register = spidev_write_register,
+    .read_register = spidev_read_register,
+    .info = spidev_info,
+    .cleanup = spidev_cleanup,
+    .bus_bytes = spidev_bus_bytes,
+};
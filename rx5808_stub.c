@@ -1,4 +1,5 @@
 #include "fpv_interceptor.h"
+#include "rx5808_backend.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -6,15 +7,16 @@
 /**
  * Инициализация RX5808 (заглушка)
  */
-int rx5808_init(void) {
-    printf("📡 RX5808 инициализирован (заглушка)\n");
-    return 0;
+static int stub_init(int receivers) {
+    printf("📡 RX5808 инициализирован (заглушка, приемников: %d)\n", receivers);
+    return receivers;
 }
 
 /**
  * Сброс RX5808 (заглушка)
  */
-int rx5808_reset(void) {
+static int stub_reset(int rx) {
+    (void)rx;
     printf("🔄 RX5808 сброс (заглушка)\n");
     return 0;
 }
@@ -22,14 +24,17 @@ int rx5808_reset(void) {
 /**
  * Запись регистра RX5808 (заглушка)
  */
-void rx5808_write_register(uint8_t reg, uint8_t data) {
+static int stub_write_register(int rx, uint8_t reg, uint8_t data) {
+    (void)rx;
     printf("📝 Запись регистра RX5808: 0x%02X = 0x%02X (заглушка)\n", reg, data);
+    return 0;
 }
 
 /**
  * Чтение регистра RX5808 (заглушка)
  */
-uint8_t rx5808_read_register(uint8_t reg) {
+static uint8_t stub_read_register(int rx, uint8_t reg) {
+    (void)rx;
     printf("📖 Чтение регистра RX5808: 0x%02X (заглушка)\n", reg);
     return 0x00;
 }
@@ -37,7 +42,8 @@ uint8_t rx5808_read_register(uint8_t reg) {
 /**
  * Установка частоты RX5808 (заглушка)
  */
-int rx5808_set_frequency(uint16_t frequency) {
+static int stub_tune(int rx, uint16_t frequency) {
+    (void)rx;
     printf("📡 Установка частоты RX5808: %d МГц (заглушка)\n", frequency);
     return 0;
 }
@@ -45,32 +51,39 @@ int rx5808_set_frequency(uint16_t frequency) {
 /**
  * Чтение RSSI RX5808 (заглушка)
  */
-uint8_t rx5808_read_rssi(void) {
+static uint8_t stub_read_rssi(int rx) {
+    (void)rx;
     // Возвращаем случайный RSSI для демонстрации
     return 30 + (rand() % 40); // 30-70%
 }
 
 /**
- * Чтение усредненного RSSI (заглушка)
+ * Информация о RX5808 (заглушка)
  */
-uint8_t rx5808_read_rssi_averaged(int samples) {
-    printf("📊 Чтение усредненного RSSI: %d образцов (заглушка)\n", samples);
-    return rx5808_read_rssi();
-}
-
-/**
- * Получение информации о RX5808 (заглушка)
- */
-void rx5808_get_info(void) {
-    printf("📊 Информация о RX5808 (заглушка):\n");
-    printf("   Модель: RX5808 5.8GHz Receiver\n");
-    printf("   Диапазон: 5725-6000 МГц\n");
+static void stub_info(void) {
     printf("   Статус: Заглушка (без реального оборудования)\n");
 }
 
 /**
  * Очистка RX5808 (заглушка)
  */
-void rx5808_cleanup(void) {
+static void stub_cleanup(void) {
     printf("🧹 Очистка RX5808 (заглушка)\n");
 }
+
+// Бэкенд-заглушка
+const rx5808_backend_t rx5808_backend_stub = {
+    .name = "stub",
+    .description = "заглушка со случайным RSSI",
+    .has_pll = 0,
+    .max_receivers = RX5808_MAX_RECEIVERS,
+    .init = stub_init,
+    .reset = stub_reset,
+    .tune = stub_tune,
+    .read_rssi = stub_read_rssi,
+    .read_rssi_burst = NULL,
+    .write_register = stub_write_register,
+    .read_register = stub_read_register,
+    .info = stub_info,
+    .cleanup = stub_cleanup,
+};
@@ -0,0 +1,324 @@
+#include "scan_pipeline.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/**
+ * Конвейер сканирования: приемник -> анализ -> вывод
+ * Поток приемника только перестраивается и читает RSSI, а анализ канала N
+ * и вывод обнаружений идут в отдельных потоках, пока приемник уже ждет
+ * стабилизации PLL на канале N+1. Очереди между этапами ограничены
+ * PIPELINE_QUEUE_DEPTH: если анализ не успевает, приемник ждет, а не
+ * теряет отсчеты.
+ */
+
+// Ограниченная блокирующая очередь между этапами
+typedef struct {
+    scan_result_t items[PIPELINE_QUEUE_DEPTH];
+    int head;
+    int count;
+    int closed;
+    uint32_t max_depth;
+    pthread_mutex_t mutex;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+} stage_queue_t;
+
+static stage_queue_t analysis_queue;
+static stage_queue_t output_queue;
+static pthread_t analysis_thread;
+static pthread_t output_thread;
+static int threaded = 0;
+
+static scan_analyze_fn analyze_fn = NULL;
+static scan_report_fn report_fn = NULL;
+
+// Отсчеты, еще не прошедшие все этапы
+static uint64_t pending = 0;
+static pthread_mutex_t pending_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t drained = PTHREAD_COND_INITIALIZER;
+
+static pipeline_stats_t stats;
+static pthread_mutex_t stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void queue_init(stage_queue_t *q) {
+    q->head = 0;
+    q->count = 0;
+    q->closed = 0;
+    q->max_depth = 0;
+    pthread_mutex_init(&q->mutex, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    pthread_cond_init(&q->not_full, NULL);
+}
+
+static void queue_destroy(stage_queue_t *q) {
+    pthread_mutex_destroy(&q->mutex);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_cond_destroy(&q->not_full);
+}
+
+/**
+ * Добавление в очередь с ожиданием свободного места
+ * @return Время ожидания в наносекундах
+ */
+static uint64_t queue_push(stage_queue_t *q, const scan_result_t *item) {
+    uint64_t waited = 0;
+
+    pthread_mutex_lock(&q->mutex);
+    if (q->count == PIPELINE_QUEUE_DEPTH) {
+        uint64_t start = get_monotonic_ns();
+        while (q->count == PIPELINE_QUEUE_DEPTH) {
+            pthread_cond_wait(&q->not_full, &q->mutex);
+        }
+        waited = get_monotonic_ns() - start;
+    }
+
+    q->items[(q->head + q->count) % PIPELINE_QUEUE_DEPTH] = *item;
+    q->count++;
+    if ((uint32_t)q->count > q->max_depth) q->max_depth = q->count;
+
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->mutex);
+    return waited;
+}
+
+/**
+ * Извлечение из очереди
+ * @return 0 при успехе, -1 если очередь закрыта и пуста
+ */
+static int queue_pop(stage_queue_t *q, scan_result_t *item) {
+    pthread_mutex_lock(&q->mutex);
+    while (q->count == 0 && !q->closed) {
+        pthread_cond_wait(&q->not_empty, &q->mutex);
+    }
+
+    if (q->count == 0) {
+        pthread_mutex_unlock(&q->mutex);
+        return -1;
+    }
+
+    *item = q->items[q->head];
+    q->head = (q->head + 1) % PIPELINE_QUEUE_DEPTH;
+    q->count--;
+
+    pthread_cond_signal(&q->not_full);
+    pthread_mutex_unlock(&q->mutex);
+    return 0;
+}
+
+static void queue_close(stage_queue_t *q) {
+    pthread_mutex_lock(&q->mutex);
+    q->closed = 1;
+    pthread_cond_broadcast(&q->not_empty);
+    pthread_mutex_unlock(&q->mutex);
+}
+
+/**
+ * Отметка отсчета, прошедшего все этапы
+ */
+static void sample_done(void) {
+    pthread_mutex_lock(&pending_mutex);
+    if (--pending == 0) {
+        pthread_cond_broadcast(&drained);
+    }
+    pthread_mutex_unlock(&pending_mutex);
+}
+
+/**
+ * Выполнение этапа анализа (в потоке анализа или в потоке приемника)
+ * @return 1 если отсчет нужно передать на вывод
+ */
+static int run_analysis(scan_result_t *sample) {
+    uint64_t start = get_monotonic_ns();
+    int forward = analyze_fn ? analyze_fn(sample) : 0;
+    uint64_t elapsed = get_monotonic_ns() - start;
+
+    pthread_mutex_lock(&stats_mutex);
+    stats.analysis_ns += elapsed;
+    if (forward) stats.reported++;
+    pthread_mutex_unlock(&stats_mutex);
+    return forward;
+}
+
+static void run_report(const scan_result_t *sample) {
+    uint64_t start = get_monotonic_ns();
+    if (report_fn) report_fn(sample);
+    uint64_t elapsed = get_monotonic_ns() - start;
+
+    pthread_mutex_lock(&stats_mutex);
+    stats.output_ns += elapsed;
+    pthread_mutex_unlock(&stats_mutex);
+}
+
+/**
+ * Поток анализа
+ */
+static void* analysis_main(void *arg) {
+    (void)arg;
+    scan_result_t sample;
+
+    while (queue_pop(&analysis_queue, &sample) == 0) {
+        if (run_analysis(&sample)) {
+            queue_push(&output_queue, &sample);
+        } else {
+            sample_done();
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Поток вывода
+ */
+static void* output_main(void *arg) {
+    (void)arg;
+    scan_result_t sample;
+
+    while (queue_pop(&output_queue, &sample) == 0) {
+        run_report(&sample);
+        sample_done();
+    }
+    return NULL;
+}
+
+/**
+ * Запуск конвейера
+ * @param analyze Функция этапа анализа
+ * @param report Функция этапа вывода
+ * @param threads 1 - анализ и вывод в отдельных потоках, 0 - в потоке приемника
+ * @return 0 при успехе, -1 если потоки не запущены (этапы идут в потоке приемника)
+ */
+int scan_pipeline_start(scan_analyze_fn analyze, scan_report_fn report, int threads) {
+    if (threaded) return 0;
+
+    analyze_fn = analyze;
+    report_fn = report;
+    pending = 0;
+    memset(&stats, 0, sizeof(stats));
+
+    if (!threads) return 0;
+
+    queue_init(&analysis_queue);
+    queue_init(&output_queue);
+
+    if (pthread_create(&analysis_thread, NULL, analysis_main, NULL) != 0) {
+        printf("⚠️ Поток анализа не запущен, конвейер работает последовательно\n");
+        return -1;
+    }
+    if (pthread_create(&output_thread, NULL, output_main, NULL) != 0) {
+        printf("⚠️ Поток вывода не запущен, конвейер работает последовательно\n");
+        queue_close(&analysis_queue);
+        pthread_join(analysis_thread, NULL);
+        return -1;
+    }
+
+    threaded = 1;
+    stats.threaded = 1;
+    return 0;
+}
+
+/**
+ * Передача отсчета от приемника
+ * @param sample Измеренный отсчет
+ */
+void scan_pipeline_submit(const scan_result_t *sample) {
+    pthread_mutex_lock(&stats_mutex);
+    stats.submitted++;
+    pthread_mutex_unlock(&stats_mutex);
+
+    if (!threaded) {
+        scan_result_t copy = *sample;
+        if (run_analysis(&copy)) {
+            run_report(&copy);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&pending_mutex);
+    pending++;
+    pthread_mutex_unlock(&pending_mutex);
+
+    uint64_t waited = queue_push(&analysis_queue, sample);
+    if (waited > 0) {
+        pthread_mutex_lock(&stats_mutex);
+        stats.stall_ns += waited;
+        stats.stalls++;
+        pthread_mutex_unlock(&stats_mutex);
+    }
+}
+
+/**
+ * Ожидание обработки всех переданных отсчетов
+ * Вызывается в конце обхода, когда нужны результаты анализа
+ */
+void scan_pipeline_flush(void) {
+    if (!threaded) return;
+
+    pthread_mutex_lock(&pending_mutex);
+    while (pending > 0) {
+        pthread_cond_wait(&drained, &pending_mutex);
+    }
+    pthread_mutex_unlock(&pending_mutex);
+}
+
+/**
+ * Остановка конвейера: оставшиеся отсчеты обрабатываются до выхода потоков
+ */
+void scan_pipeline_stop(void) {
+    if (!threaded) return;
+
+    queue_close(&analysis_queue);
+    pthread_join(analysis_thread, NULL);
+    queue_close(&output_queue);
+    pthread_join(output_thread, NULL);
+
+    queue_destroy(&analysis_queue);
+    queue_destroy(&output_queue);
+    threaded = 0;
+}
+
+/**
+ * Получение статистики конвейера
+ * @param out Указатель на структуру статистики
+ */
+void scan_pipeline_get_stats(pipeline_stats_t *out) {
+    if (!out) return;
+
+    pthread_mutex_lock(&stats_mutex);
+    *out = stats;
+    pthread_mutex_unlock(&stats_mutex);
+
+    if (threaded) {
+        pthread_mutex_lock(&analysis_queue.mutex);
+        out->analysis_max_depth = analysis_queue.max_depth;
+        pthread_mutex_unlock(&analysis_queue.mutex);
+
+        pthread_mutex_lock(&output_queue.mutex);
+        out->output_max_depth = output_queue.max_depth;
+        pthread_mutex_unlock(&output_queue.mutex);
+    }
+}
+
+/**
+ * Печать статистики конвейера
+ */
+void scan_pipeline_print_stats(void) {
+    pipeline_stats_t s;
+    scan_pipeline_get_stats(&s);
+
+    if (s.submitted == 0) return;
+
+    printf("   Конвейер: %s, отсчетов %llu, на вывод %llu\n",
+           s.threaded ? "анализ и вывод в отдельных потоках" : "последовательно",
+           (unsigned long long)s.submitted, (unsigned long long)s.reported);
+    printf("   Анализ: ср. %.1f мкс, вывод: ср. %.1f мкс на отсчет%s\n",
+           s.analysis_ns / 1000.0 / s.submitted,
+           s.reported ? s.output_ns / 1000.0 / s.reported : 0.0,
+           s.threaded ? " (параллельно с перестройкой)" : "");
+    if (s.threaded) {
+        printf("   Очереди: анализ до %u, вывод до %u из %d; ожидание приемника %.1f мс (%u раз)\n",
+               s.analysis_max_depth, s.output_max_depth, PIPELINE_QUEUE_DEPTH,
+               s.stall_ns / 1e6, s.stalls);
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef SCAN_PIPELINE_H
+#define SCAN_PIPELINE_H
+
+#include "fpv_interceptor.h"
+#include "scan_queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Глубина очередей между этапами конвейера
+#define PIPELINE_QUEUE_DEPTH 64
+
+// Этап анализа: вызывается в потоке анализа для каждого отсчета;
+// 1 - передать отсчет на этап вывода, 0 - отсчет обработан
+typedef int (*scan_analyze_fn)(scan_result_t *sample);
+
+// Этап вывода: обнаружения, журнал и статус в отдельном потоке
+typedef void (*scan_report_fn)(const scan_result_t *sample);
+
+typedef struct {
+    uint64_t submitted;          // Отсчетов передано приемником
+    uint64_t reported;           // Отсчетов передано на вывод
+    uint64_t analysis_ns;        // Время этапа анализа (скрыто от приемника)
+    uint64_t output_ns;          // Время этапа вывода (скрыто от приемника)
+    uint64_t stall_ns;           // Ожидание приемника на заполненной очереди
+    uint32_t stalls;             // Количество таких ожиданий
+    uint32_t analysis_max_depth; // Наибольшая глубина очереди анализа
+    uint32_t output_max_depth;   // Наибольшая глубина очереди вывода
+    int threaded;                // 0 если этапы выполняются в потоке приемника
+} pipeline_stats_t;
+
+// Запуск конвейера; threads = 0 - этапы выполняются в потоке приемника
+// (бэкенд с виртуальным временем, где анализ времени не занимает)
+int scan_pipeline_start(scan_analyze_fn analyze, scan_report_fn report, int threads);
+
+// Передача отсчета; при заполненной очереди ждет освобождения места
+void scan_pipeline_submit(const scan_result_t *sample);
+
+// Ожидание обработки всех переданных отсчетов
+void scan_pipeline_flush(void);
+
+void scan_pipeline_stop(void);
+void scan_pipeline_get_stats(pipeline_stats_t *out);
+void scan_pipeline_print_stats(void);
+
+// Наблюдатель отсчетов сканера (frequency_scanner_fixed.c), например GUI:
+// получает каждый отсчет после этапа вывода и отсчеты сопровождения.
+// Вызывается из одного потока в каждый момент времени: сопровождение
+// начинается после вывода всех отсчетов обхода
+void scan_set_observer(scan_report_fn observer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SCAN_PIPELINE_H
@@ -0,0 +1,347 @@
+#include "fpv_interceptor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/**
+ * План сканирования
+ * Диапазоны обхода, шаг, пауза на частоте, пороги обнаружения и
+ * исключенные частоты читаются из config/fpv_config.conf при запуске,
+ * поэтому план настраивается под место установки без пересборки:
+ *
+ *   SCAN_RANGES=5725-5866:1:100:50,5867-6000:2:50:60
+ *   SCAN_EXCLUDE=5790-5795,5960
+ *
+ * Диапазон - НАЧАЛО-КОНЕЦ[:шаг[:пауза мс[:порог %]]]; пропущенные поля
+ * берутся из FREQ_STEP, SCAN_DWELL_TIME и RSSI_THRESHOLD. Без SCAN_RANGES
+ * план - один диапазон FREQ_MIN-FREQ_MAX. Если диапазоны перекрываются,
+ * пауза и порог частоты берутся из первого диапазона, в который она входит.
+ *
+ * Таблицы каналов анализатора, сканера и планировщика выделяются по охвату
+ * плана: канал - частота минус freq_min.
+ */
+
+// Параметры частоты в охвате плана
+typedef struct {
+    int8_t range;      // Первый диапазон, содержащий частоту (-1 - вне диапазонов)
+    uint8_t excluded;  // Частота исключена маской
+    int position;      // Позиция в полном обходе (-1 - не обходится)
+} plan_channel_t;
+
+static scan_plan_t plan;
+static plan_channel_t *table = NULL;
+static uint16_t *sweep = NULL;  // Частоты полного обхода по возрастанию
+static int load_result = 0;
+static pthread_once_t load_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Чтение числового параметра конфигурации с проверкой пределов
+ */
+static int config_get_int(const char *key, int def, int min, int max) {
+    char value[32];
+
+    if (config_get_value(key, value, sizeof(value)) != 0) return def;
+
+    int parsed = atoi(value);
+    if (parsed < min || parsed > max) {
+        printf("⚠️ %s=%s вне пределов %d-%d, используется %d\n", key, value, min, max, def);
+        return def;
+    }
+    return parsed;
+}
+
+/**
+ * Проверка диапазона плана
+ * @return 0 если диапазон допустим, -1 иначе
+ */
+static int validate_range(const scan_range_t *range) {
+    if (range->start < RX5808_FREQ_MIN || range->end > RX5808_FREQ_MAX || range->start > range->end) {
+        return -1;
+    }
+    if (range->step == 0 || range->step > 100) return -1;
+    if (range->threshold == 0 || range->threshold > 100) return -1;
+    if (range->dwell_ms > 10000) return -1;
+    return 0;
+}
+
+/**
+ * Разбор диапазона НАЧАЛО-КОНЕЦ[:шаг[:пауза мс[:порог %]]]
+ * @param text Текст диапазона
+ * @param defaults Значения пропущенных полей
+ * @param out Разобранный диапазон
+ * @return 0 при успехе, -1 при ошибке
+ */
+static int parse_range(const char *text, const scan_range_t *defaults, scan_range_t *out) {
+    unsigned start, end;
+    unsigned step = defaults->step;
+    unsigned dwell = defaults->dwell_ms;
+    unsigned threshold = defaults->threshold;
+
+    int fields = sscanf(text, "%u-%u:%u:%u:%u", &start, &end, &step, &dwell, &threshold);
+    if (fields < 2 || start > 0xFFFF || end > 0xFFFF || step > 0xFFFF || dwell > 0xFFFF || threshold > 0xFF) {
+        return -1;
+    }
+
+    out->start = (uint16_t)start;
+    out->end = (uint16_t)end;
+    out->step = (uint16_t)step;
+    out->dwell_ms = (uint16_t)dwell;
+    out->threshold = (uint8_t)threshold;
+    return validate_range(out);
+}
+
+/**
+ * Разбор списка диапазонов SCAN_RANGES
+ */
+static void parse_ranges(const char *value, const scan_range_t *defaults) {
+    char buffer[512];
+    char *save = NULL;
+
+    strncpy(buffer, value, sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = '\0';
+
+    for (char *item = strtok_r(buffer, ",", &save); item; item = strtok_r(NULL, ",", &save)) {
+        scan_range_t range;
+
+        if (parse_range(item, defaults, &range) != 0) {
+            printf("⚠️ Неверный диапазон плана сканирования: %s\n", item);
+            load_result = -1;
+            continue;
+        }
+        if (plan.range_count >= SCAN_PLAN_MAX_RANGES) {
+            printf("⚠️ Диапазонов больше %d, лишние пропущены\n", SCAN_PLAN_MAX_RANGES);
+            load_result = -1;
+            break;
+        }
+        plan.ranges[plan.range_count++] = range;
+    }
+}
+
+/**
+ * Разбор списка исключений SCAN_EXCLUDE: частоты и диапазоны через запятую
+ */
+static void parse_excludes(const char *value) {
+    char buffer[512];
+    char *save = NULL;
+
+    strncpy(buffer, value, sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = '\0';
+
+    for (char *item = strtok_r(buffer, ",", &save); item; item = strtok_r(NULL, ",", &save)) {
+        unsigned start, end;
+        int fields = sscanf(item, "%u-%u", &start, &end);
+
+        if (fields == 1) end = start;
+        if (fields < 1 || start > end || end > 0xFFFF) {
+            printf("⚠️ Неверное исключение плана сканирования: %s\n", item);
+            load_result = -1;
+            continue;
+        }
+        if (plan.exclude_count >= SCAN_PLAN_MAX_EXCLUDES) {
+            printf("⚠️ Исключений больше %d, лишние пропущены\n", SCAN_PLAN_MAX_EXCLUDES);
+            load_result = -1;
+            break;
+        }
+        plan.exclude_start[plan.exclude_count] = (uint16_t)start;
+        plan.exclude_end[plan.exclude_count] = (uint16_t)end;
+        plan.exclude_count++;
+    }
+}
+
+/**
+ * Построение таблицы каналов и списка полного обхода
+ */
+static void build_tables(void) {
+    plan.freq_min = plan.ranges[0].start;
+    plan.freq_max = plan.ranges[0].end;
+    for (int r = 1; r < plan.range_count; r++) {
+        if (plan.ranges[r].start < plan.freq_min) plan.freq_min = plan.ranges[r].start;
+        if (plan.ranges[r].end > plan.freq_max) plan.freq_max = plan.ranges[r].end;
+    }
+    plan.channel_count = plan.freq_max - plan.freq_min + 1;
+
+    table = calloc(plan.channel_count, sizeof(*table));
+    sweep = calloc(plan.channel_count, sizeof(*sweep));
+    if (!table || !sweep) {
+        printf("❌ Недостаточно памяти для плана сканирования\n");
+        exit(1);
+    }
+
+    plan.frequency_count = 0;
+    for (int channel = 0; channel < plan.channel_count; channel++) {
+        uint16_t frequency = plan.freq_min + channel;
+        plan_channel_t *entry = &table[channel];
+        int on_grid = 0;
+
+        entry->range = -1;
+        entry->position = -1;
+
+        for (int r = 0; r < plan.range_count; r++) {
+            const scan_range_t *range = &plan.ranges[r];
+            if (frequency < range->start || frequency > range->end) continue;
+
+            if (entry->range < 0) entry->range = (int8_t)r;
+            if ((frequency - range->start) % range->step == 0) on_grid = 1;
+        }
+
+        for (int e = 0; e < plan.exclude_count; e++) {
+            if (frequency >= plan.exclude_start[e] && frequency <= plan.exclude_end[e]) {
+                entry->excluded = 1;
+                break;
+            }
+        }
+
+        if (on_grid && !entry->excluded) {
+            entry->position = plan.frequency_count;
+            sweep[plan.frequency_count++] = frequency;
+        }
+    }
+}
+
+/**
+ * Загрузка плана (один раз за запуск)
+ */
+static void load_plan(void) {
+    char value[512];
+    scan_range_t defaults;
+
+    memset(&plan, 0, sizeof(plan));
+
+    // Значения по умолчанию для всего плана и пропущенных полей диапазонов
+    defaults.start = (uint16_t)config_get_int("FREQ_MIN", SCAN_DEFAULT_FREQ_MIN, RX5808_FREQ_MIN, RX5808_FREQ_MAX);
+    defaults.end = (uint16_t)config_get_int("FREQ_MAX", SCAN_DEFAULT_FREQ_MAX, RX5808_FREQ_MIN, RX5808_FREQ_MAX);
+    defaults.step = (uint16_t)config_get_int("FREQ_STEP", SCAN_DEFAULT_STEP, 1, 100);
+    defaults.dwell_ms = (uint16_t)config_get_int("SCAN_DWELL_TIME", SCAN_DEFAULT_DWELL_MS, 0, 10000);
+    defaults.threshold = (uint8_t)config_get_int("RSSI_THRESHOLD", SCAN_DEFAULT_THRESHOLD, 1, 100);
+
+    if (defaults.start > defaults.end) {
+        printf("⚠️ FREQ_MIN больше FREQ_MAX, используется %d-%d МГц\n",
+               SCAN_DEFAULT_FREQ_MIN, SCAN_DEFAULT_FREQ_MAX);
+        defaults.start = SCAN_DEFAULT_FREQ_MIN;
+        defaults.end = SCAN_DEFAULT_FREQ_MAX;
+        load_result = -1;
+    }
+
+    plan.threshold = defaults.threshold;
+    plan.dwell_ms = defaults.dwell_ms;
+
+    if (config_get_value("SCAN_RANGES", value, sizeof(value)) == 0 && value[0] != '\0') {
+        parse_ranges(value, &defaults);
+    }
+    if (plan.range_count == 0) {
+        plan.ranges[plan.range_count++] = defaults;
+    }
+
+    if (config_get_value("SCAN_EXCLUDE", value, sizeof(value)) == 0 && value[0] != '\0') {
+        parse_excludes(value);
+    }
+
+    build_tables();
+}
+
+/**
+ * Загрузка плана сканирования из конфигурации
+ * План читается один раз за запуск: таблицы каналов модулей выделяются
+ * по его охвату. Ошибочные записи пропускаются с предупреждением.
+ * @return 0 при успехе, -1 если в конфигурации были ошибки
+ */
+int scan_plan_load(void) {
+    pthread_once(&load_once, load_plan);
+    return load_result;
+}
+
+/**
+ * Активный план сканирования (загружается при первом обращении)
+ */
+const scan_plan_t* scan_plan_get(void) {
+    scan_plan_load();
+    return &plan;
+}
+
+/**
+ * Номер канала частоты в таблицах, выделенных по охвату плана
+ * @param frequency Частота в МГц
+ * @return Номер канала или -1 если частота вне охвата
+ */
+int scan_plan_channel(uint16_t frequency) {
+    scan_plan_load();
+    if (frequency < plan.freq_min || frequency > plan.freq_max) return -1;
+    return frequency - plan.freq_min;
+}
+
+/**
+ * Проверка, что частота входит в диапазон плана и не исключена
+ * Шаг диапазона не учитывается (уточнение вокруг сигнала идет по 1 МГц)
+ */
+int scan_plan_allows(uint16_t frequency) {
+    int channel = scan_plan_channel(frequency);
+    return channel >= 0 && table[channel].range >= 0 && !table[channel].excluded;
+}
+
+/**
+ * Позиция частоты в полном обходе
+ * @return Позиция (0..frequency_count-1) или -1 если частота не обходится
+ */
+int scan_plan_position(uint16_t frequency) {
+    int channel = scan_plan_channel(frequency);
+    return channel >= 0 ? table[channel].position : -1;
+}
+
+/**
+ * Порог RSSI обнаружения на частоте
+ */
+uint8_t scan_plan_threshold(uint16_t frequency) {
+    int channel = scan_plan_channel(frequency);
+    if (channel < 0 || table[channel].range < 0) return plan.threshold;
+    return plan.ranges[table[channel].range].threshold;
+}
+
+/**
+ * Пауза на частоте при обходе по плану (мс)
+ */
+uint16_t scan_plan_dwell(uint16_t frequency) {
+    int channel = scan_plan_channel(frequency);
+    if (channel < 0 || table[channel].range < 0) return plan.dwell_ms;
+    return plan.ranges[table[channel].range].dwell_ms;
+}
+
+/**
+ * Частоты полного обхода в пределах [start_freq, end_freq]
+ * @param out Выходной массив (по возрастанию частоты)
+ * @param max Размер массива
+ * @return Количество частот
+ */
+int scan_plan_frequencies(uint16_t start_freq, uint16_t end_freq, uint16_t *out, int max) {
+    int count = 0;
+
+    scan_plan_load();
+    for (int i = 0; i < plan.frequency_count && count < max; i++) {
+        if (sweep[i] >= start_freq && sweep[i] <= end_freq) {
+            out[count++] = sweep[i];
+        }
+    }
+    return count;
+}
+
+/**
+ * Печать плана сканирования
+ */
+void scan_plan_print(void) {
+    scan_plan_load();
+
+    printf("📋 План сканирования: %d-%d МГц, частот в обходе %d\n",
+           plan.freq_min, plan.freq_max, plan.frequency_count);
+    for (int r = 0; r < plan.range_count; r++) {
+        const scan_range_t *range = &plan.ranges[r];
+        printf("   %d-%d МГц: шаг %u МГц, пауза %u мс, порог %u%%\n",
+               range->start, range->end, range->step, range->dwell_ms, range->threshold);
+    }
+    for (int e = 0; e < plan.exclude_count; e++) {
+        if (plan.exclude_start[e] == plan.exclude_end[e]) {
+            printf("   Исключено: %d МГц\n", plan.exclude_start[e]);
+        } else {
+            printf("   Исключено: %d-%d МГц\n", plan.exclude_start[e], plan.exclude_end[e]);
+        }
+    }
+}
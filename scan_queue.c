@@ -0,0 +1,54 @@
+#include "scan_queue.h"
+#include <string.h>
+
+#define SCAN_QUEUE_MASK (SCAN_QUEUE_CAPACITY - 1)
+
+/**
+ * Инициализация очереди результатов
+ */
+void scan_queue_init(scan_queue_t *queue) {
+    memset(queue, 0, sizeof(*queue));
+}
+
+/**
+ * Добавление результата (только поток-производитель)
+ * При переполнении результат отбрасывается: сканер не ждет GUI
+ * @return 0 при успехе, -1 если очередь заполнена
+ */
+int scan_queue_push(scan_queue_t *queue, const scan_result_t *result) {
+    uint32_t tail = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+    uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+
+    if (tail - head >= SCAN_QUEUE_CAPACITY) {
+        __atomic_fetch_add(&queue->dropped, 1, __ATOMIC_RELAXED);
+        return -1;
+    }
+
+    queue->items[tail & SCAN_QUEUE_MASK] = *result;
+    __atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+/**
+ * Извлечение результата (только поток-потребитель)
+ * @return 0 при успехе, -1 если очередь пуста
+ */
+int scan_queue_pop(scan_queue_t *queue, scan_result_t *result) {
+    uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+    uint32_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+
+    if (head == tail) {
+        return -1;
+    }
+
+    *result = queue->items[head & SCAN_QUEUE_MASK];
+    __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+/**
+ * Количество отброшенных результатов
+ */
+uint32_t scan_queue_dropped(scan_queue_t *queue) {
+    return __atomic_load_n(&queue->dropped, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,42 @@
+#ifndef SCAN_QUEUE_H
+#define SCAN_QUEUE_H
+
+#include "fpv_interceptor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Емкость очереди результатов (степень двойки)
+#define SCAN_QUEUE_CAPACITY 1024
+
+// Результат измерения одного канала
+typedef struct {
+    uint16_t frequency;     // Частота (МГц)
+    uint8_t rssi;           // RSSI (0-100)
+    uint8_t detected;       // 1 если превышен порог
+    uint8_t receiver;       // Приемник, измеривший отсчет
+    uint8_t tracking;       // 1 если отсчет получен при сопровождении сигнала
+    uint32_t cycle;         // Номер цикла сканирования
+    uint64_t timestamp_ns;  // Время измерения (часы приемника)
+} scan_result_t;
+
+// Очередь без блокировок для одного производителя и одного потребителя
+// Индексы разнесены по строкам кэша, чтобы потоки не делили одну строку
+typedef struct {
+    scan_result_t items[SCAN_QUEUE_CAPACITY];
+    uint32_t head __attribute__((aligned(64)));  // Пишет только потребитель
+    uint32_t tail __attribute__((aligned(64)));  // Пишет только производитель
+    uint32_t dropped;                            // Результаты, не поместившиеся в очередь
+} scan_queue_t;
+
+void scan_queue_init(scan_queue_t *queue);
+int scan_queue_push(scan_queue_t *queue, const scan_result_t *result);
+int scan_queue_pop(scan_queue_t *queue, scan_result_t *result);
+uint32_t scan_queue_dropped(scan_queue_t *queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SCAN_QUEUE_H
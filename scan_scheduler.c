@@ -0,0 +1,383 @@
+#include "fpv_interceptor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/**
+ * Планировщик повторных визитов каналов
+ * Слоты сканирования делятся на обзорные и повторные. Обзорный слот
+ * берет следующую частоту списка обхода (план сканирования), поэтому
+ * каждый канал посещается не реже одного раза за N * (k + 1) слотов.
+ * Повторный слот отдается активному (превышающему свой шум) каналу с
+ * наибольшим произведением времени без визита на вес активности;
+ * из соседних частот одного передатчика кандидатом считается только пик.
+ * Число повторных слотов k на один обзорный подбирается по измеренной
+ * длительности визита так, чтобы обзор укладывался в SCHED_MAX_REVISIT_MS.
+ */
+
+#define SCHED_DEFAULT_MAX_REVISIT_MS 60000 // Гарантированный интервал для тихих каналов
+#define SCHED_MAX_REVISIT_SLOTS      16    // Максимум повторных слотов на один обзорный
+#define SCHED_ACTIVITY_MARGIN        10    // Превышение RSSI над шумом для активности (%)
+#define SCHED_DETECTION_BONUS        50    // Прибавка к весу сразу после обнаружения
+#define SCHED_DETECTION_HOLD_NS      10000000000ULL // Затухание прибавки (10 с)
+#define SCHED_PEAK_SPAN              3     // Окрестность пика передатчика (МГц)
+#define SCHED_REPORT_CHANNELS        8     // Каналов в отчете
+
+// Состояние канала
+typedef struct {
+    uint64_t last_visit_ns;
+    uint64_t last_detection_ns;
+    uint8_t rssi;           // Последний RSSI
+    uint8_t activity;       // Скользящее среднее превышения над шумом
+    revisit_stats_t stats;
+} sched_channel_t;
+
+// Состояние каналов по охвату плана сканирования и список текущего обхода
+static sched_channel_t *sched = NULL;
+static int sched_count = 0;
+static uint16_t *cycle_list = NULL;
+static int cycle_count = 0;
+static pthread_mutex_t sched_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int config_loaded = 0;
+static uint64_t max_revisit_ns = SCHED_DEFAULT_MAX_REVISIT_MS * 1000000ULL;
+static int cursor = 0;
+static int cycle_done = 0;
+static int revisit_slots = 0;     // Повторных слотов на один обзорный (k)
+static int slot = 0;              // Повторных слотов с последнего обзорного
+static uint64_t discovery_total = 0;
+static uint64_t revisit_total = 0;
+static uint64_t visit_cost_ns = 0;
+static uint64_t last_next_ns[RX5808_MAX_RECEIVERS];
+
+/**
+ * Состояние канала частоты (NULL если частота вне плана)
+ */
+static sched_channel_t* channel_state(int frequency) {
+    int channel = frequency >= 0 && frequency <= 0xFFFF ? scan_plan_channel((uint16_t)frequency) : -1;
+    return channel >= 0 && channel < sched_count ? &sched[channel] : NULL;
+}
+
+/**
+ * Чтение SCHED_MAX_REVISIT_MS из конфигурации
+ */
+static void load_config(void) {
+    char value[16];
+
+    if (config_loaded) return;
+    config_loaded = 1;
+
+    if (config_get_value("SCHED_MAX_REVISIT_MS", value, sizeof(value)) == 0 && atoi(value) > 0) {
+        max_revisit_ns = (uint64_t)atoi(value) * 1000000ULL;
+    }
+}
+
+/**
+ * Номер корзины гистограммы для интервала
+ */
+static int revisit_bucket(uint64_t interval_ns) {
+    uint64_t interval_ms = interval_ns / 1000000;
+    int bucket = 0;
+
+    while (bucket < REVISIT_BUCKETS - 1 && interval_ms >= (1ULL << bucket)) {
+        bucket++;
+    }
+    return bucket;
+}
+
+/**
+ * Вес канала для повторного визита (0 - канал тихий)
+ */
+static uint32_t channel_weight(const sched_channel_t *ch, uint64_t now_ns) {
+    uint32_t weight = ch->activity;
+
+    if (ch->stats.detections > 0 && now_ns - ch->last_detection_ns < SCHED_DETECTION_HOLD_NS) {
+        weight += (uint32_t)(SCHED_DETECTION_BONUS *
+                             (SCHED_DETECTION_HOLD_NS - (now_ns - ch->last_detection_ns)) /
+                             SCHED_DETECTION_HOLD_NS);
+    }
+    return weight;
+}
+
+/**
+ * Проверка, что последний RSSI канала - локальный максимум окрестности
+ */
+static int is_local_peak(int frequency) {
+    uint8_t rssi = channel_state(frequency)->rssi;
+
+    for (int f = frequency - SCHED_PEAK_SPAN; f <= frequency + SCHED_PEAK_SPAN; f++) {
+        const sched_channel_t *near = channel_state(f);
+        if (f == frequency || !near || near->stats.visits == 0) continue;
+        if (near->rssi > rssi) return 0;
+    }
+    return 1;
+}
+
+/**
+ * Подбор числа повторных слотов по длительности визита
+ */
+static void update_revisit_slots(void) {
+    int receivers = rx5808_get_receiver_count();
+    uint64_t channels = cycle_count > 0 ? cycle_count : 1;
+    uint64_t slot_ns = visit_cost_ns / (receivers > 0 ? receivers : 1);
+
+    if (slot_ns == 0) {
+        revisit_slots = 0;
+        return;
+    }
+
+    uint64_t groups = max_revisit_ns / (channels * slot_ns);
+    revisit_slots = groups > 1 ? (int)(groups - 1) : 0;
+    if (revisit_slots > SCHED_MAX_REVISIT_SLOTS) revisit_slots = SCHED_MAX_REVISIT_SLOTS;
+}
+
+/**
+ * Сброс истории и статистики планировщика
+ */
+void scan_scheduler_reset(void) {
+    const scan_plan_t *plan = scan_plan_get();
+
+    pthread_mutex_lock(&sched_mutex);
+    if (sched_count != plan->channel_count) {
+        free(sched);
+        sched = malloc(plan->channel_count * sizeof(*sched));
+        sched_count = sched ? plan->channel_count : 0;
+    }
+    if (sched) memset(sched, 0, sched_count * sizeof(*sched));
+    memset(last_next_ns, 0, sizeof(last_next_ns));
+    cursor = 0;
+    cycle_done = 0;
+    slot = 0;
+    discovery_total = 0;
+    revisit_total = 0;
+    visit_cost_ns = 0;
+    pthread_mutex_unlock(&sched_mutex);
+}
+
+/**
+ * Начало цикла обзора
+ * Цикл заканчивается, когда обзорные слоты прошли весь список
+ * @param list Частоты обзора по порядку (копируется)
+ * @param count Количество частот
+ */
+void scan_scheduler_begin(const uint16_t *list, int count) {
+    if (!sched) scan_scheduler_reset();
+
+    pthread_mutex_lock(&sched_mutex);
+    load_config();
+
+    // Список изменился - обзор начинается сначала
+    if (count != cycle_count || memcmp(list, cycle_list, count * sizeof(*list)) != 0) {
+        uint16_t *copy = realloc(cycle_list, (count > 0 ? count : 1) * sizeof(*copy));
+        if (copy) {
+            cycle_list = copy;
+            cycle_count = 0;
+            for (int i = 0; i < count; i++) {
+                if (channel_state(list[i])) cycle_list[cycle_count++] = list[i];
+            }
+        }
+        cursor = 0;
+    }
+    cycle_done = 0;
+    pthread_mutex_unlock(&sched_mutex);
+}
+
+/**
+ * Выбор следующей частоты для текущего приемника
+ * @param now_ns Время по часам приемника
+ * @param frequency Выходная частота
+ * @return 1 если частота выдана, 0 если цикл обзора завершен
+ */
+int scan_scheduler_next(uint64_t now_ns, uint16_t *frequency) {
+    int rx = rx5808_current_receiver();
+
+    pthread_mutex_lock(&sched_mutex);
+
+    if (cycle_done) {
+        last_next_ns[rx] = 0;
+        pthread_mutex_unlock(&sched_mutex);
+        return 0;
+    }
+
+    // Длительность визита: интервал между запросами одного приемника
+    if (last_next_ns[rx] > 0 && now_ns > last_next_ns[rx]) {
+        int64_t cost = (int64_t)(now_ns - last_next_ns[rx]);
+        visit_cost_ns = visit_cost_ns ? (uint64_t)((int64_t)visit_cost_ns + (cost - (int64_t)visit_cost_ns) / 8)
+                                      : (uint64_t)cost;
+    }
+    last_next_ns[rx] = now_ns;
+    update_revisit_slots();
+
+    // Повторный слот: активный канал, дольше всех ждущий с учетом веса
+    if (slot < revisit_slots) {
+        int best = -1;
+        uint64_t best_score = 0;
+
+        for (int i = 0; i < cycle_count; i++) {
+            int f = cycle_list[i];
+            const sched_channel_t *ch = channel_state(f);
+            uint32_t weight = channel_weight(ch, now_ns);
+            if (weight == 0 || !is_local_peak(f)) continue;
+
+            uint64_t age_us = (now_ns - ch->last_visit_ns) / 1000;
+            uint64_t score = age_us * weight;
+            if (best < 0 || score > best_score) {
+                best = f;
+                best_score = score;
+            }
+        }
+
+        if (best >= 0) {
+            slot++;
+            revisit_total++;
+            *frequency = (uint16_t)best;
+            pthread_mutex_unlock(&sched_mutex);
+            return 1;
+        }
+    }
+
+    // Обзорный слот: следующая частота по порядку
+    slot = 0;
+    if (cursor >= cycle_count) {
+        cursor = 0;
+        cycle_done = 1;
+        last_next_ns[rx] = 0;
+        pthread_mutex_unlock(&sched_mutex);
+        return 0;
+    }
+
+    *frequency = cycle_list[cursor++];
+    discovery_total++;
+    pthread_mutex_unlock(&sched_mutex);
+    return 1;
+}
+
+/**
+ * Учет визита канала (вызывается после каждого измерения в любом режиме)
+ * @param frequency Частота
+ * @param rssi Измеренный RSSI
+ * @param now_ns Время измерения по часам приемника
+ * @param since_visit_ns Время с предыдущего визита канала, 0 при первом
+ *                       визите (может быть NULL)
+ * @return 1 если RSSI выше порога впервые после тихого визита, иначе 0
+ */
+int scan_scheduler_update(uint16_t frequency, uint8_t rssi, uint64_t now_ns, uint64_t *since_visit_ns) {
+    int fresh = 0;
+
+    if (since_visit_ns) *since_visit_ns = 0;
+
+    // Порог и активность - относительно шума канала (noise_floor.c)
+    uint8_t threshold = noise_floor_threshold(frequency);
+    uint8_t noise = noise_floor_level(frequency);
+
+    pthread_mutex_lock(&sched_mutex);
+    sched_channel_t *ch = channel_state(frequency);
+    if (!ch) {
+        pthread_mutex_unlock(&sched_mutex);
+        return 0;
+    }
+    int was_detected = ch->stats.visits > 0 && ch->rssi > threshold;
+
+    if (ch->stats.visits > 0 && now_ns > ch->last_visit_ns) {
+        uint64_t interval = now_ns - ch->last_visit_ns;
+        ch->stats.revisit_total_ns += interval;
+        if (interval > ch->stats.revisit_max_ns) ch->stats.revisit_max_ns = interval;
+        ch->stats.histogram[revisit_bucket(interval)]++;
+
+        // Скользящая оценка интервала визитов (вес нового интервала 1/8)
+        int64_t ewma = (int64_t)ch->stats.revisit_ewma_ns;
+        ch->stats.revisit_ewma_ns = ewma ? (uint64_t)(ewma + ((int64_t)interval - ewma) / 8) : interval;
+        if (since_visit_ns) *since_visit_ns = interval;
+    }
+    ch->stats.visits++;
+    ch->last_visit_ns = now_ns;
+    ch->rssi = rssi;
+
+    int excess = (rssi > noise + SCHED_ACTIVITY_MARGIN) ? rssi - noise : 0;
+    ch->activity = (uint8_t)((ch->activity * 3 + excess) / 4);
+
+    if (rssi > threshold) {
+        ch->stats.detections++;
+        ch->last_detection_ns = now_ns;
+        fresh = !was_detected;
+    }
+    pthread_mutex_unlock(&sched_mutex);
+    return fresh;
+}
+
+/**
+ * Распределение интервалов между визитами канала
+ * @param frequency Частота
+ * @param out Указатель на структуру статистики
+ */
+void get_revisit_stats(uint16_t frequency, revisit_stats_t *out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+
+    pthread_mutex_lock(&sched_mutex);
+    const sched_channel_t *ch = channel_state(frequency);
+    if (ch) {
+        *out = ch->stats;
+        out->weight = channel_weight(ch, ch->last_visit_ns);
+    }
+    pthread_mutex_unlock(&sched_mutex);
+}
+
+/**
+ * Печать распределения интервалов повторных визитов
+ */
+void scan_scheduler_print_stats(void) {
+    int top[SCHED_REPORT_CHANNELS];
+    int top_count = 0;
+    uint64_t quiet_max_ns = 0;
+    uint64_t visits = 0;
+
+    pthread_mutex_lock(&sched_mutex);
+
+    // Все каналы охвата плана: визиты учитываются в любом режиме обхода
+    for (int channel = 0; channel < sched_count; channel++) {
+        const sched_channel_t *ch = &sched[channel];
+        int f = scan_plan_get()->freq_min + channel;
+        visits += ch->stats.visits;
+
+        if (ch->stats.detections == 0) {
+            if (ch->stats.revisit_max_ns > quiet_max_ns) quiet_max_ns = ch->stats.revisit_max_ns;
+            continue;
+        }
+
+        // Каналы с обнаружениями по убыванию числа визитов
+        int pos = top_count < SCHED_REPORT_CHANNELS ? top_count++ : SCHED_REPORT_CHANNELS;
+        while (pos > 0 && channel_state(top[pos - 1])->stats.visits < ch->stats.visits) {
+            if (pos < SCHED_REPORT_CHANNELS) top[pos] = top[pos - 1];
+            pos--;
+        }
+        if (pos < SCHED_REPORT_CHANNELS) top[pos] = f;
+    }
+
+    if (visits == 0) {
+        pthread_mutex_unlock(&sched_mutex);
+        return;
+    }
+
+    if (discovery_total > 0) {
+        printf("   Слоты: обзорных %llu, повторных %llu (до %d на обзорный), визит %.1f мс\n",
+               (unsigned long long)discovery_total, (unsigned long long)revisit_total,
+               revisit_slots, visit_cost_ns / 1e6);
+    }
+    printf("   Интервал тихих каналов: макс. %.0f мс", quiet_max_ns / 1e6);
+    if (discovery_total > 0) {
+        printf(" (гарантия %.0f мс)", max_revisit_ns / 1e6);
+    }
+    printf("\n");
+
+    for (int i = 0; i < top_count; i++) {
+        const revisit_stats_t *s = &channel_state(top[i])->stats;
+        uint32_t intervals = s->visits > 1 ? s->visits - 1 : 1;
+        printf("     %d МГц: визитов %u, обнаружений %u, интервал ср. %.0f мс, макс. %.0f мс\n",
+               top[i], s->visits, s->detections, s->revisit_total_ns / 1e6 / intervals,
+               s->revisit_max_ns / 1e6);
+    }
+
+    pthread_mutex_unlock(&sched_mutex);
+}
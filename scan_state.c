@@ -0,0 +1,380 @@
+#include "fpv_interceptor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+/**
+ * Контрольная точка состояния сканирования
+ * История анализатора RSSI, карта шума и журнал обнаружений размещаются в
+ * разделах одного блока памяти с раскладкой файла STATE_FILE. Раз в
+ * STATE_SYNC_MS и при выходе блок копируется в снимок, снимок записывается
+ * во временный файл, сбрасывается на носитель (fsync) и переименованием
+ * (rename) заменяет STATE_FILE. Поэтому файл на носителе - всегда целый
+ * снимок одной синхронизации: падение процесса или пропадание питания
+ * теряют только изменения после нее. Контрольная сумма охватывает заголовок
+ * и все разделы; заголовок хранит версию и размеры разделов. Файл от
+ * другого плана сканирования или другой версии программы и поврежденный
+ * файл начинаются заново. Метки времени при восстановлении переносятся на
+ * новые часы приемника по календарному времени последней синхронизации.
+ */
+
+#define STATE_MAGIC   0x54535046 // "FPST"
+#define STATE_VERSION 1
+#define STATE_ALIGN   64         // Выравнивание разделов (строка кэша)
+#define STATE_DEFAULT_SYNC_MS 5000
+
+// Заголовок файла состояния
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t section_count;
+    uint64_t section_offset[STATE_SECTION_COUNT];
+    uint64_t section_size[STATE_SECTION_COUNT];
+    uint16_t freq_min;       // Охват плана: таблицы каналов от freq_min
+    uint16_t freq_max;
+    uint32_t rssi_samples;
+    uint64_t generation;     // Синхронизаций с носителем
+    uint64_t clock_ns;       // Часы приемника при последней синхронизации
+    uint64_t wall_ns;        // Календарное время при ней
+    uint32_t checksum;       // FNV-1a заголовка до этого поля и всех разделов
+} state_header_t;
+
+// Раздел журнала обнаружений
+typedef struct {
+    int32_t count;
+    detected_signal_t signals[MAX_DETECTED_SIGNALS];
+} state_signals_t;
+
+static uint8_t *state_map = NULL;    // Разделы в памяти (раскладка файла)
+static uint8_t *snapshot = NULL;     // Копия для записи в файл
+static size_t state_size = 0;
+static int state_restored = 0;
+static int64_t clock_shift_ns = 0;   // Перенос восстановленных меток на новые часы
+static uint64_t sync_period_ns = STATE_DEFAULT_SYNC_MS * 1000000ULL;
+static uint64_t last_sync_ns = 0;    // Реальное время последней синхронизации
+static char state_path[256];
+static char temp_path[272];          // Снимок до переименования в state_path
+static pthread_mutex_t state_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Календарное время в наносекундах
+ */
+static uint64_t wall_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Контрольная сумма снимка (FNV-1a заголовка до поля checksum и разделов)
+ * @param image Снимок длиной state_size
+ */
+static uint32_t state_checksum(const uint8_t *image) {
+    const state_header_t *header = (const state_header_t*)image;
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < offsetof(state_header_t, checksum); i++) {
+        hash = (hash ^ image[i]) * 16777619u;
+    }
+    for (size_t i = header->section_offset[0]; i < state_size; i++) {
+        hash = (hash ^ image[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Проверка, что заголовок описывает ту же раскладку файла
+ */
+static int header_matches(const state_header_t *expected) {
+    const state_header_t *header = (const state_header_t*)state_map;
+
+    return header->magic == expected->magic &&
+           header->version == expected->version &&
+           header->header_size == expected->header_size &&
+           header->section_count == expected->section_count &&
+           header->freq_min == expected->freq_min &&
+           header->freq_max == expected->freq_max &&
+           header->rssi_samples == expected->rssi_samples &&
+           memcmp(header->section_offset, expected->section_offset, sizeof(expected->section_offset)) == 0 &&
+           memcmp(header->section_size, expected->section_size, sizeof(expected->section_size)) == 0;
+}
+
+/**
+ * Чтение файла состояния в разделы
+ * @return 1 - файл прочитан целиком, 0 - файла нет или размер другой
+ */
+static int read_state_file(void) {
+    int fd = open(state_path, O_RDONLY);
+    if (fd < 0) return 0;
+
+    struct stat st;
+    size_t done = 0;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size == state_size) {
+        while (done < state_size) {
+            ssize_t n = read(fd, state_map + done, state_size - done);
+            if (n <= 0) break;
+            done += (size_t)n;
+        }
+    }
+    close(fd);
+    return done == state_size;
+}
+
+/**
+ * Сброс каталога файла на носитель (переименование в нем)
+ */
+static int sync_directory(void) {
+    char dir[sizeof(state_path)];
+    const char *slash = strrchr(state_path, '/');
+
+    if (!slash) {
+        strcpy(dir, ".");
+    } else if (slash == state_path) {
+        strcpy(dir, "/");
+    } else {
+        memcpy(dir, state_path, (size_t)(slash - state_path));
+        dir[slash - state_path] = '\0';
+    }
+
+    int fd = open(dir, O_RDONLY);
+    if (fd < 0) return -1;
+    int result = fsync(fd);
+    close(fd);
+    return result;
+}
+
+/**
+ * Запись снимка разделов во временный файл и замена STATE_FILE
+ * (вызывается под state_mutex). Разделы меняются потоками сканирования и
+ * во время записи, поэтому записывается копия с контрольной суммой
+ * @return 0 при успехе, -1 при ошибке (прежний файл остается целым)
+ */
+static int write_snapshot(void) {
+    state_header_t *header = (state_header_t*)state_map;
+
+    header->generation++;
+    header->clock_ns = rx5808_now_ns();
+    header->wall_ns = wall_now_ns();
+
+    memcpy(snapshot, state_map, state_size);
+    ((state_header_t*)snapshot)->checksum = state_checksum(snapshot);
+
+    int fd = open(temp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return -1;
+
+    size_t done = 0;
+    while (done < state_size) {
+        ssize_t n = write(fd, snapshot + done, state_size - done);
+        if (n <= 0) break;
+        done += (size_t)n;
+    }
+    int result = (done == state_size && fsync(fd) == 0) ? 0 : -1;
+    if (close(fd) != 0) result = -1;
+
+    if (result == 0 && rename(temp_path, state_path) == 0) {
+        sync_directory();
+        return 0;
+    }
+    unlink(temp_path);
+    return -1;
+}
+
+/**
+ * Освобождение разделов (вызывается под state_mutex)
+ */
+static void free_state(void) {
+    free(state_map);
+    free(snapshot);
+    state_map = NULL;
+    snapshot = NULL;
+    state_size = 0;
+}
+
+/**
+ * Восстановление журнала обнаружений из файла
+ * Вызывается до запуска сканирования
+ */
+static void restore_signals(void) {
+    const state_header_t *header = (const state_header_t*)state_map;
+    state_signals_t *saved = (state_signals_t*)(state_map + header->section_offset[STATE_SIGNALS]);
+
+    int count = saved->count;
+    if (count < 0 || count > MAX_DETECTED_SIGNALS) count = 0;
+
+    memcpy(detected_signals, saved->signals, sizeof(saved->signals));
+    for (int i = 0; i < count; i++) {
+        detected_signals[i].timestamp_ns = scan_state_rebase(detected_signals[i].timestamp_ns);
+    }
+    detected_count = count;
+}
+
+/**
+ * Открытие файла состояния STATE_FILE
+ * Без STATE_FILE в конфигурации состояние хранится только в памяти
+ * @param sizes Размеры разделов анализатора (раздел STATE_SIGNALS задается модулем)
+ * @return 1 - состояние восстановлено, 0 - файл начат заново, -1 - файл не используется
+ */
+int scan_state_open(const size_t sizes[STATE_SECTION_COUNT]) {
+    char value[32];
+
+    scan_state_close();
+
+    if (config_get_value("STATE_FILE", state_path, sizeof(state_path)) != 0 || state_path[0] == '\0') {
+        return -1;
+    }
+    if (config_get_value("STATE_SYNC_MS", value, sizeof(value)) == 0 && atoi(value) > 0) {
+        sync_period_ns = (uint64_t)atoi(value) * 1000000ULL;
+    }
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", state_path);
+
+    // Раскладка файла: заголовок и разделы по границам строк кэша
+    const scan_plan_t *plan = scan_plan_get();
+    state_header_t expected;
+    memset(&expected, 0, sizeof(expected));
+    expected.magic = STATE_MAGIC;
+    expected.version = STATE_VERSION;
+    expected.header_size = sizeof(state_header_t);
+    expected.section_count = STATE_SECTION_COUNT;
+    expected.freq_min = plan->freq_min;
+    expected.freq_max = plan->freq_max;
+    expected.rssi_samples = RSSI_SAMPLES;
+
+    size_t offset = (sizeof(state_header_t) + STATE_ALIGN - 1) & ~(size_t)(STATE_ALIGN - 1);
+    for (int i = 0; i < STATE_SECTION_COUNT; i++) {
+        size_t size = i == STATE_SIGNALS ? sizeof(state_signals_t) : sizes[i];
+        expected.section_offset[i] = offset;
+        expected.section_size[i] = size;
+        offset += (size + STATE_ALIGN - 1) & ~(size_t)(STATE_ALIGN - 1);
+    }
+
+    pthread_mutex_lock(&state_mutex);
+    void *block = NULL;
+    if (posix_memalign(&block, STATE_ALIGN, offset) != 0 || !(snapshot = malloc(offset))) {
+        free(block);
+        pthread_mutex_unlock(&state_mutex);
+        printf("⚠️ Недостаточно памяти для состояния %s\n", state_path);
+        return -1;
+    }
+    state_map = (uint8_t*)block;
+    state_size = offset;
+
+    state_header_t *header = (state_header_t*)state_map;
+    int layout_matches = read_state_file() && header_matches(&expected);
+    state_restored = layout_matches && header->checksum == state_checksum(state_map);
+    uint64_t age_ns = 0;
+
+    if (state_restored) {
+        // Метка t старых часов -> t + сдвиг на новых: прошедшее календарное
+        // время переносится на часы приемника
+        uint64_t wall = wall_now_ns();
+        age_ns = wall > header->wall_ns ? wall - header->wall_ns : 0;
+        clock_shift_ns = (int64_t)rx5808_now_ns() - (int64_t)age_ns - (int64_t)header->clock_ns;
+        restore_signals();
+    } else {
+        // Другой план или версия, поврежденный файл: разделы начинаются пустыми
+        if (layout_matches) {
+            printf("⚠️ Контрольная сумма файла состояния %s не совпала, начат заново\n", state_path);
+        }
+        memset(state_map, 0, state_size);
+        *header = expected;
+        clock_shift_ns = 0;
+    }
+
+    // Первый снимок сразу: файл доступен для записи, и его раскладка - текущая
+    if (write_snapshot() != 0) {
+        free_state();
+        state_restored = 0;
+        pthread_mutex_unlock(&state_mutex);
+        printf("⚠️ Не удалось записать файл состояния %s\n", state_path);
+        return -1;
+    }
+    last_sync_ns = get_monotonic_ns();
+    pthread_mutex_unlock(&state_mutex);
+
+    if (state_restored) {
+        printf("♻️ Состояние восстановлено из %s: сигналов %d, возраст %.1f с\n",
+               state_path, detected_count, age_ns / 1e9);
+    } else {
+        printf("💾 Новый файл состояния %s (%zu КБ)\n", state_path, state_size / 1024);
+    }
+    return state_restored;
+}
+
+/**
+ * Раздел файла состояния
+ * @return Указатель на раздел или NULL, если файл не используется
+ */
+void* scan_state_section(int section) {
+    if (!state_map || section < 0 || section >= STATE_SECTION_COUNT) return NULL;
+    return state_map + ((const state_header_t*)state_map)->section_offset[section];
+}
+
+/**
+ * Разделы содержат восстановленное состояние (иначе они обнулены)
+ */
+int scan_state_restored(void) {
+    return state_map != NULL && state_restored;
+}
+
+/**
+ * Перенос восстановленной метки времени на текущие часы приемника
+ * @param timestamp_ns Метка по часам прошлого запуска (0 - нет метки)
+ * @return Метка по текущим часам; слишком старые метки - 1 (давно)
+ */
+uint64_t scan_state_rebase(uint64_t timestamp_ns) {
+    if (timestamp_ns == 0) return 0;
+
+    int64_t rebased = (int64_t)timestamp_ns + clock_shift_ns;
+    return rebased > 0 ? (uint64_t)rebased : 1;
+}
+
+/**
+ * Копирование журнала обнаружений в раздел (в файл - при синхронизации)
+ * Вызывается под блокировкой журнала
+ */
+void scan_state_save_signals(void) {
+    pthread_mutex_lock(&state_mutex);
+    state_signals_t *saved = (state_signals_t*)scan_state_section(STATE_SIGNALS);
+    if (saved) {
+        memcpy(saved->signals, detected_signals, sizeof(saved->signals));
+        saved->count = detected_count;
+    }
+    pthread_mutex_unlock(&state_mutex);
+}
+
+/**
+ * Запись снимка состояния в файл
+ * @param force 1 - немедленно, 0 - если прошло STATE_SYNC_MS
+ */
+void scan_state_sync(int force) {
+    uint64_t now = get_monotonic_ns();
+
+    pthread_mutex_lock(&state_mutex);
+    if (state_map && (force || now - last_sync_ns >= sync_period_ns)) {
+        if (write_snapshot() != 0) {
+            printf("⚠️ Ошибка записи файла состояния %s\n", state_path);
+        }
+        last_sync_ns = now;
+    }
+    pthread_mutex_unlock(&state_mutex);
+}
+
+/**
+ * Запись последнего снимка и освобождение разделов
+ * Разделы после закрытия недействительны
+ */
+void scan_state_close(void) {
+    scan_state_sync(1);
+
+    pthread_mutex_lock(&state_mutex);
+    free_state();
+    state_restored = 0;
+    pthread_mutex_unlock(&state_mutex);
+}
@@ -0,0 +1,259 @@
+#include "signal_track.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/**
+ * Сопровождение обнаруженного сигнала
+ * Приемник остается на частоте передатчика и опрашивает ее каждые 100 мс.
+ * Раз в TRACK_PROBE_EVERY опросов, а при пропадании сигнала на каждом опросе,
+ * проверяются соседние частоты на +-1..TRACK_PROBE_MHZ МГц: если сосед
+ * сильнее, приемник переходит за дрейфом или сменой канала. Сопровождение
+ * заканчивается, когда сигнала нет ни на частоте, ни рядом дольше
+ * TRACK_LOST_MS или истекло TRACK_MAX_MS (0 - без ограничения), чтобы
+ * постоянный передатчик не останавливал обход навсегда. Один передатчик
+ * так обновляется 10 раз в секунду вместо одного раза за полный обход.
+ */
+
+#define TRACK_PERIOD_NS    100000000ULL // Период опроса частоты сигнала (100 мс)
+#define TRACK_PROBE_EVERY  5            // Проба соседей каждые N опросов при сигнале
+#define TRACK_DRIFT_MARGIN 5            // Превышение RSSI соседа для перехода (%)
+
+static uint64_t lost_ns = (uint64_t)TRACK_DEFAULT_LOST_MS * 1000000ULL;
+static uint64_t max_ns = 0;
+static int probe_mhz = TRACK_DEFAULT_PROBE_MHZ;
+static pthread_once_t config_once = PTHREAD_ONCE_INIT;
+
+static track_stats_t totals;
+static pthread_mutex_t totals_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Чтение параметров сопровождения из конфигурации
+ */
+static void load_config(void) {
+    char value[32];
+
+    if (config_get_value("TRACK_LOST_MS", value, sizeof(value)) == 0 && atoi(value) > 0) {
+        lost_ns = (uint64_t)atoi(value) * 1000000ULL;
+    }
+    if (config_get_value("TRACK_MAX_MS", value, sizeof(value)) == 0 && atoi(value) >= 0) {
+        max_ns = (uint64_t)atoi(value) * 1000000ULL;
+    }
+    if (config_get_value("TRACK_PROBE_MHZ", value, sizeof(value)) == 0) {
+        int mhz = atoi(value);
+        if (mhz >= 1 && mhz <= TRACK_MAX_PROBE_MHZ) {
+            probe_mhz = mhz;
+        } else {
+            printf("⚠️ TRACK_PROBE_MHZ=%s вне пределов 1-%d, используется %d\n",
+                   value, TRACK_MAX_PROBE_MHZ, probe_mhz);
+        }
+    }
+}
+
+/**
+ * Опрос частоты: перестройка, чтение и сглаживание RSSI
+ * @param timestamp_ns Время отсчета (может быть NULL)
+ * @return RSSI (0 при ошибке перестройки)
+ */
+static uint8_t measure(uint16_t frequency, uint64_t *timestamp_ns) {
+    if (rx5808_set_frequency(frequency) != 0) return 0;
+
+    uint8_t raw = rx5808_read_rssi();
+    uint64_t now = rx5808_now_ns();
+    if (timestamp_ns) *timestamp_ns = now;
+    return analyze_rssi_sample(frequency, raw, now);
+}
+
+/**
+ * Печать показателей сопровождения
+ */
+static void print_metrics(const track_stats_t *s) {
+    printf("%.1f с, непрерывность %u%%", s->duration_ns / 1e9,
+           s->polls ? s->updates * 100 / s->polls : 0);
+    if (s->duration_ns > 0) {
+        // Первое обновление каждого сопровождения - само обнаружение
+        printf(", обновлений %.1f/с", (s->updates - s->tracks) * 1e9 / s->duration_ns);
+    }
+    printf(", наиб. разрыв %llu мс, проб %u, переходов %u\n",
+           (unsigned long long)(s->longest_gap_ns / 1000000ULL), s->probes, s->retunes);
+}
+
+/**
+ * Сопровождение сигнала
+ * Выполняется в потоке приемника; приемник, привязанный к потоку,
+ * на время сопровождения не участвует в обходе
+ * @param frequency Частота обнаруженного сигнала
+ * @param on_update Вызывается после каждого опроса (может быть NULL)
+ * @param out Статистика этого сопровождения (может быть NULL)
+ * @return 0 - сигнал потерян или истекло TRACK_MAX_MS, 1 - прервано on_update,
+ *         -1 при ошибке
+ */
+int track_signal(uint16_t frequency, track_update_fn on_update, track_stats_t *out) {
+    if (!scan_plan_allows(frequency)) {
+        printf("❌ Частота %d МГц вне плана сканирования\n", frequency);
+        return -1;
+    }
+    pthread_once(&config_once, load_config);
+
+    track_stats_t track;
+    memset(&track, 0, sizeof(track));
+    track.tracks = 1;
+    track.start_frequency = frequency;
+
+    uint16_t center = frequency;
+    uint64_t start = rx5808_now_ns();
+    uint64_t last_update = start; // Обнаружение считается первым обновлением
+    uint64_t next_poll = start;
+    uint32_t polls = 0;
+    int held_before = 1;
+    int result = 0;
+    int expired = 0;
+
+    printf("🎯 Сопровождение %d МГц...\n", frequency);
+
+    while (1) {
+        uint64_t now = 0;
+        uint8_t rssi = measure(center, &now);
+        int held = rssi > noise_floor_threshold(center);
+        polls++;
+
+        // Проба соседних частот: ближние первыми, переход только к более
+        // сильному соседу, чтобы не метаться по плоской вершине спектра
+        if (!held || polls % TRACK_PROBE_EVERY == 0) {
+            uint16_t best = center;
+            uint8_t best_rssi = rssi;
+            uint64_t best_ts = now;
+            int margin = held ? TRACK_DRIFT_MARGIN : 0;
+
+            for (int d = 1; d <= probe_mhz; d++) {
+                for (int sign = -1; sign <= 1; sign += 2) {
+                    int probe = center + sign * d;
+                    if (probe < RX5808_FREQ_MIN || probe > RX5808_FREQ_MAX ||
+                        !scan_plan_allows((uint16_t)probe)) {
+                        continue;
+                    }
+
+                    uint64_t ts = 0;
+                    uint8_t level = measure((uint16_t)probe, &ts);
+                    track.probes++;
+                    if (level > best_rssi && level > rssi + margin) {
+                        best = (uint16_t)probe;
+                        best_rssi = level;
+                        best_ts = ts;
+                    }
+                }
+            }
+
+            if (best != center && best_rssi > noise_floor_threshold(best)) {
+                printf("↔️ Сигнал сместился: %d → %d МГц, RSSI %d%%\n", center, best, best_rssi);
+                center = best;
+                rssi = best_rssi;
+                now = best_ts;
+                held = 1;
+                track.retunes++;
+            }
+        }
+
+        if (held) {
+            if (now - last_update > track.longest_gap_ns) {
+                track.longest_gap_ns = now - last_update;
+            }
+            if (!held_before) track.dropouts++;
+            last_update = now;
+            track.updates++;
+            track.polls = polls;
+        } else if (now - last_update >= lost_ns) {
+            break;
+        }
+        held_before = held;
+
+        if (max_ns > 0 && now - start >= max_ns) {
+            expired = 1;
+            break;
+        }
+
+        if (on_update) {
+            scan_result_t sample;
+            sample.frequency = center;
+            sample.rssi = rssi;
+            sample.detected = (uint8_t)held;
+            sample.receiver = (uint8_t)rx5808_current_receiver();
+            sample.tracking = 1;
+            sample.cycle = 0;
+            sample.timestamp_ns = now;
+            if (!on_update(&sample)) {
+                result = 1;
+                break;
+            }
+        }
+
+        // Опрос строго каждые 100 мс, пробы укладываются в период
+        next_poll += TRACK_PERIOD_NS;
+        rx5808_sleep_until_ns(next_poll);
+    }
+
+    track.last_frequency = center;
+    track.duration_ns = last_update - start;
+
+    if (expired) {
+        printf("⏱️ Время сопровождения %d МГц истекло, возврат к обходу: ", center);
+    } else if (result == 0) {
+        printf("📍 Сигнал %d МГц потерян, возврат к обходу: ", center);
+    } else {
+        printf("⏹️ Сопровождение %d МГц прервано: ", center);
+    }
+    print_metrics(&track);
+
+    pthread_mutex_lock(&totals_mutex);
+    totals.tracks++;
+    totals.start_frequency = track.start_frequency;
+    totals.last_frequency = track.last_frequency;
+    totals.duration_ns += track.duration_ns;
+    totals.polls += track.polls;
+    totals.updates += track.updates;
+    totals.probes += track.probes;
+    totals.retunes += track.retunes;
+    totals.dropouts += track.dropouts;
+    if (track.longest_gap_ns > totals.longest_gap_ns) {
+        totals.longest_gap_ns = track.longest_gap_ns;
+    }
+    pthread_mutex_unlock(&totals_mutex);
+
+    if (out) *out = track;
+    return result;
+}
+
+/**
+ * Ограничение длительности одного сопровождения
+ * @param ms Наибольшая длительность (мс), 0 - до потери сигнала
+ */
+void track_set_max_duration(uint32_t ms) {
+    pthread_once(&config_once, load_config);
+    max_ns = (uint64_t)ms * 1000000ULL;
+}
+
+/**
+ * Накопленная статистика всех сопровождений
+ * @param out Указатель на структуру статистики
+ */
+void get_track_stats(track_stats_t *out) {
+    if (!out) return;
+
+    pthread_mutex_lock(&totals_mutex);
+    *out = totals;
+    pthread_mutex_unlock(&totals_mutex);
+}
+
+/**
+ * Печать статистики сопровождения
+ */
+void track_print_stats(void) {
+    track_stats_t s;
+    get_track_stats(&s);
+
+    if (s.tracks == 0) return;
+
+    printf("   Сопровождений: %u, пропаданий с восстановлением %u, всего ", s.tracks, s.dropouts);
+    print_metrics(&s);
+}
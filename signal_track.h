@@ -0,0 +1,47 @@
+#ifndef SIGNAL_TRACK_H
+#define SIGNAL_TRACK_H
+
+#include "fpv_interceptor.h"
+#include "scan_queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Параметры сопровождения по умолчанию (TRACK_LOST_MS, TRACK_PROBE_MHZ)
+#define TRACK_DEFAULT_LOST_MS   2000 // Время без сигнала до возврата к обходу
+#define TRACK_DEFAULT_PROBE_MHZ 3    // Наибольшее отклонение пробы от частоты сигнала
+#define TRACK_MAX_PROBE_MHZ     3
+
+// Обновление сопровождения: вызывается после каждого опроса частоты
+// сигнала; 1 - продолжить сопровождение, 0 - прервать
+typedef int (*track_update_fn)(const scan_result_t *sample);
+
+typedef struct {
+    uint32_t tracks;          // Сопровождений (для одного - 1)
+    uint16_t start_frequency; // Частота захвата (последнего сопровождения)
+    uint16_t last_frequency;  // Частота сигнала при потере
+    uint64_t duration_ns;     // От захвата до последнего обновления
+    uint32_t polls;           // Опросов частоты сигнала до последнего обновления
+    uint32_t updates;         // Опросов с сигналом выше порога
+    uint32_t probes;          // Проб соседних частот
+    uint32_t retunes;         // Переходов за дрейфом или сменой канала
+    uint32_t dropouts;        // Пропаданий сигнала с восстановлением
+    uint64_t longest_gap_ns;  // Наибольший интервал между обновлениями
+} track_stats_t;
+
+// Сопровождение сигнала до его потери на TRACK_LOST_MS
+int track_signal(uint16_t frequency, track_update_fn on_update, track_stats_t *out);
+
+// Ограничение длительности одного сопровождения (TRACK_MAX_MS, 0 - до потери)
+void track_set_max_duration(uint32_t ms);
+
+// Накопленная статистика всех сопровождений
+void get_track_stats(track_stats_t *out);
+void track_print_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIGNAL_TRACK_H
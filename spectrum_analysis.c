@@ -0,0 +1,386 @@
+#include "spectrum_analysis.h"
+#include "channel_store.h"
+#include "cfar.h"
+#include "rssi_kernels.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+
+/**
+ * Пакетный анализ спектра
+ * Обход целиком (или архив обходов) анализируется пулом потоков со
+ * статическим разбиением каналов плана: поток k обрабатывает отсчеты своих
+ * каналов в порядке обхода. Отсчеты раскладываются по частям один раз до
+ * запуска потоков. Состояние анализа - история, окно и карта шума - у
+ * каждого канала свое и принадлежит одному потоку, поэтому карта шума
+ * обновляется без блокировки, а пороги CFAR копируются один раз на вызов.
+ * Результат совпадает с последовательным анализом при любом числе потоков.
+ * Границы частей кратны 64 каналам: байтовые массивы хранилища каналов
+ * разных потоков лежат в разных строках кэша. Вызывающий поток
+ * обрабатывает первую часть.
+ */
+
+#define SPECTRUM_PARALLEL_MIN 256               // Отсчетов для разделения между потоками
+#define SPECTRUM_BLOCK        CHANNEL_STORE_ALIGN // Кратность границ частей (каналов)
+
+// Отсчет обхода в списке части
+typedef struct {
+    int sweep;
+    int index;
+} spectrum_ref_t;
+
+// Задание пула: обходы, результаты и отсчеты частей
+typedef struct {
+    const spectrum_sweep_t *sweeps;
+    int count;
+    spectrum_result_t *const *results;
+    const uint8_t *cfar;                   // Пороги CFAR каналов (NULL - выключен)
+    const spectrum_ref_t *refs;            // Отсчеты, разложенные по частям
+    int bounds[SPECTRUM_MAX_THREADS + 1];  // Отсчеты части k: refs[bounds[k], bounds[k + 1])
+} spectrum_job_t;
+
+static pthread_t workers[SPECTRUM_MAX_THREADS];
+static int thread_count = 1;     // Включая вызывающий поток
+static int pool_started = 0;
+static int stopping = 0;
+static uint64_t generation = 0;  // Номер задания
+static uint64_t start_generation = 0; // Номер задания при запуске потоков
+static int pending_parts = 0;
+static const spectrum_job_t *current = NULL;
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_ready = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t work_done = PTHREAD_COND_INITIALIZER;
+
+// Пакетные вызовы выполняются по одному
+static pthread_mutex_t call_mutex = PTHREAD_MUTEX_INITIALIZER;
+static spectrum_stats_t totals;
+
+// Буферы вызова (под call_mutex): отсчеты частей и копия порогов CFAR
+static spectrum_ref_t *refs = NULL;
+static int refs_size = 0;
+static uint8_t *cfar_copy = NULL;
+static int cfar_size = 0;
+
+/**
+ * Первый канал части (part = parts - конец охвата плана)
+ */
+static int part_start(int part, int parts, int channels) {
+    if (part >= parts) return channels;
+
+    int start = (int)((int64_t)channels * part / parts);
+    return start & ~(SPECTRUM_BLOCK - 1);
+}
+
+/**
+ * Анализ одного отсчета - то же, что этап анализа обхода:
+ * карта шума, сглаживание и признаки окна канала
+ */
+static void analyze_one(const spectrum_job_t *job, const scan_result_t *in, spectrum_result_t *out) {
+    uint16_t freq = in->frequency;
+    int channel = scan_plan_channel(freq);
+    uint8_t cfar = job->cfar && channel >= 0 ? job->cfar[channel] : 0;
+
+    out->frequency = freq;
+    out->raw_rssi = in->rssi;
+    out->timestamp_ns = in->timestamp_ns;
+
+    // Отсчеты сопровождения в карту шума не попадают
+    out->threshold = noise_floor_observe(freq, in->rssi, in->timestamp_ns, !in->tracking, cfar);
+    out->rssi = analyze_rssi_sample(freq, in->rssi, in->timestamp_ns);
+    out->in_plan = get_rssi_features(freq, &out->features) == 0;
+    if (!out->in_plan) memset(&out->features, 0, sizeof(out->features));
+
+    out->detected = out->rssi > out->threshold;
+    out->video = out->in_plan && out->rssi >= out->threshold &&
+                 rssi_video_detected(out->rssi, &out->features);
+}
+
+/**
+ * Часть задания: отсчеты из списка части в порядке обходов
+ */
+static void run_part(const spectrum_job_t *job, int part) {
+    for (int r = job->bounds[part]; r < job->bounds[part + 1]; r++) {
+        const spectrum_ref_t *ref = &job->refs[r];
+        analyze_one(job, &job->sweeps[ref->sweep].samples[ref->index],
+                    &job->results[ref->sweep][ref->index]);
+    }
+}
+
+/**
+ * Все отсчеты заданий одним вызывающим потоком
+ */
+static void run_serial(const spectrum_job_t *job) {
+    for (int s = 0; s < job->count; s++) {
+        for (int i = 0; i < job->sweeps[s].count; i++) {
+            analyze_one(job, &job->sweeps[s].samples[i], &job->results[s][i]);
+        }
+    }
+}
+
+/**
+ * Часть канала: каналы [start(part), start(part + 1))
+ * Частоты вне плана обрабатывает часть 0
+ */
+static int channel_part(uint16_t frequency, const int *starts, int parts) {
+    int channel = scan_plan_channel(frequency);
+    int part = 0;
+
+    if (channel < 0 || channel >= starts[parts]) return 0;
+    while (part + 1 < parts && channel >= starts[part + 1]) part++;
+    return part;
+}
+
+/**
+ * Раскладка отсчетов по частям (устойчивая: порядок отсчетов канала
+ * сохраняется) - один проход до запуска потоков
+ * @return 0 при успехе, -1 при ошибке памяти
+ */
+static int split_parts(spectrum_job_t *job, int samples, int parts, int channels) {
+    int starts[SPECTRUM_MAX_THREADS + 1];
+    int fill[SPECTRUM_MAX_THREADS];
+
+    if (samples > refs_size) {
+        spectrum_ref_t *grown = realloc(refs, samples * sizeof(*refs));
+        if (!grown) return -1;
+        refs = grown;
+        refs_size = samples;
+    }
+
+    for (int k = 0; k <= parts; k++) {
+        starts[k] = part_start(k, parts, channels);
+    }
+
+    memset(job->bounds, 0, sizeof(job->bounds));
+    for (int s = 0; s < job->count; s++) {
+        for (int i = 0; i < job->sweeps[s].count; i++) {
+            job->bounds[channel_part(job->sweeps[s].samples[i].frequency, starts, parts) + 1]++;
+        }
+    }
+    for (int k = 0; k < parts; k++) {
+        job->bounds[k + 1] += job->bounds[k];
+        fill[k] = job->bounds[k];
+    }
+
+    for (int s = 0; s < job->count; s++) {
+        for (int i = 0; i < job->sweeps[s].count; i++) {
+            int part = channel_part(job->sweeps[s].samples[i].frequency, starts, parts);
+            refs[fill[part]].sweep = s;
+            refs[fill[part]].index = i;
+            fill[part]++;
+        }
+    }
+    job->refs = refs;
+    return 0;
+}
+
+/**
+ * Копия порогов CFAR на время вызова (job->cfar = NULL - CFAR выключен)
+ * @return 0 при успехе, -1 при ошибке памяти
+ */
+static int snapshot_cfar(spectrum_job_t *job, int channels) {
+    if (channels > cfar_size) {
+        uint8_t *grown = realloc(cfar_copy, channels);
+        if (!grown) return -1;
+        cfar_copy = grown;
+        cfar_size = channels;
+    }
+    job->cfar = cfar_snapshot(cfar_copy, channels) > 0 ? cfar_copy : NULL;
+    return 0;
+}
+
+/**
+ * Поток пула: ждет задание и обрабатывает свою часть
+ */
+static void* worker_main(void *arg) {
+    int part = (int)(intptr_t)arg;
+    uint64_t seen = start_generation;
+
+    pthread_mutex_lock(&pool_mutex);
+    for (;;) {
+        while (!stopping && generation == seen) {
+            pthread_cond_wait(&work_ready, &pool_mutex);
+        }
+        if (stopping) break;
+
+        seen = generation;
+        const spectrum_job_t *job = current;
+        pthread_mutex_unlock(&pool_mutex);
+
+        run_part(job, part);
+
+        pthread_mutex_lock(&pool_mutex);
+        if (--pending_parts == 0) pthread_cond_signal(&work_done);
+    }
+    pthread_mutex_unlock(&pool_mutex);
+    return NULL;
+}
+
+/**
+ * Остановка потоков пула (вызывается под call_mutex)
+ */
+static void stop_pool(void) {
+    if (!pool_started) return;
+
+    pthread_mutex_lock(&pool_mutex);
+    stopping = 1;
+    pthread_cond_broadcast(&work_ready);
+    pthread_mutex_unlock(&pool_mutex);
+
+    for (int i = 1; i < thread_count; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    stopping = 0;
+    thread_count = 1;
+    pool_started = 0;
+
+    free(refs);
+    free(cfar_copy);
+    refs = NULL;
+    cfar_copy = NULL;
+    refs_size = cfar_size = 0;
+}
+
+/**
+ * Запуск потоков пула (вызывается под call_mutex)
+ * @param threads Потоков; 0 - ANALYSIS_THREADS или число ядер
+ */
+static void start_pool(int threads) {
+    char value[16];
+
+    if (threads <= 0 && config_get_value("ANALYSIS_THREADS", value, sizeof(value)) == 0) {
+        threads = atoi(value);
+    }
+    if (threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (int)cpus : 1;
+    }
+    if (threads > SPECTRUM_MAX_THREADS) threads = SPECTRUM_MAX_THREADS;
+
+    thread_count = 1;
+    start_generation = generation;
+    for (int i = 1; i < threads; i++) {
+        if (pthread_create(&workers[i], NULL, worker_main, (void*)(intptr_t)i) != 0) {
+            printf("⚠️ Запущено потоков анализа: %d из %d\n", thread_count, threads);
+            break;
+        }
+        thread_count++;
+    }
+    pool_started = 1;
+    totals.threads = thread_count;
+}
+
+/**
+ * Запуск пула потоков пакетного анализа
+ * @param threads Потоков, включая вызывающий; 0 - ANALYSIS_THREADS или число ядер
+ * @return Количество потоков
+ */
+int spectrum_analysis_init(int threads) {
+    pthread_mutex_lock(&call_mutex);
+    stop_pool();
+    start_pool(threads);
+    int count = thread_count;
+    pthread_mutex_unlock(&call_mutex);
+
+    printf("🧵 Пакетный анализ спектра: потоков %d\n", count);
+    return count;
+}
+
+/**
+ * Остановка пула потоков
+ */
+void spectrum_analysis_cleanup(void) {
+    pthread_mutex_lock(&call_mutex);
+    stop_pool();
+    pthread_mutex_unlock(&call_mutex);
+}
+
+/**
+ * Анализ нескольких обходов подряд
+ * Отсчеты каждого канала анализируются в порядке обходов и внутри обхода,
+ * как при последовательных вызовах analyze_rssi_sample. Одновременно с
+ * пакетным анализом нельзя анализировать отсчеты тех же каналов другими
+ * вызовами (например, конвейером обхода).
+ * @param sweeps Обходы
+ * @param count Количество обходов
+ * @param results results[i] - массив результатов обхода sweeps[i]
+ * @return Количество проанализированных отсчетов, -1 при ошибке
+ */
+int analyze_sweeps(const spectrum_sweep_t *sweeps, int count, spectrum_result_t *const *results) {
+    if (!sweeps || !results || count <= 0) return -1;
+
+    int samples = 0;
+    for (int s = 0; s < count; s++) {
+        if (sweeps[s].count < 0 || (sweeps[s].count > 0 && (!sweeps[s].samples || !results[s]))) return -1;
+        samples += sweeps[s].count;
+    }
+
+    pthread_mutex_lock(&call_mutex);
+    if (!pool_started) start_pool(0);
+
+    uint64_t start = get_monotonic_ns();
+    int channels = scan_plan_get()->channel_count;
+    spectrum_job_t job;
+
+    memset(&job, 0, sizeof(job));
+    job.sweeps = sweeps;
+    job.count = count;
+    job.results = results;
+    if (snapshot_cfar(&job, channels) != 0) {
+        pthread_mutex_unlock(&call_mutex);
+        return -1;
+    }
+
+    if (thread_count > 1 && samples >= SPECTRUM_PARALLEL_MIN &&
+        split_parts(&job, samples, thread_count, channels) == 0) {
+        pthread_mutex_lock(&pool_mutex);
+        current = &job;
+        pending_parts = thread_count - 1;
+        generation++;
+        pthread_cond_broadcast(&work_ready);
+        pthread_mutex_unlock(&pool_mutex);
+
+        run_part(&job, 0);
+
+        pthread_mutex_lock(&pool_mutex);
+        while (pending_parts > 0) {
+            pthread_cond_wait(&work_done, &pool_mutex);
+        }
+        current = NULL;
+        pthread_mutex_unlock(&pool_mutex);
+        totals.parallel_calls++;
+    } else {
+        run_serial(&job);
+    }
+
+    totals.calls++;
+    totals.sweeps += count;
+    totals.samples += samples;
+    totals.busy_ns += get_monotonic_ns() - start;
+    pthread_mutex_unlock(&call_mutex);
+    return samples;
+}
+
+/**
+ * Анализ обхода
+ * @param sweep Обход
+ * @param results Результаты (по элементу на отсчет обхода)
+ * @return Количество проанализированных отсчетов, -1 при ошибке
+ */
+int analyze_spectrum(const spectrum_sweep_t *sweep, spectrum_result_t *results) {
+    return analyze_sweeps(sweep, 1, &results);
+}
+
+/**
+ * Статистика пакетного анализа
+ */
+void get_spectrum_stats(spectrum_stats_t *out) {
+    if (!out) return;
+
+    pthread_mutex_lock(&call_mutex);
+    *out = totals;
+    if (!pool_started) out->threads = 0;
+    pthread_mutex_unlock(&call_mutex);
+}
@@ -0,0 +1,58 @@
+#ifndef SPECTRUM_ANALYSIS_H
+#define SPECTRUM_ANALYSIS_H
+
+#include "fpv_interceptor.h"
+#include "scan_queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Наибольшее число потоков анализа (ANALYSIS_THREADS)
+#define SPECTRUM_MAX_THREADS 8
+
+// Обход: отсчеты в порядке измерения (частоты могут повторяться)
+typedef struct {
+    const scan_result_t *samples;
+    int count;
+} spectrum_sweep_t;
+
+// Результат анализа отсчета обхода
+typedef struct {
+    uint16_t frequency;       // Частота
+    uint8_t raw_rssi;         // Измеренный RSSI
+    uint8_t rssi;             // RSSI после анализа (analyze_rssi_sample)
+    uint8_t threshold;        // Порог канала после учета отсчета в карте шума
+    uint8_t detected;         // RSSI выше порога
+    uint8_t video;            // Видеосигнал по признакам (как detect_video_signal)
+    uint8_t in_plan;          // Частота в охвате плана сканирования
+    uint64_t timestamp_ns;    // Время отсчета
+    rssi_features_t features; // Признаки окна канала после отсчета
+} spectrum_result_t;
+
+typedef struct {
+    int threads;              // Потоков (включая вызывающий)
+    uint64_t calls;           // Вызовов пакетного анализа
+    uint64_t sweeps;          // Обходов
+    uint64_t samples;         // Отсчетов
+    uint64_t parallel_calls;  // Вызовов, разделенных между потоками
+    uint64_t busy_ns;         // Время анализа (вызывающий поток)
+} spectrum_stats_t;
+
+// Пул потоков анализа; threads = 0 - ANALYSIS_THREADS или число ядер
+int spectrum_analysis_init(int threads);
+void spectrum_analysis_cleanup(void);
+
+// Анализ обхода; results - по элементу на отсчет
+int analyze_spectrum(const spectrum_sweep_t *sweep, spectrum_result_t *results);
+
+// Анализ нескольких обходов подряд (архив): results[i] - для sweeps[i]
+int analyze_sweeps(const spectrum_sweep_t *sweeps, int count, spectrum_result_t *const *results);
+
+void get_spectrum_stats(spectrum_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SPECTRUM_ANALYSIS_H
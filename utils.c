@@ -4,19 +4,123 @@
 #include <string.h>
 #include <time.h>
 #include <sys/time.h>
+#include <pthread.h>
 
 // Глобальные переменные
-detected_signal_t detected_signals[100];
+detected_signal_t detected_signals[MAX_DETECTED_SIGNALS];
 int detected_count = 0;
 
+// Сигналы добавляются из потоков нескольких приемников
+static pthread_mutex_t detected_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Привязка монотонного времени к календарному (для экспорта)
+static uint64_t anchor_monotonic_ns = 0;
+static int64_t anchor_offset_ns = 0; // wall - monotonic
+static pthread_mutex_t anchor_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Получение монотонного времени
+ * @return Время CLOCK_MONOTONIC в наносекундах
+ */
+uint64_t get_monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Обновление привязки календарного времени
+ * Снимается CLOCK_REALTIME между двумя чтениями CLOCK_MONOTONIC.
+ * Вызывается автоматически при первом экспорте; повторно - после
+ * синхронизации NTP, если нужна точная календарная привязка.
+ */
+void time_anchor_refresh(void) {
+    struct timespec wall;
+    uint64_t before = get_monotonic_ns();
+    clock_gettime(CLOCK_REALTIME, &wall);
+    uint64_t after = get_monotonic_ns();
+
+    uint64_t wall_ns = (uint64_t)wall.tv_sec * 1000000000ULL + (uint64_t)wall.tv_nsec;
+    uint64_t monotonic = before + (after - before) / 2;
+
+    pthread_mutex_lock(&anchor_mutex);
+    anchor_monotonic_ns = monotonic;
+    anchor_offset_ns = (int64_t)(wall_ns - monotonic);
+    pthread_mutex_unlock(&anchor_mutex);
+}
+
+/**
+ * Перевод монотонной метки в календарное время
+ * Скачки системных часов после привязки не влияют на результат
+ * @param monotonic_ns Время CLOCK_MONOTONIC
+ * @return Время от эпохи Unix в наносекундах
+ */
+uint64_t monotonic_to_wall_ns(uint64_t monotonic_ns) {
+    pthread_mutex_lock(&anchor_mutex);
+    int anchored = anchor_monotonic_ns != 0;
+    pthread_mutex_unlock(&anchor_mutex);
+
+    if (!anchored) {
+        time_anchor_refresh();
+    }
+
+    pthread_mutex_lock(&anchor_mutex);
+    uint64_t wall_ns = monotonic_ns + (uint64_t)anchor_offset_ns;
+    pthread_mutex_unlock(&anchor_mutex);
+    return wall_ns;
+}
+
+/**
+ * Форматирование монотонной метки как местного времени
+ * Формат: ГГГГ-ММ-ДД ЧЧ:ММ:СС.мммммм
+ * @return Длина строки
+ */
+int format_wall_time(uint64_t monotonic_ns, char *buf, size_t size) {
+    if (!buf || size == 0) return 0;
+
+    uint64_t wall_ns = monotonic_to_wall_ns(monotonic_ns);
+    time_t seconds = (time_t)(wall_ns / 1000000000ULL);
+    struct tm local;
+    localtime_r(&seconds, &local);
+
+    char date[32];
+    strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", &local);
+    return snprintf(buf, size, "%s.%06u", date, (unsigned)((wall_ns / 1000ULL) % 1000000ULL));
+}
+
 /**
- * Получение временной метки
- * @return Временная метка в миллисекундах
+ * Чтение значения из конфигурационного файла
+ * Формат строк: КЛЮЧ=ЗНАЧЕНИЕ, строки с # игнорируются
+ * @param key Имя параметра
+ * @param value Буфер для значения
+ * @param size Размер буфера
+ * @return 0 если параметр найден, -1 если нет
  */
-uint32_t get_timestamp(void) {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return (uint32_t)(tv.tv_sec * 1000 + tv.tv_usec / 1000);
+int config_get_value(const char *key, char *value, size_t size) {
+    if (!key || !value || size == 0) return -1;
+    
+    FILE *file = fopen(FPV_CONFIG_FILE, "r");
+    if (!file) return -1;
+    
+    char line[512]; // Списки плана сканирования бывают длинными
+    size_t key_len = strlen(key);
+    int found = -1;
+    
+    while (fgets(line, sizeof(line), file)) {
+        if (line[0] == '#' || strncmp(line, key, key_len) != 0 || line[key_len] != '=') {
+            continue;
+        }
+        
+        char *start = line + key_len + 1;
+        start[strcspn(start, "\r\n")] = '\0';
+        
+        strncpy(value, start, size - 1);
+        value[size - 1] = '\0';
+        found = 0;
+    }
+    
+    fclose(file);
+    return found;
 }
 
 /**
@@ -26,14 +130,34 @@ uint32_t get_timestamp(void) {
  * @param signal_type Тип сигнала
  */
 void add_detected_signal(uint16_t frequency, uint8_t rssi, const char* signal_type) {
-    if (detected_count >= 100) {
-        printf("⚠️ Превышено максимальное количество сигналов (100). Очистите список или перезапустите программу.\n");
+    add_detected_signal_at(frequency, rssi, signal_type, rx5808_current_receiver(), rx5808_now_ns());
+}
+
+/**
+ * Добавление сигнала по отсчету, измеренному ранее (конвейер сканирования)
+ * @param frequency Частота
+ * @param rssi Уровень RSSI
+ * @param signal_type Тип сигнала
+ * @param rx Приемник, измеривший отсчет
+ * @param timestamp_ns Время отсчета по часам приемника
+ */
+void add_detected_signal_at(uint16_t frequency, uint8_t rssi, const char* signal_type,
+                            int rx, uint64_t timestamp_ns) {
+    // Учет обнаружения бэкендом (метрики перехвата симулятора)
+    rx5808_note_detection_at(rx, frequency, timestamp_ns);
+    
+    pthread_mutex_lock(&detected_mutex);
+    
+    if (detected_count >= MAX_DETECTED_SIGNALS) {
+        pthread_mutex_unlock(&detected_mutex);
+        printf("⚠️ Превышено максимальное количество сигналов (%d). Очистите список или перезапустите программу.\n",
+               MAX_DETECTED_SIGNALS);
         return;
     }
     
     detected_signals[detected_count].frequency = frequency;
     detected_signals[detected_count].rssi = rssi;
-    detected_signals[detected_count].timestamp = get_timestamp();
+    detected_signals[detected_count].timestamp_ns = timestamp_ns;
     detected_signals[detected_count].motion_detected = 0;
     detected_signals[detected_count].video_quality = 0;
     
@@ -45,6 +169,11 @@ void add_detected_signal(uint16_t frequency, uint8_t rssi, const char* signal_ty
     
     detected_count++;
     
+    // Журнал переживает перезапуск (STATE_FILE)
+    scan_state_save_signals();
+    
+    pthread_mutex_unlock(&detected_mutex);
+    
     printf("📝 Сигнал добавлен: %d МГц, RSSI: %d%%, Тип: %s\n", 
            frequency, rssi, signal_type ? signal_type : "Неизвестно");
 }
@@ -59,11 +188,15 @@ void print_detected_signals(void) {
     printf("├─────────────┼─────────┼─────────┼─────────────────────┼─────────────────┤\n");
     
     for (int i = 0; i < detected_count; i++) {
-        printf("│ %-11d │ %-7d │ %-7s │ %-19u │ %-15s │\n",
+        char when[40];
+        format_wall_time(detected_signals[i].timestamp_ns, when, sizeof(when));
+        when[19] = '\0'; // Таблица - с точностью до секунды
+        
+        printf("│ %-11d │ %-7d │ %-7s │ %-19s │ %-15s │\n",
                detected_signals[i].frequency,
                detected_signals[i].rssi,
                detected_signals[i].filename,
-               detected_signals[i].timestamp,
+               when,
                detected_signals[i].motion_detected ? "Движение" : "Нет движения");
     }
     
@@ -75,8 +208,10 @@ void print_detected_signals(void) {
  * Сохранение данных сигналов в файл
  */
 void save_signal_data(void) {
+    uint64_t now = get_monotonic_ns();
     char filename[256];
-    snprintf(filename, sizeof(filename), "signals_%u.txt", get_timestamp());
+    snprintf(filename, sizeof(filename), "signals_%llu.txt",
+             (unsigned long long)(monotonic_to_wall_ns(now) / 1000000000ULL));
     
     FILE *file = fopen(filename, "w");
     if (!file) {
@@ -84,16 +219,22 @@ void save_signal_data(void) {
         return;
     }
     
+    char when[40];
+    format_wall_time(now, when, sizeof(when));
+    
     fprintf(file, "# FPV Interceptor - Данные сигналов\n");
-    fprintf(file, "# Время сканирования: %u\n", get_timestamp());
-    fprintf(file, "# Формат: Частота, RSSI, Время, Тип, Движение, Качество\n");
+    fprintf(file, "# Время сканирования: %s\n", when);
+    fprintf(file, "# Привязка: monotonic %llu нс = wall %llu нс\n",
+            (unsigned long long)now, (unsigned long long)monotonic_to_wall_ns(now));
+    fprintf(file, "# Формат: Частота, RSSI, Время (нс от эпохи), Монотонное время (нс), Тип, Движение, Качество\n");
     fprintf(file, "\n");
     
     for (int i = 0; i < detected_count; i++) {
-        fprintf(file, "%d,%d,%u,%s,%d,%d\n",
+        fprintf(file, "%d,%d,%llu,%llu,%s,%d,%d\n",
                 detected_signals[i].frequency,
                 detected_signals[i].rssi,
-                detected_signals[i].timestamp,
+                (unsigned long long)monotonic_to_wall_ns(detected_signals[i].timestamp_ns),
+                (unsigned long long)detected_signals[i].timestamp_ns,
                 detected_signals[i].filename,
                 detected_signals[i].motion_detected,
                 detected_signals[i].video_quality);
@@ -11,6 +11,7 @@
 // Глобальные переменные для видео
 static cv::VideoCapture *video_capture = nullptr;
 static cv::Mat current_frame;
+static uint64_t current_frame_ns = 0; // Время захвата кадра (CLOCK_MONOTONIC)
 static pthread_mutex_t frame_mutex = PTHREAD_MUTEX_INITIALIZER;
 static int video_initialized = 0;
 static char video_device[64] = "/dev/video0";
@@ -121,8 +122,11 @@ int capture_video_frame(uint16_t frequency) {
     int retry_count = 0;
     bool frame_read = false;
     
+    uint64_t frame_ns = 0;
+    
     while (retry_count < 3 && !frame_read) {
         frame_read = video_capture->read(frame);
+        frame_ns = get_monotonic_ns();
         if (!frame_read) {
             retry_count++;
             usleep(10000); // 10 мс задержка между попытками
@@ -144,6 +148,7 @@ int capture_video_frame(uint16_t frequency) {
     // Блокировка мьютекса для обновления кадра
     pthread_mutex_lock(&frame_mutex);
     current_frame = frame.clone();
+    current_frame_ns = frame_ns;
     pthread_mutex_unlock(&frame_mutex);
     
     // Обновление GUI
@@ -167,6 +172,18 @@ void* get_current_frame(void) {
     return static_cast<void*>(frame);
 }
 
+/**
+ * Время захвата текущего кадра
+ * Та же шкала CLOCK_MONOTONIC, что и у отсчетов RSSI аппаратного приемника
+ * @return Время в наносекундах (0 если кадров не было)
+ */
+uint64_t get_current_frame_timestamp_ns(void) {
+    pthread_mutex_lock(&frame_mutex);
+    uint64_t frame_ns = current_frame_ns;
+    pthread_mutex_unlock(&frame_mutex);
+    return frame_ns;
+}
+
 /**
  * Анализ качества видео
  * @param frame Кадр для анализа
@@ -248,8 +265,8 @@ void save_video_stream(uint16_t frequency) {
     }
     
     char filename[256];
-    snprintf(filename, sizeof(filename), "captures/video_%d_%u.avi", 
-            frequency, get_timestamp());
+    snprintf(filename, sizeof(filename), "captures/video_%d_%llu.avi", 
+            frequency, (unsigned long long)(monotonic_to_wall_ns(get_monotonic_ns()) / 1000000ULL));
     
     printf("📹 Запись видеопотока: %s\n", filename);
     